@@ -43,6 +43,8 @@ struct General {
     bool mouse_support = true;
     bool verify_files = true;
     bool show_missing_games = false;
+    bool parallel_scan = false;
+    bool watch_game_dirs = true;
     QString locale;
     QString theme;
 
@@ -23,13 +23,17 @@
 #include "ProcessLauncher.h"
 #include "ScriptRunner.h"
 #include "platform/PowerCommands.h"
+#include "providers/LibrarySnapshot.h"
+#include "providers/LibraryWatcher.h"
 #include "types/AppCloseType.h"
+#include "utils/HashMap.h"
 
 // For type registration
 #include "model/Api.h"
 #include "model/keys/Key.h"
 #include "model/gaming/Assets.h"
 #include "model/gaming/GameFile.h"
+#include "model/gaming/GameQueryModel.h"
 #include "model/internal/Internal.h"
 #include "utils/FolderListModel.h"
 #include "SortFilterProxyModel/qqmlsortfilterproxymodel.h"
@@ -37,6 +41,7 @@
 #include "SortFilterProxyModel/proxyroles/proxyrolesqmltypes.h"
 #include "SortFilterProxyModel/sorters/sortersqmltypes.h"
 
+#include <QElapsedTimer>
 #include <QGuiApplication>
 #include <QQmlEngine>
 
@@ -79,6 +84,7 @@ void register_api_classes()
     qmlRegisterUncreatableType<model::Keys>(API_URI, 0, 10, "Keys", error_msg);
     qmlRegisterUncreatableType<model::GamepadManager>(API_URI, 0, 12, "GamepadManager", error_msg);
     qmlRegisterUncreatableType<model::DeviceInfo>(API_URI, 0, 13, "Device", error_msg);
+    qmlRegisterType<model::GameQueryModel>(API_URI, 0, 14, "GameQueryModel");
 
     // QML utilities
     qmlRegisterType<FolderListModel>("Pegasus.FolderListModel", 1, 0, "FolderListModel");
@@ -131,6 +137,7 @@ Backend::Backend()
 
 Backend::~Backend()
 {
+    delete m_watcher;
     delete m_launcher;
     delete m_frontend;
     delete m_providerman;
@@ -160,6 +167,7 @@ Backend::Backend(const CliArgs& args)
     m_frontend = new FrontendLayer(m_api_public, m_api_private);
     m_launcher = new ProcessLauncher();
     m_providerman = new ProviderManager();
+    m_watcher = new LibraryWatcher();
 
     // the following communication is required because process handling
     // and destroying/rebuilding the frontend stack are asynchronous tasks;
@@ -209,17 +217,30 @@ Backend::Backend(const CliArgs& args)
                      [this](){ onFavoritesChanged(); });
 
     // Loading progress
+    // NOTE: a background check of the snapshot should not bring up the splash screen
     QObject::connect(m_providerman, &ProviderManager::scanStarted,
-                     m_api_private->scannerPtr(), &model::ScannerState::onScanStarted);
+                     m_api_private->scannerPtr(), [this](){
+                         if (!m_background_scan)
+                             m_api_private->scanner().onScanStarted();
+                     });
     QObject::connect(m_providerman, &ProviderManager::scanFinished,
                      m_api_private->scannerPtr(), &model::ScannerState::onScanFinished);
     QObject::connect(m_providerman, &ProviderManager::scanProgressChanged,
-                     m_api_private->scannerPtr(), &model::ScannerState::onScanProgressChanged);
+                     m_api_private->scannerPtr(), [this](float progress, QString stage){
+                         if (!m_background_scan)
+                             m_api_private->scanner().onScanProgressChanged(progress, std::move(stage));
+                     });
+    QObject::connect(m_providerman, &ProviderManager::gamesReady,
+                     m_api_public, [this](){ onGamesReady(); });
     QObject::connect(m_providerman, &ProviderManager::scanFinished,
                      [this](){ onScanFinished(); });
     QObject::connect(m_api_public, &model::ApiObject::gamedataReady,
                      m_api_private->scannerPtr(), &model::ScannerState::onUiReady);
 
+    // changes on the disk
+    QObject::connect(m_watcher, &LibraryWatcher::libraryChanged,
+                     [this](){ onLibraryChanged(); });
+
     // partial QML reload
     QObject::connect(&m_api_private->meta(), &model::Meta::qmlClearCacheRequested,
                      m_frontend, &FrontendLayer::clearCache);
@@ -231,16 +252,96 @@ Backend::Backend(const CliArgs& args)
 void Backend::start()
 {
     m_api_private->settings().postInit();
+
+    // NOTE: the snapshot is loaded before the frontend,
+    //       so the theme can start with the games already available
+    const bool has_snapshot = loadSnapshot();
     onProcessFinished();
-    onScanRequested();
+
+    if (has_snapshot) {
+        startBackgroundScan();
+    }
+    else {
+        onScanRequested();
+    }
+}
+
+bool Backend::loadSnapshot()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    providers::snapshot::Snapshot snapshot;
+    if (!providers::snapshot::read(providers::snapshot::default_path(), snapshot))
+        return false;
+
+    m_library_checksum = std::move(snapshot.checksum);
+    m_api_public->setGameData(std::move(snapshot.collections), std::move(snapshot.games), std::move(snapshot.search_index));
+
+    Log::info(LOGMSG("Game library restored from the snapshot in %1ms").arg(timer.elapsed()));
+    return true;
 }
 
 void Backend::onScanRequested()
 {
+    // the background check is still running, start over when it's done
+    if (m_providerman->isRunning()) {
+        m_rescan_requested = true;
+        return;
+    }
+
+    m_background_scan = false;
+    m_library_changed = false;
+    m_library_checksum.clear();
+
+    m_watcher->stop();
     m_api_public->clearGameData();
     m_providerman->run();
 }
 
+void Backend::startBackgroundScan(const QStringList& unchanged_dirs)
+{
+    m_background_scan = true;
+    m_library_changed = false;
+    m_providerman->run(unchanged_dirs);
+}
+
+void Backend::onLibraryChanged()
+{
+    // NOTE: rescanning while a game is running could slow the game down,
+    //       and a running scan may have already missed the change
+    if (m_game_running || m_providerman->isRunning()) {
+        m_library_changed = true;
+        return;
+    }
+
+    // NOTE: only the changed directories are read again, the rest of the
+    //       listings come from the directory index of the last scan
+    const QStringList unchanged_dirs = m_watcher->take_unchanged_dirs();
+    Log::info(LOGMSG("Changes detected in the game directories, updating the library"));
+    startBackgroundScan(unchanged_dirs);
+}
+
+void Backend::onGamesReady()
+{
+    // NOTE: background checks compare the complete results with the current library,
+    //       and the results of a scan that will be restarted are thrown away anyway
+    if (m_background_scan || m_rescan_requested)
+        return;
+
+    std::vector<model::Collection*> colls;
+    std::swap(m_providerman->foundCollections(), colls);
+
+    std::vector<model::Game*> games;
+    std::swap(m_providerman->foundGames(), games);
+
+    model::GameSearchIndex search_index;
+    std::swap(m_providerman->foundSearchIndex(), search_index);
+
+    // the assets and other data of the games arrive later, while the scan is running
+    m_api_public->setGameData(std::move(colls), std::move(games), std::move(search_index));
+}
+
 void Backend::onScanFinished()
 {
     std::vector<model::Collection*> colls;
@@ -249,24 +350,98 @@ void Backend::onScanFinished()
     std::vector<model::Game*> games;
     std::swap(m_providerman->foundGames(), games);
 
-    m_api_public->setGameData(std::move(colls), std::move(games));
+    model::GameSearchIndex search_index;
+    std::swap(m_providerman->foundSearchIndex(), search_index);
+
+    if (m_rescan_requested) {
+        m_rescan_requested = false;
+        qDeleteAll(games);
+        qDeleteAll(colls);
+
+        if (m_favorites_changed) {
+            m_favorites_changed = false;
+            onFavoritesChanged();
+        }
+        onScanRequested();
+        return;
+    }
+
+    const bool was_background_scan = m_background_scan;
+    m_background_scan = false;
+
+    if (!was_background_scan) {
+        // the games were already published in onGamesReady
+        Q_ASSERT(games.empty() && colls.empty());
+        m_library_checksum = m_providerman->foundChecksum();
+    }
+    else if (m_providerman->foundChecksum() == m_library_checksum) {
+        Log::info(LOGMSG("The game library has not changed"));
+        qDeleteAll(games);
+        qDeleteAll(colls);
+    }
+    else {
+        Log::info(LOGMSG("The game library has changed, updating"));
+        m_library_checksum = m_providerman->foundChecksum();
+
+        // keep the favorites the user has changed during the check
+        if (m_favorites_changed) {
+            HashMap<QString, bool> favorites;
+            for (const model::Game* const game : m_api_public->allGames()->entries()) {
+                for (const model::GameFile* const gamefile : game->files())
+                    favorites.emplace(gamefile->path(), game->isFavorite());
+            }
+            for (model::Game* const game : games) {
+                const auto it = favorites.find(game->files().front()->path());
+                if (it != favorites.cend() && it->second != game->isFavorite())
+                    game->setFavorite(it->second);
+            }
+        }
+
+        m_api_public->syncGameData(std::move(colls), std::move(games));
+    }
+
+    if (m_favorites_changed) {
+        m_favorites_changed = false;
+        onFavoritesChanged();
+    }
+
+    if (AppSettings::general.watch_game_dirs)
+        m_watcher->watch(m_providerman->foundWatchDirs(), m_providerman->foundWatchFiles());
+
+    if (m_library_changed) {
+        m_library_changed = false;
+        onLibraryChanged();
+    }
 }
 
 void Backend::onFavoritesChanged()
 {
+    // the scan may be reading the favorites at the moment
+    if (m_providerman->isRunning()) {
+        m_favorites_changed = true;
+        return;
+    }
+
     m_providerman->onFavoritesChanged(m_api_public->allGames()->entries());
 }
 
 void Backend::onProcessLaunched()
 {
+    m_game_running = true;
     m_frontend->teardown();
     m_api_private->gamepad().stop();
 }
 
 void Backend::onProcessFinished()
 {
+    m_game_running = false;
     m_frontend->rebuild();
     m_api_private->gamepad().start(m_args);
+
+    if (m_library_changed) {
+        m_library_changed = false;
+        onLibraryChanged();
+    }
 }
 
 } // namespace backend
@@ -19,9 +19,13 @@
 
 #include "CliArgs.h"
 
+#include <QByteArray>
+#include <QStringList>
+
 namespace model { class ApiObject; }
 namespace model { class Internal; }
 class FrontendLayer;
+class LibraryWatcher;
 class ProcessLauncher;
 class ProviderManager;
 
@@ -49,9 +53,22 @@ private:
     FrontendLayer* m_frontend;
     ProcessLauncher* m_launcher;
     ProviderManager* m_providerman;
+    LibraryWatcher* m_watcher;
+
+    // the games are already available, and the library is being checked in the background
+    bool m_background_scan = false;
+    bool m_rescan_requested = false;
+    bool m_favorites_changed = false;
+    bool m_library_changed = false;
+    bool m_game_running = false;
+    QByteArray m_library_checksum;
 
+    bool loadSnapshot();
+    void startBackgroundScan(const QStringList& unchanged_dirs = {});
     void onScanRequested();
+    void onGamesReady();
     void onScanFinished();
+    void onLibraryChanged();
     void onFavoritesChanged();
     void onProcessLaunched();
     void onProcessFinished();
@@ -19,6 +19,7 @@
 
 #include "Paths.h"
 #include "imggen/BlurhashProvider.h"
+#include "imggen/ThumbnailProvider.h"
 #include "utils/DiskCachedNAM.h"
 
 #ifdef Q_OS_ANDROID
@@ -64,6 +65,7 @@ void FrontendLayer::rebuild()
     m_engine->setNetworkAccessManagerFactory(new DiskCachedNAMFactory);
 
     m_engine->addImageProvider(QStringLiteral("blurhash"), new BlurhashProvider);
+    m_engine->addImageProvider(QStringLiteral("thumbnail"), new ThumbnailProvider);
 #ifdef Q_OS_ANDROID
     m_engine->addImageProvider(QStringLiteral("androidicons"), new AndroidAppIconProvider);
 #endif
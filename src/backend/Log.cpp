@@ -23,6 +23,7 @@
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
+#include <QMutex>
 #include <QTextStream>
 
 #if defined(Q_OS_ANDROID) && defined(QT_DEBUG)
@@ -176,6 +177,10 @@ private:
 
 namespace {
 
+// Providers may log from multiple threads at the same time; recursive as
+// the Qt message handler can call back into the log while writing
+QRecursiveMutex s_sink_guard;
+
 void on_qt_message(QtMsgType type, const QMessageLogContext& context, const QString& msg)
 {
     const QString prepared_msg = qFormatLogMessage(type, context, msg);
@@ -231,6 +236,7 @@ void Log::close()
 #define FORALLSINK_CALLER(method) \
     void Log::method(const QString& message) \
     { \
+        const QMutexLocker lock(&s_sink_guard); \
         for (const auto& sink : m_sinks) \
             sink->method(message); \
     } \
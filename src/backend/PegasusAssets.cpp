@@ -22,70 +22,72 @@
 #include "utils/HashMap.h"
 
 #include <QString>
+#include <QStringView>
 
 
 namespace pegasus_assets {
 
-AssetType str_to_type(const QString& str)
+AssetType str_to_type(QStringView str)
 {
-    static const HashMap<QString, const AssetType> map {
-        { QStringLiteral("boxfront"), AssetType::BOX_FRONT },
-        { QStringLiteral("boxFront"), AssetType::BOX_FRONT },
-        { QStringLiteral("box_front"), AssetType::BOX_FRONT },
-        { QStringLiteral("boxart2D"), AssetType::BOX_FRONT },
-        { QStringLiteral("boxart2d"), AssetType::BOX_FRONT },
-
-        { QStringLiteral("boxback"), AssetType::BOX_BACK },
-        { QStringLiteral("boxBack"), AssetType::BOX_BACK },
-        { QStringLiteral("box_back"), AssetType::BOX_BACK },
-
-        { QStringLiteral("boxspine"), AssetType::BOX_SPINE },
-        { QStringLiteral("boxSpine"), AssetType::BOX_SPINE },
-        { QStringLiteral("box_spine"), AssetType::BOX_SPINE },
-
-        { QStringLiteral("boxside"), AssetType::BOX_SPINE },
-        { QStringLiteral("boxSide"), AssetType::BOX_SPINE },
-        { QStringLiteral("box_side"), AssetType::BOX_SPINE },
-
-        { QStringLiteral("boxfull"), AssetType::BOX_FULL },
-        { QStringLiteral("boxFull"), AssetType::BOX_FULL },
-        { QStringLiteral("box_full"), AssetType::BOX_FULL },
-        { QStringLiteral("box"), AssetType::BOX_FULL },
-
-        { QStringLiteral("cartridge"), AssetType::CARTRIDGE },
-        { QStringLiteral("disc"), AssetType::CARTRIDGE },
-        { QStringLiteral("cart"), AssetType::CARTRIDGE },
-        { QStringLiteral("logo"), AssetType::LOGO },
-        { QStringLiteral("wheel"), AssetType::LOGO },
-        { QStringLiteral("marquee"), AssetType::ARCADE_MARQUEE },
-        { QStringLiteral("bezel"), AssetType::ARCADE_BEZEL },
-        { QStringLiteral("screenmarquee"), AssetType::ARCADE_BEZEL },
-        { QStringLiteral("border"), AssetType::ARCADE_BEZEL },
-        { QStringLiteral("panel"), AssetType::ARCADE_PANEL },
-
-        { QStringLiteral("cabinetleft"), AssetType::ARCADE_CABINET_L },
-        { QStringLiteral("cabinetLeft"), AssetType::ARCADE_CABINET_L },
-        { QStringLiteral("cabinet_left"), AssetType::ARCADE_CABINET_L },
-
-        { QStringLiteral("cabinetright"), AssetType::ARCADE_CABINET_R },
-        { QStringLiteral("cabinetRight"), AssetType::ARCADE_CABINET_R },
-        { QStringLiteral("cabinet_right"), AssetType::ARCADE_CABINET_R },
-
-        { QStringLiteral("tile"), AssetType::UI_TILE },
-        { QStringLiteral("banner"), AssetType::UI_BANNER },
-        { QStringLiteral("steam"), AssetType::UI_STEAMGRID },
-        { QStringLiteral("steamgrid"), AssetType::UI_STEAMGRID },
-        { QStringLiteral("grid"), AssetType::UI_STEAMGRID },
-        { QStringLiteral("poster"), AssetType::POSTER },
-        { QStringLiteral("flyer"), AssetType::POSTER },
-        { QStringLiteral("background"), AssetType::BACKGROUND },
-        { QStringLiteral("music"), AssetType::MUSIC },
-
-        { QStringLiteral("screenshot"), AssetType::SCREENSHOT },
-        { QStringLiteral("screenshots"), AssetType::SCREENSHOT },
-        { QStringLiteral("video"), AssetType::VIDEO },
-        { QStringLiteral("videos"), AssetType::VIDEO },
-        { QStringLiteral("titlescreen"), AssetType::TITLESCREEN },
+    // NOTE: the keys view string literals, so the lookups need no QString
+    static const HashMap<QStringView, const AssetType> map {
+        { u"boxfront", AssetType::BOX_FRONT },
+        { u"boxFront", AssetType::BOX_FRONT },
+        { u"box_front", AssetType::BOX_FRONT },
+        { u"boxart2D", AssetType::BOX_FRONT },
+        { u"boxart2d", AssetType::BOX_FRONT },
+
+        { u"boxback", AssetType::BOX_BACK },
+        { u"boxBack", AssetType::BOX_BACK },
+        { u"box_back", AssetType::BOX_BACK },
+
+        { u"boxspine", AssetType::BOX_SPINE },
+        { u"boxSpine", AssetType::BOX_SPINE },
+        { u"box_spine", AssetType::BOX_SPINE },
+
+        { u"boxside", AssetType::BOX_SPINE },
+        { u"boxSide", AssetType::BOX_SPINE },
+        { u"box_side", AssetType::BOX_SPINE },
+
+        { u"boxfull", AssetType::BOX_FULL },
+        { u"boxFull", AssetType::BOX_FULL },
+        { u"box_full", AssetType::BOX_FULL },
+        { u"box", AssetType::BOX_FULL },
+
+        { u"cartridge", AssetType::CARTRIDGE },
+        { u"disc", AssetType::CARTRIDGE },
+        { u"cart", AssetType::CARTRIDGE },
+        { u"logo", AssetType::LOGO },
+        { u"wheel", AssetType::LOGO },
+        { u"marquee", AssetType::ARCADE_MARQUEE },
+        { u"bezel", AssetType::ARCADE_BEZEL },
+        { u"screenmarquee", AssetType::ARCADE_BEZEL },
+        { u"border", AssetType::ARCADE_BEZEL },
+        { u"panel", AssetType::ARCADE_PANEL },
+
+        { u"cabinetleft", AssetType::ARCADE_CABINET_L },
+        { u"cabinetLeft", AssetType::ARCADE_CABINET_L },
+        { u"cabinet_left", AssetType::ARCADE_CABINET_L },
+
+        { u"cabinetright", AssetType::ARCADE_CABINET_R },
+        { u"cabinetRight", AssetType::ARCADE_CABINET_R },
+        { u"cabinet_right", AssetType::ARCADE_CABINET_R },
+
+        { u"tile", AssetType::UI_TILE },
+        { u"banner", AssetType::UI_BANNER },
+        { u"steam", AssetType::UI_STEAMGRID },
+        { u"steamgrid", AssetType::UI_STEAMGRID },
+        { u"grid", AssetType::UI_STEAMGRID },
+        { u"poster", AssetType::POSTER },
+        { u"flyer", AssetType::POSTER },
+        { u"background", AssetType::BACKGROUND },
+        { u"music", AssetType::MUSIC },
+
+        { u"screenshot", AssetType::SCREENSHOT },
+        { u"screenshots", AssetType::SCREENSHOT },
+        { u"video", AssetType::VIDEO },
+        { u"videos", AssetType::VIDEO },
+        { u"titlescreen", AssetType::TITLESCREEN },
     };
 
     const auto it = map.find(str);
@@ -19,12 +19,13 @@
 #pragma once
 
 class QString;
+class QStringView;
 enum class AssetType : unsigned char;
 
 
 namespace pegasus_assets {
 
-AssetType str_to_type(const QString&);
+AssetType str_to_type(QStringView);
 QString type_to_str(AssetType type);
 
 } // namespace pegasus_assets
@@ -1,6 +1,6 @@
 TEMPLATE = lib
 
-QT += qml quick sql
+QT += concurrent qml quick sql
 CONFIG += c++11 staticlib warn_on exceptions_off
 android: QT += androidextras
 
@@ -17,8 +17,14 @@
 
 #include "BlurhashProvider.h"
 
-#include "utils/HashMap.h"
-
+#include "imggen/FutureImageResponse.h"
+
+#include <QMutexLocker>
+#include <QStringBuilder>
+#include <QThread>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 #include <array>
 #include <cmath>
 
@@ -36,6 +42,9 @@ constexpr std::array<char, 83> BASE83 {
     '-', '.', ':', ';', '=', '?', '@', '[', ']', '^', '_', '{', '|', '}', '~',
 };
 constexpr int BLURHASH_MIN_LEN = 6;
+constexpr int DEFAULT_SIZE = 24;
+constexpr int SRGB_LUT_SIZE = 4096;
+constexpr int CACHE_MAX_KB = 16 * 1024;
 
 
 struct FpColor {
@@ -47,20 +56,20 @@ struct FpColor {
 
 unsigned decode_base83(QStringView str)
 {
-    static const HashMap<char, unsigned int> BASE83_MAP = [](){
-        HashMap<char, unsigned int> out;
-        out.reserve(BASE83.size());
+    static const std::array<int8_t, 128> BASE83_MAP = [](){
+        std::array<int8_t, 128> out;
+        out.fill(-1);
         for (size_t i = 0; i < BASE83.size(); i++)
-            out.emplace(BASE83[i], i);
+            out[static_cast<size_t>(BASE83[i])] = static_cast<int8_t>(i);
         return out;
     }();
 
     unsigned int result = 0;
     for (const QChar ch : str) {
-        const auto it = BASE83_MAP.find(ch.toLatin1());
-        if (it != BASE83_MAP.cend()) {
+        const char16_t code = ch.unicode();
+        if (code < BASE83_MAP.size() && BASE83_MAP[code] >= 0) {
             result *= BASE83.size();
-            result += it->second;
+            result += BASE83_MAP[code];
         }
     }
     return result;
@@ -71,7 +80,7 @@ float srgb_to_linear(uint8_t srgb_val)
 {
     // NOTE: See "sRGB reverse transformation"
     const float u = srgb_val / 255.f;
-    return u <= 0.4045f
+    return u <= 0.04045f
         ? u / 12.92f
         : std::pow((u + 0.055f) / 1.055f, 2.4f);
 }
@@ -82,16 +91,32 @@ uint8_t linear_to_srgb(float linear_val)
     // NOTE: See "sRGB forward transformation"
     const float u = std::max(0.f, std::min(linear_val, 1.f));
     const float g = u <= 0.0031308f
-        ? u * 12.92
-        : 1.055 * std::pow(u, 1.f / 2.4f) - 0.055f;
-    return std::round(g * 255.f + 0.5f);
+        ? u * 12.92f
+        : 1.055f * std::pow(u, 1.f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::lround(g * 255.f));
+}
+
+
+// NOTE: The steepest part of the curve changes by less than one
+//       output level between the entries of the table
+uint8_t linear_to_srgb_fast(float linear_val)
+{
+    static const std::array<uint8_t, SRGB_LUT_SIZE> SRGB_LUT = [](){
+        std::array<uint8_t, SRGB_LUT_SIZE> out;
+        for (size_t i = 0; i < out.size(); i++)
+            out[i] = linear_to_srgb(static_cast<float>(i) / (SRGB_LUT_SIZE - 1));
+        return out;
+    }();
+
+    const float u = std::max(0.f, std::min(linear_val, 1.f));
+    return SRGB_LUT[static_cast<size_t>(u * (SRGB_LUT_SIZE - 1) + 0.5f)];
 }
 
 
 float unquant_ac_component(float quant, float max_ac)
 {
-    const float base = quant - 9.f;
-    return std::copysign(1.f, base) * std::pow(base / 9.f, 2.f) * max_ac;
+    const float base = (quant - 9.f) / 9.f;
+    return std::copysign(1.f, base) * base * base * max_ac;
 }
 
 
@@ -119,87 +144,142 @@ FpColor decode_ac(unsigned raw_val, float max_ac)
 }
 
 
+// Returns `components` rows of `image_dim` values, the row of component `c` being cos(PI * c * pos / image_dim)
 std::vector<float> create_cos_table(unsigned components, unsigned image_dim)
 {
     std::vector<float> out(components * image_dim);
-    for (size_t i = 0; i < out.size(); i++)
-        out[i] = std::cos(M_PI * i / image_dim);
+    for (unsigned c = 0; c < components; c++) {
+        for (unsigned pos = 0; pos < image_dim; pos++)
+            out[c * image_dim + pos] = std::cos(M_PI * c * pos / image_dim);
+    }
     return out;
 }
+
+
+// NOTE: The loops below run over contiguous float arrays without branches,
+//       so they can be vectorized by the compiler on every platform
+void multiply_add(float* dst, const float* src, float factor, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] += src[i] * factor;
+}
 } // namespace
 
 
 BlurhashProvider::BlurhashProvider()
-    : QQuickImageProvider(QQuickImageProvider::Image)
-{}
+    : QQuickAsyncImageProvider()
+    , m_cache(CACHE_MAX_KB)
+{
+    // NOTE: the decoding is quick, a few threads are enough to keep up with scrolling
+    m_pool.setMaxThreadCount(std::max(1, std::min(QThread::idealThreadCount() - 1, 4)));
+}
 
 
-QImage BlurhashProvider::requestImage(const QString& hash_url, QSize* out_size, const QSize& requested_size)
+QQuickImageResponse* BlurhashProvider::requestImageResponse(const QString& hash_url, const QSize& requested_size)
 {
     const QString hash = QUrl::fromPercentEncoding(hash_url.toLatin1());
-    if (hash.length() < BLURHASH_MIN_LEN)
-        return {};
-
     const QSize img_size = requested_size.isEmpty()
-        ? QSize(24, 24)
+        ? QSize(DEFAULT_SIZE, DEFAULT_SIZE)
         : requested_size;
+    const QString cache_key = hash
+        % QLatin1Char('@') % QString::number(img_size.width())
+        % QLatin1Char('x') % QString::number(img_size.height());
+
+    QFuture<QImage> future = QtConcurrent::run(&m_pool, [this, hash, img_size, cache_key]{
+        {
+            QMutexLocker lock(&m_cache_lock);
+            const QImage* const cached = m_cache.object(cache_key);
+            if (cached)
+                return *cached;
+        }
+
+        QImage image = decode(hash, img_size);
+        if (!image.isNull()) {
+            const int cost_kb = std::max<int>(1, image.sizeInBytes() / 1024);
+            QMutexLocker lock(&m_cache_lock);
+            m_cache.insert(cache_key, new QImage(image), cost_kb);
+        }
+        return image;
+    });
+    return new FutureImageResponse(future, QStringLiteral("Invalid blurhash `%1`").arg(hash));
+}
 
-    const unsigned components_raw = decode_base83(hash.leftRef(1));
+
+QImage BlurhashProvider::decode(const QString& hash, const QSize& img_size)
+{
+    if (hash.length() < BLURHASH_MIN_LEN || img_size.isEmpty())
+        return {};
+
+    const QStringView hash_view(hash);
+    const unsigned components_raw = decode_base83(hash_view.left(1));
     const unsigned components_x = (components_raw % 9) + 1;
     const unsigned components_y = (components_raw / 9) + 1;
     const size_t color_cnt = components_x * components_y;
     if (static_cast<unsigned>(hash.length()) != 4 + 2 * color_cnt) // 2 head + 4 DC + 2 * (nx * ny - 1) AC
         return {};
 
-    const unsigned max_ac_raw = decode_base83(hash.midRef(1, 1));
+    const unsigned max_ac_raw = decode_base83(hash_view.mid(1, 1));
     const float max_ac = (max_ac_raw + 1) / 166.f;
 
-    const std::vector<FpColor> colors = [color_cnt, max_ac, &hash](){
+    const std::vector<FpColor> colors = [color_cnt, max_ac, hash_view](){
         std::vector<FpColor> out;
         out.reserve(color_cnt);
 
-        const unsigned avg_color_raw = decode_base83(hash.midRef(2, 4));
+        const unsigned avg_color_raw = decode_base83(hash_view.mid(2, 4));
         out.emplace_back(decode_dc(avg_color_raw));
 
         for (size_t i = 1; i < color_cnt; i++) {
             const int str_start = 4 + i * 2;
-            const unsigned color_raw = decode_base83(hash.midRef(str_start, 2));
+            const unsigned color_raw = decode_base83(hash_view.mid(str_start, 2));
             out.emplace_back(decode_ac(color_raw, max_ac));
         }
 
         return out;
     }();
 
-    const std::vector<float> cos_x_table = create_cos_table(components_x, img_size.width());
-    const std::vector<float> cos_y_table = create_cos_table(components_y, img_size.height());
+    const size_t width = img_size.width();
+    const size_t height = img_size.height();
+    const std::vector<float> cos_x_table = create_cos_table(components_x, width);
+    const std::vector<float> cos_y_table = create_cos_table(components_y, height);
+
+    // NOTE: The basis functions are separable, so the horizontal sums are calculated
+    //       once per vertical component, then each line is a weighted sum of those.
+    //       The values are stored per channel, as [component][channel][x].
+    std::vector<float> row_sums(components_y * 3 * width, 0.f);
+    for (unsigned cy = 0; cy < components_y; cy++) {
+        float* const sum_r = row_sums.data() + (cy * 3 + 0) * width;
+        float* const sum_g = row_sums.data() + (cy * 3 + 1) * width;
+        float* const sum_b = row_sums.data() + (cy * 3 + 2) * width;
+
+        for (unsigned cx = 0; cx < components_x; cx++) {
+            const FpColor& color = colors[cy * components_x + cx];
+            const float* const cos_x = cos_x_table.data() + cx * width;
+            multiply_add(sum_r, cos_x, color.r, width);
+            multiply_add(sum_g, cos_x, color.g, width);
+            multiply_add(sum_b, cos_x, color.b, width);
+        }
+    }
 
     QImage out_img(img_size, QImage::Format_RGB888);
-    uchar* const out_img_data = out_img.bits();
-
-    for (int img_y = 0; img_y < img_size.height(); img_y++) {
-        for (int img_x = 0; img_x < img_size.width(); img_x++) {
-            FpColor out_color { 0, 0, 0 };
-
-            for (unsigned cy = 0; cy < components_y; cy++) {
-                for (unsigned cx = 0; cx < components_x; cx++) {
-                    const float basis = cos_x_table[img_x * cx] * cos_y_table[img_y * cy];
-                    const size_t color_idx = cy * components_x + cx;
-                    const FpColor color = colors[color_idx];
-
-                    out_color.r += color.r * basis;
-                    out_color.g += color.g * basis;
-                    out_color.b += color.b * basis;
-                }
-            }
-
-            const size_t pixeldata_idx = (img_y * img_size.width() + img_x) * 3;
-            out_img_data[pixeldata_idx + 0] = linear_to_srgb(out_color.r);
-            out_img_data[pixeldata_idx + 1] = linear_to_srgb(out_color.g);
-            out_img_data[pixeldata_idx + 2] = linear_to_srgb(out_color.b);
+    std::vector<float> line(3 * width);
+
+    for (size_t img_y = 0; img_y < height; img_y++) {
+        std::fill(line.begin(), line.end(), 0.f);
+        for (unsigned cy = 0; cy < components_y; cy++) {
+            const float basis = cos_y_table[cy * height + img_y];
+            multiply_add(line.data(), row_sums.data() + cy * 3 * width, basis, 3 * width);
+        }
+
+        const float* const line_r = line.data();
+        const float* const line_g = line_r + width;
+        const float* const line_b = line_g + width;
+        uchar* const out_line = out_img.scanLine(img_y);
+        for (size_t img_x = 0; img_x < width; img_x++) {
+            out_line[img_x * 3 + 0] = linear_to_srgb_fast(line_r[img_x]);
+            out_line[img_x * 3 + 1] = linear_to_srgb_fast(line_g[img_x]);
+            out_line[img_x * 3 + 2] = linear_to_srgb_fast(line_b[img_x]);
         }
     }
 
-    if (out_size)
-        *out_size = img_size;
     return out_img;
 }
@@ -17,12 +17,30 @@
 
 #pragma once
 
+#include <QCache>
+#include <QMutex>
 #include <QQuickImageProvider>
+#include <QThreadPool>
 
 
-class BlurhashProvider : public QQuickImageProvider {
+/// Decodes BlurHash placeholder images
+///
+/// The images are decoded on a separate thread pool, and the recently
+/// used ones are kept in a memory cache, keyed by the hash and the size.
+class BlurhashProvider : public QQuickAsyncImageProvider {
 public:
     BlurhashProvider();
 
-    QImage requestImage(const QString&, QSize*, const QSize&) override;
+    QQuickImageResponse* requestImageResponse(const QString&, const QSize&) override;
+
+    /// Returns the image of the hash, or a null image if the hash is invalid
+    static QImage decode(const QString& hash, const QSize& size);
+
+private:
+    QMutex m_cache_lock;
+    QCache<QString, QImage> m_cache;
+
+    // NOTE: the pool waits for the running tasks on destruction,
+    //       so it has to be destroyed before the cache
+    QThreadPool m_pool;
 };
@@ -0,0 +1,45 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "FutureImageResponse.h"
+
+
+FutureImageResponse::FutureImageResponse(const QFuture<QImage>& future, QString error_msg, CancelFlag cancelled)
+    : m_error_msg(std::move(error_msg))
+    , m_cancelled(std::move(cancelled))
+{
+    // NOTE: the watcher reports in the thread of the response,
+    //       and it's disconnected automatically when the response gets deleted
+    connect(&m_watcher, &QFutureWatcher<QImage>::finished, this, [this]{
+        m_image = m_watcher.result();
+        if (m_image.isNull())
+            m_error = m_error_msg;
+        emit finished();
+    });
+    m_watcher.setFuture(future);
+}
+
+QQuickTextureFactory* FutureImageResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+void FutureImageResponse::cancel()
+{
+    if (m_cancelled)
+        *m_cancelled = true;
+}
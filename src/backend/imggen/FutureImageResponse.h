@@ -0,0 +1,48 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QQuickImageProvider>
+#include <atomic>
+#include <memory>
+
+
+/// An image response that finishes when the image of a future becomes available
+///
+/// The future is expected to run on a different thread. If a cancellation
+/// flag is provided, it is set when the response gets cancelled, so the
+/// task can finish early.
+class FutureImageResponse : public QQuickImageResponse {
+public:
+    using CancelFlag = std::shared_ptr<std::atomic<bool>>;
+
+    FutureImageResponse(const QFuture<QImage>&, QString error_msg, CancelFlag = nullptr);
+
+    QQuickTextureFactory* textureFactory() const override;
+    QString errorString() const override { return m_error; }
+    void cancel() override;
+
+private:
+    const QString m_error_msg;
+    const CancelFlag m_cancelled;
+    QFutureWatcher<QImage> m_watcher;
+    QImage m_image;
+    QString m_error;
+};
@@ -0,0 +1,295 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "ThumbnailProvider.h"
+
+#include "Paths.h"
+#include "imggen/FutureImageResponse.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QDirIterator>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+#include <QStringBuilder>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrent>
+#include <array>
+#include <atomic>
+#include <memory>
+
+
+namespace {
+// NOTE: A few fixed sizes are used instead of the exact requested ones,
+//       so the cached images can be shared by themes and layouts
+constexpr std::array<int, 5> SIZE_BUCKETS { 128, 256, 512, 1024, 2048 };
+constexpr int JPEG_QUALITY = 90;
+constexpr qint64 MAX_CACHE_BYTES = 512 * 1024 * 1024;
+constexpr int DOWNLOAD_TIMEOUT_MS = 10000;
+constexpr int CANCEL_CHECK_MS = 100;
+
+using CancelFlag = FutureImageResponse::CancelFlag;
+
+
+bool is_remote(const QUrl& url)
+{
+    return url.scheme() == QLatin1String("http") || url.scheme() == QLatin1String("https");
+}
+
+QString path_of(const QUrl& url, const QString& id)
+{
+    if (url.isLocalFile())
+        return url.toLocalFile();
+    if (url.scheme() == QLatin1String("qrc"))
+        return QLatin1Char(':') + url.path();
+
+    return QUrl::fromPercentEncoding(id.toUtf8());
+}
+
+// NOTE: Local files are identified by their stat data, so the cache can be
+//       checked without opening the original. Remote images are expected
+//       to not change under the same URL.
+QString cache_key_of(const QUrl& url, const QString& id)
+{
+    if (is_remote(url))
+        return url.toString();
+
+    const QFileInfo finfo(path_of(url, id));
+    if (!finfo.exists())
+        return QString();
+
+    return finfo.absoluteFilePath()
+        % QLatin1Char('\n') % QString::number(finfo.lastModified().toMSecsSinceEpoch())
+        % QLatin1Char('\n') % QString::number(finfo.size());
+}
+
+QString cache_path_of(const QString& cache_dir, const QString& key, int bucket)
+{
+    const QString full_key = key % QLatin1Char('\n') % QString::number(bucket);
+    const QString hash = QString::fromLatin1(QCryptographicHash::hash(full_key.toUtf8(), QCryptographicHash::Sha1).toHex());
+
+    // NOTE: the files are spread into subdirectories, to keep the directories small
+    return cache_dir % QLatin1Char('/') % hash.left(2) % QLatin1Char('/') % hash;
+}
+
+QImage read_cached(const QString& cache_path)
+{
+    QFile file(cache_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    const QImage image = QImageReader(&file).read();
+
+    // NOTE: the modification time marks the last use, see prune_cache()
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    if (!image.isNull() && file.fileTime(QFileDevice::FileModificationTime).daysTo(now) > 0)
+        file.setFileTime(now, QFileDevice::FileModificationTime);
+
+    return image;
+}
+
+void save_thumbnail(const QImage& image, const QString& cache_path)
+{
+    QDir().mkpath(QFileInfo(cache_path).path());
+
+    // NOTE: the format is detected from the contents when reading
+    const bool has_alpha = image.hasAlphaChannel();
+    QSaveFile file(cache_path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QImageWriter writer(&file, has_alpha ? QByteArrayLiteral("png") : QByteArrayLiteral("jpg"));
+    if (!has_alpha)
+        writer.setQuality(JPEG_QUALITY);
+
+    if (writer.write(image))
+        file.commit();
+}
+
+// NOTE: This runs on a thread of the pool, so the download is waited for
+//       in a local event loop
+QByteArray download(const QUrl& url, const CancelFlag& cancelled)
+{
+    QNetworkAccessManager netman;
+
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+    request.setTransferTimeout(DOWNLOAD_TIMEOUT_MS);
+#endif
+
+    QNetworkReply* const reply = netman.get(request);
+
+    QEventLoop loop;
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+
+    QTimer cancel_timer;
+    QObject::connect(&cancel_timer, &QTimer::timeout, reply, [reply, &cancelled]{
+        if (*cancelled)
+            reply->abort();
+    });
+    cancel_timer.start(CANCEL_CHECK_MS);
+
+    loop.exec();
+
+    const QByteArray data = reply->error() == QNetworkReply::NoError
+        ? reply->readAll()
+        : QByteArray();
+    delete reply;
+    return data;
+}
+
+QImage read_thumbnail(QImageReader& reader, int bucket, const QString& cache_path)
+{
+    reader.setAutoTransform(true);
+    if (bucket == 0)
+        return reader.read();
+
+    const QSize full_size = reader.size();
+    const bool fits = full_size.isValid() && full_size.width() <= bucket && full_size.height() <= bucket;
+    if (!full_size.isValid() || fits)
+        return reader.read();
+
+    // NOTE: Some decoders (eg. JPEG) can skip most of the work for smaller target
+    //       sizes, so the scaling is done by the reader instead of the image
+    reader.setScaledSize(full_size.scaled(bucket, bucket, Qt::KeepAspectRatio));
+    const QImage thumbnail = reader.read();
+    if (!thumbnail.isNull() && !cache_path.isEmpty())
+        save_thumbnail(thumbnail, cache_path);
+
+    return thumbnail;
+}
+
+QImage load_image(const QString& id, int bucket, const QString& cache_dir, const CancelFlag& cancelled)
+{
+    if (*cancelled)
+        return {};
+
+    const QUrl url(id);
+    const QString cache_path = bucket > 0
+        ? ThumbnailProvider::cache_path(cache_dir, id, bucket)
+        : QString();
+    if (!cache_path.isEmpty()) {
+        const QImage cached = read_cached(cache_path);
+        if (!cached.isNull())
+            return cached;
+    }
+    if (*cancelled)
+        return {};
+
+    if (is_remote(url)) {
+        QByteArray data = download(url, cancelled);
+        QBuffer buffer(&data);
+        QImageReader reader(&buffer);
+        return read_thumbnail(reader, bucket, cache_path);
+    }
+
+    QImageReader reader(path_of(url, id));
+    return read_thumbnail(reader, bucket, cache_path);
+}
+} // namespace
+
+
+ThumbnailProvider::ThumbnailProvider(QString cache_dir)
+    : QQuickAsyncImageProvider()
+    , m_cache_dir(cache_dir.isEmpty()
+        ? paths::writableCacheDir() + QLatin1String("/thumbnails")
+        : std::move(cache_dir))
+{
+    // NOTE: one core is left for the UI
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+
+    const QString pruned_dir = m_cache_dir;
+    QtConcurrent::run(&m_pool, [pruned_dir]{
+        prune_cache(pruned_dir, MAX_CACHE_BYTES);
+    });
+}
+
+QQuickImageResponse* ThumbnailProvider::requestImageResponse(const QString& id, const QSize& requested_size)
+{
+    const int bucket = size_bucket(requested_size);
+    const QString cache_dir = m_cache_dir;
+    const CancelFlag cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    QFuture<QImage> future = QtConcurrent::run(&m_pool, [id, bucket, cache_dir, cancelled]{
+        return load_image(id, bucket, cache_dir, cancelled);
+    });
+    return new FutureImageResponse(future, QStringLiteral("Could not load image `%1`").arg(id), cancelled);
+}
+
+int ThumbnailProvider::size_bucket(const QSize& requested_size)
+{
+    const int longest = std::max(requested_size.width(), requested_size.height());
+    if (longest <= 0)
+        return 0;
+
+    for (const int bucket : SIZE_BUCKETS) {
+        if (longest <= bucket)
+            return bucket;
+    }
+    return 0;
+}
+
+QString ThumbnailProvider::cache_path(const QString& cache_dir, const QString& id, int bucket)
+{
+    const QString key = cache_key_of(QUrl(id), id);
+    return key.isEmpty()
+        ? QString()
+        : cache_path_of(cache_dir, key, bucket);
+}
+
+QImage ThumbnailProvider::load(const QString& id, const QSize& requested_size, const QString& cache_dir)
+{
+    const CancelFlag never_cancelled = std::make_shared<std::atomic<bool>>(false);
+    return load_image(id, size_bucket(requested_size), cache_dir, never_cancelled);
+}
+
+void ThumbnailProvider::prune_cache(const QString& cache_dir, qint64 max_bytes)
+{
+    std::vector<QFileInfo> files;
+    qint64 total_bytes = 0;
+
+    QDirIterator dir_it(cache_dir, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (dir_it.hasNext()) {
+        dir_it.next();
+        files.emplace_back(dir_it.fileInfo());
+        total_bytes += files.back().size();
+    }
+    if (total_bytes <= max_bytes)
+        return;
+
+    // NOTE: the cache is pruned below the limit, so this doesn't have to run on every start
+    const qint64 target_bytes = max_bytes / 4 * 3;
+    std::sort(files.begin(), files.end(), [](const QFileInfo& a, const QFileInfo& b){
+        return a.lastModified() < b.lastModified();
+    });
+    for (const QFileInfo& finfo : files) {
+        if (total_bytes <= target_bytes)
+            break;
+        if (QFile::remove(finfo.filePath()))
+            total_bytes -= finfo.size();
+    }
+}
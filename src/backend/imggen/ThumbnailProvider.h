@@ -0,0 +1,53 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <QQuickImageProvider>
+#include <QThreadPool>
+
+
+/// Serves downscaled copies of images, cached on the disk
+///
+/// The images are requested as `image://thumbnail/<URL or path>`. The
+/// requested size is rounded up to one of a few fixed sizes, and the images
+/// are decoded and scaled on a separate thread pool. The results are stored
+/// in the cache directory, keyed by the path, modification time and size of
+/// local files, or by the URL of remote (HTTP) images, which are downloaded
+/// only when not yet cached. Without a requested size, or for images already
+/// smaller than that, the original image is returned. The least recently used
+/// thumbnails are removed when the cache grows too large.
+class ThumbnailProvider : public QQuickAsyncImageProvider {
+public:
+    explicit ThumbnailProvider(QString cache_dir = QString());
+
+    QQuickImageResponse* requestImageResponse(const QString&, const QSize&) override;
+
+    /// Returns the size the longer side of the image is scaled to, or 0 for the original size
+    static int size_bucket(const QSize& requested_size);
+    /// Returns the path of the cached thumbnail of the image,
+    /// or an empty string if the image cannot be cached (eg. it does not exist)
+    static QString cache_path(const QString& cache_dir, const QString& id, int bucket);
+    /// Loads the image at the requested size, using the cache
+    static QImage load(const QString& id, const QSize& requested_size, const QString& cache_dir);
+    /// Removes the least recently used thumbnails if the cache is larger than the limit
+    static void prune_cache(const QString& cache_dir, qint64 max_bytes);
+
+private:
+    const QString m_cache_dir;
+    QThreadPool m_pool;
+};
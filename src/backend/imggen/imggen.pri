@@ -1,5 +1,9 @@
 HEADERS += \
-    $$PWD/BlurhashProvider.h
+    $$PWD/BlurhashProvider.h \
+    $$PWD/FutureImageResponse.h \
+    $$PWD/ThumbnailProvider.h
 
 SOURCES += \
-    $$PWD/BlurhashProvider.cpp
+    $$PWD/BlurhashProvider.cpp \
+    $$PWD/FutureImageResponse.cpp \
+    $$PWD/ThumbnailProvider.cpp
@@ -19,6 +19,54 @@
 
 #include "Log.h"
 #include "model/gaming/GameFile.h"
+#include "providers/LibrarySnapshot.h"
+#include "utils/HashMap.h"
+#include "utils/SortKey.h"
+#include "utils/StringPool.h"
+
+#include <QQmlEngine>
+
+
+namespace {
+QStringList distinct_values(const std::vector<model::Game*>& games, const QStringList& (model::Game::*list_of)() const)
+{
+    StringPool pool;
+    for (const model::Game* const game : games) {
+        for (const QString& value : (game->*list_of)())
+            pool.intern(value);
+    }
+
+    std::vector<std::pair<SortKey, StringPool::Id>> keys;
+    keys.reserve(pool.size());
+    for (StringPool::Id id = 0; id < pool.size(); id++)
+        keys.emplace_back(SortKey(pool.at(id)), id);
+
+    std::sort(keys.begin(), keys.end(),
+        [](const std::pair<SortKey, StringPool::Id>& a, const std::pair<SortKey, StringPool::Id>& b){
+            return a.first < b.first;
+        });
+
+    QStringList result;
+    result.reserve(static_cast<int>(keys.size()));
+    for (const auto& pair : keys)
+        result.append(pool.at(pair.second));
+    return result;
+}
+
+// Creates the outdated collation keys again, returns true if any of them has changed
+bool update_sort_keys(const std::vector<model::Collection*>& collections, const std::vector<model::Game*>& games)
+{
+    bool changed = false;
+    for (model::Collection* const coll : collections)
+        changed |= coll->updateSortKey();
+    for (model::Game* const game : games) {
+        changed |= game->updateSortKey();
+        for (model::GameFile* const gamefile : game->files())
+            changed |= gamefile->updateSortKey();
+    }
+    return changed;
+}
+} // namespace
 
 
 namespace model {
@@ -39,40 +87,236 @@ void ApiObject::clearGameData()
 
     Q_ASSERT(m_all_games);
     m_all_games->update({});
+
+    m_search_index.clear();
+    m_distinct_values.valid = false;
 }
 
-void ApiObject::setGameData(std::vector<model::Collection*>&& collections, std::vector<model::Game*>&& games)
+void ApiObject::setGameData(
+    std::vector<model::Collection*>&& collections,
+    std::vector<model::Game*>&& games,
+    GameSearchIndex&& search_index)
 {
     Q_ASSERT(m_all_games && m_all_games->entries().empty());
     Q_ASSERT(m_collections && m_collections->entries().empty());
 
-    for (model::Game* const game : qAsConst(games)) {
-        game->moveToThread(thread());
-        game->setParent(this);
+    // NOTE: the locale might have changed during the scan
+    const bool resort_needed = update_sort_keys(collections, games);
 
-        connect(game, &model::Game::launchFileSelectorRequested,
-                this, &ApiObject::onGameFileSelectorRequested);
-        connect(game, &model::Game::favoriteChanged,
-                this, &ApiObject::onGameFavoriteChanged);
+    for (model::Game* const game : qAsConst(games))
+        adoptGame(game);
+    for (model::Collection* const coll : qAsConst(collections))
+        adoptCollection(coll);
+
+    m_all_games->update(std::move(games));
+    m_collections->update(std::move(collections));
+    m_search_index = std::move(search_index);
+    m_distinct_values.valid = false;
+
+    if (resort_needed)
+        sortLists();
+
+    Log::info(LOGMSG("%1 games found").arg(m_all_games->count()));
+    emit gamedataReady();
+}
 
-        for (model::GameFile* const gamefile : game->filesModel()->entries()) {
-            connect(gamefile, &model::GameFile::launchRequested,
-                    this, &ApiObject::onGameFileLaunchRequested);
+void ApiObject::syncGameData(std::vector<model::Collection*>&& collections, std::vector<model::Game*>&& games)
+{
+    // Objects with unchanged data are kept, the new copies are dropped;
+    // the rest of the new objects replace the old ones
+
+    // NOTE: the locale might have changed during the scan; the keys of the
+    //       existing objects are always up to date
+    const bool resort_needed = update_sort_keys(collections, games);
+
+    HashMap<QByteArray, model::Collection*> old_colls;
+    for (model::Collection* const coll : m_collections->entries())
+        old_colls.emplace(providers::snapshot::collection_digest(*coll), coll);
+
+    std::vector<model::Collection*> final_colls;
+    std::vector<model::Collection*> dropped_colls;
+    HashMap<model::Collection*, model::Collection*> coll_remap;
+    HashMap<QString, model::Collection*> final_colls_by_name;
+    for (model::Collection* const coll : collections) {
+        model::Collection* final_coll = coll;
+
+        const auto it = old_colls.find(providers::snapshot::collection_digest(*coll));
+        if (it != old_colls.end()) {
+            final_coll = it->second;
+            dropped_colls.emplace_back(coll);
+            old_colls.erase(it);
         }
+
+        final_colls.emplace_back(final_coll);
+        coll_remap.emplace(coll, final_coll);
+        final_colls_by_name.emplace(final_coll->name(), final_coll);
     }
 
-    for (model::Collection* const coll : qAsConst(collections)) {
-        coll->moveToThread(thread());
-        coll->setParent(this);
+
+    HashMap<QByteArray, std::vector<model::Game*>> old_games;
+    for (model::Game* const game : m_all_games->entries())
+        old_games[providers::snapshot::game_digest(*game)].emplace_back(game);
+
+    std::vector<model::Game*> final_games;
+    std::vector<model::Game*> dropped_games;
+    std::vector<model::Game*> added_games;
+    HashMap<model::Game*, model::Game*> game_remap;
+    for (model::Game* const game : games) {
+        model::Game* final_game = game;
+
+        const auto it = old_games.find(providers::snapshot::game_digest(*game));
+        if (it != old_games.end() && !it->second.empty()) {
+            final_game = it->second.back();
+            it->second.pop_back();
+            dropped_games.emplace_back(game);
+
+            // NOTE: the play stats of the existing objects are kept up to date
+            //       during the run, so only the favorite state is copied over
+            if (final_game->isFavorite() != game->isFavorite())
+                final_game->setFavorite(game->isFavorite());
+        }
+        else {
+            adoptGame(game);
+            m_search_index.add(game);
+            added_games.emplace_back(game);
+        }
+
+        final_games.emplace_back(final_game);
+        game_remap.emplace(game, final_game);
     }
 
-    m_all_games->update(std::move(games));
-    m_collections->update(std::move(collections));
+    // NOTE: The play sessions that ended during the scan were only applied to the
+    //       existing objects, so the new objects replacing them might miss them
+    HashMap<QString, const model::GameFile*> removed_files;
+    for (const auto& pair : old_games) {
+        for (const model::Game* const game : pair.second) {
+            for (const model::GameFile* const gamefile : game->files())
+                removed_files.emplace(gamefile->path(), gamefile);
+        }
+    }
+    std::vector<model::PlaySession> missed_sessions;
+    for (model::Game* const game : added_games) {
+        for (model::GameFile* const gamefile : game->files()) {
+            const auto it = removed_files.find(gamefile->path());
+            if (it == removed_files.cend() || it->second->playCount() <= gamefile->playCount())
+                continue;
 
-    Log::info(LOGMSG("%1 games found").arg(m_all_games->count()));
+            const model::GameFile& old_file = *it->second;
+            missed_sessions.push_back({
+                gamefile,
+                old_file.playCount() - gamefile->playCount(),
+                std::max<qint64>(old_file.playTime() - gamefile->playTime(), 0),
+                old_file.lastPlayed(),
+            });
+        }
+    }
+    if (!missed_sessions.empty())
+        model::GameFile::update_playstats(missed_sessions);
+
+
+    // Point the games to the final collection objects
+    for (model::Game* const game : final_games) {
+        std::vector<model::Collection*> game_colls = game->collections();
+
+        bool changed = false;
+        for (model::Collection*& coll : game_colls) {
+            model::Collection* const final_coll = final_colls_by_name.at(coll->name());
+            changed |= final_coll != coll;
+            coll = final_coll;
+        }
+
+        if (changed) {
+            std::sort(game_colls.begin(), game_colls.end(), model::sort_collections);
+            game->syncCollections(std::move(game_colls));
+        }
+    }
+
+    // Update the game lists of the collections
+    for (model::Collection* const coll : collections) {
+        std::vector<model::Game*> coll_games = coll->gameList()->entries();
+        for (model::Game*& game : coll_games)
+            game = game_remap.at(game);
+
+        model::Collection* const final_coll = coll_remap.at(coll);
+        if (final_coll == coll)
+            adoptCollection(coll);
+        final_coll->gameList()->sync(std::move(coll_games));
+    }
+
+
+    m_all_games->sync(std::move(final_games));
+    m_collections->sync(std::move(final_colls));
+    m_distinct_values.valid = false;
+
+    if (resort_needed)
+        sortLists();
+
+    qDeleteAll(dropped_games);
+    qDeleteAll(dropped_colls);
+
+    // NOTE: the removed objects may still be referred by QML until the next event loop cycle
+    size_t removed_count = 0;
+    for (const auto& pair : old_games) {
+        for (model::Game* const game : pair.second) {
+            m_search_index.remove(game);
+            game->deleteLater();
+            removed_count++;
+        }
+    }
+    for (const auto& pair : old_colls)
+        pair.second->deleteLater();
+
+    Log::info(LOGMSG("Game library updated: %1 games added, %2 removed")
+        .arg(QString::number(added_games.size()), QString::number(removed_count)));
     emit gamedataReady();
 }
 
+ObjectListModel* ApiObject::search(const QString& query, int limit) const
+{
+    auto* const results = new GameListModel();
+    results->update(m_search_index.search(query, static_cast<size_t>(std::max(limit, 0))));
+
+    // NOTE: every call returns a new model, which is owned by the QML side
+    QQmlEngine::setObjectOwnership(results, QQmlEngine::JavaScriptOwnership);
+    return results;
+}
+
+const ApiObject::DistinctValues& ApiObject::distinctValues() const
+{
+    if (!m_distinct_values.valid) {
+        const std::vector<model::Game*>& games = m_all_games->entries();
+        m_distinct_values.developers = distinct_values(games, &model::Game::developerListConst);
+        m_distinct_values.publishers = distinct_values(games, &model::Game::publisherListConst);
+        m_distinct_values.genres = distinct_values(games, &model::Game::genreListConst);
+        m_distinct_values.tags = distinct_values(games, &model::Game::tagListConst);
+        m_distinct_values.valid = true;
+    }
+
+    return m_distinct_values;
+}
+
+void ApiObject::adoptGame(model::Game* const game)
+{
+    game->moveToThread(thread());
+    game->setParent(this);
+
+    connect(game, &model::Game::launchFileSelectorRequested,
+            this, &ApiObject::onGameFileSelectorRequested);
+    connect(game, &model::Game::favoriteChanged,
+            this, &ApiObject::onGameFavoriteChanged);
+
+    for (model::GameFile* const gamefile : game->files()) {
+        connect(gamefile, &model::GameFile::launchRequested,
+                this, &ApiObject::onGameFileLaunchRequested);
+    }
+}
+
+void ApiObject::adoptCollection(model::Collection* const coll)
+{
+    coll->moveToThread(thread());
+    coll->setParent(this);
+}
+
 void ApiObject::onGameFileSelectorRequested()
 {
     auto game = static_cast<model::Game*>(QObject::sender());
@@ -115,9 +359,34 @@ void ApiObject::onGameFavoriteChanged()
 
 void ApiObject::onLocaleChanged()
 {
+    if (update_sort_keys(m_collections->entries(), m_all_games->entries()))
+        sortLists();
+
     emit retranslationRequested();
 }
 
+void ApiObject::sortLists()
+{
+    std::vector<model::Collection*> collections = m_collections->entries();
+    std::sort(collections.begin(), collections.end(), model::sort_collections);
+    m_collections->sync(std::move(collections));
+
+    std::vector<model::Game*> games = m_all_games->entries();
+    std::sort(games.begin(), games.end(), model::sort_games);
+    m_all_games->sync(std::move(games));
+
+    for (model::Collection* const coll : m_collections->entries()) {
+        std::vector<model::Game*> coll_games = coll->gameList()->entries();
+        std::sort(coll_games.begin(), coll_games.end(), model::sort_games);
+        coll->gameList()->sync(std::move(coll_games));
+    }
+    for (model::Game* const game : m_all_games->entries()) {
+        std::vector<model::Collection*> game_colls = game->collections();
+        std::sort(game_colls.begin(), game_colls.end(), model::sort_collections);
+        game->syncCollections(std::move(game_colls));
+    }
+}
+
 void ApiObject::onThemeChanged(QString theme_dir)
 {
     m_memory.changeTheme(theme_dir);
@@ -20,6 +20,7 @@
 #include "CliArgs.h"
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameSearchIndex.h"
 #include "model/device/DeviceInfo.h"
 #include "model/keys/Keys.h"
 #include "model/memory/Memory.h"
@@ -43,6 +44,12 @@ class ApiObject : public QObject {
     Q_PROPERTY(ObjectListModel* collections READ collections CONSTANT)
     Q_PROPERTY(ObjectListModel* allGames READ allGames CONSTANT)
 
+    // the distinct values used by the games, in alphabetical order
+    Q_PROPERTY(QStringList allDevelopers READ allDevelopers NOTIFY gamedataReady)
+    Q_PROPERTY(QStringList allPublishers READ allPublishers NOTIFY gamedataReady)
+    Q_PROPERTY(QStringList allGenres READ allGenres NOTIFY gamedataReady)
+    Q_PROPERTY(QStringList allTags READ allTags NOTIFY gamedataReady)
+
     // retranslate on locale change
     Q_PROPERTY(QString tr READ emptyString NOTIFY retranslationRequested)
 
@@ -51,11 +58,21 @@ public:
 
     // scanning
     void clearGameData();
-    void setGameData(std::vector<model::Collection*>&&, std::vector<model::Game*>&&);
+    void setGameData(std::vector<model::Collection*>&&, std::vector<model::Game*>&&, GameSearchIndex&&);
+    void syncGameData(std::vector<model::Collection*>&&, std::vector<model::Game*>&&);
 
     CollectionListModel* collections() const { return m_collections; }
     GameListModel* allGames() const { return m_all_games; }
 
+    const QStringList& allDevelopers() const { return distinctValues().developers; }
+    const QStringList& allPublishers() const { return distinctValues().publishers; }
+    const QStringList& allGenres() const { return distinctValues().genres; }
+    const QStringList& allTags() const { return distinctValues().tags; }
+
+    // searches the title, developer, publisher and tag texts of all games;
+    // returns the matching games, best matches first (limit 0 means all of them)
+    Q_INVOKABLE model::ObjectListModel* search(const QString& query, int limit = 0) const;
+
 signals:
     // loading
     void gamedataReady();
@@ -100,5 +117,22 @@ private:
 
     CollectionListModel* m_collections = nullptr;
     GameListModel* m_all_games = nullptr;
+    GameSearchIndex m_search_index;
+
+    // created on the first use after the games have changed
+    struct DistinctValues {
+        bool valid = false;
+        QStringList developers;
+        QStringList publishers;
+        QStringList genres;
+        QStringList tags;
+    };
+    mutable DistinctValues m_distinct_values;
+    const DistinctValues& distinctValues() const;
+
+    void adoptGame(model::Game* const);
+    void adoptCollection(model::Collection* const);
+    // sorts the game and collection lists again, after their keys have changed
+    void sortLists();
 };
 } // namespace model
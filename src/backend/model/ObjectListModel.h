@@ -17,7 +17,11 @@
 
 #pragma once
 
+#include "utils/HashMap.h"
+
 #include <QAbstractListModel>
+#include <algorithm>
+#include <unordered_set>
 
 
 namespace model {
@@ -59,6 +63,7 @@ public:
             QObject::disconnect(entry, nullptr, this, nullptr);
 
         m_entries = std::move(entries);
+        rebuildRows();
 
         for (T* entry : m_entries)
             connectEntry(entry);
@@ -68,6 +73,105 @@ public:
             emit countChanged();
     }
 
+    /// Changes the contents to the new list with row-level insertions and removals,
+    /// so views can keep their state. The entries present in both lists have to be
+    /// in the same relative order, otherwise the model is reset. The model is also
+    /// reset when the changes are scattered into too many ranges, as then signaling
+    /// them one by one would cost more than what the views could save.
+    void sync(std::vector<T*>&& entries) {
+        // NOTE: the row index also serves as the set of the old entries
+        const std::unordered_set<T*> new_set(entries.cbegin(), entries.cend());
+        const auto is_old = [this](T* const entry){ return m_rows.count(entry) > 0; };
+
+        size_t kept_idx = 0;
+        for (T* entry : entries) {
+            if (!is_old(entry))
+                continue;
+            while (kept_idx < m_entries.size() && !new_set.count(m_entries[kept_idx]))
+                kept_idx++;
+            if (kept_idx == m_entries.size() || m_entries[kept_idx] != entry) {
+                update(std::move(entries));
+                return;
+            }
+            kept_idx++;
+        }
+
+        size_t range_count = 0;
+        for (size_t i = 0; i < m_entries.size(); i++) {
+            const bool removed = !new_set.count(m_entries[i]);
+            if (removed && (i == 0 || new_set.count(m_entries[i - 1])))
+                range_count++;
+        }
+        for (size_t i = 0; i < entries.size(); i++) {
+            const bool added = !is_old(entries[i]);
+            if (added && (i == 0 || is_old(entries[i - 1])))
+                range_count++;
+        }
+        if (range_count > MAX_SYNC_RANGES) {
+            update(std::move(entries));
+            return;
+        }
+
+        const size_t old_count = m_entries.size();
+
+        // NOTE: The row index is only rebuilt once at the end, from the first
+        //       changed row, as doing it after every range would make the sync
+        //       quadratic. Until then the rows of the entries after a change are
+        //       not up to date, so indexOf() should not be used by the views
+        //       while handling the signals.
+        size_t first_changed_row = m_entries.size();
+
+        // removals, in continuous ranges from the back
+        for (size_t end = m_entries.size(); end > 0;) {
+            if (new_set.count(m_entries[end - 1])) {
+                end--;
+                continue;
+            }
+
+            size_t begin = end - 1;
+            while (begin > 0 && !new_set.count(m_entries[begin - 1]))
+                begin--;
+
+            beginRemoveRows(QModelIndex(), begin, end - 1);
+            for (size_t i = begin; i < end; i++) {
+                QObject::disconnect(m_entries[i], nullptr, this, nullptr);
+                m_rows.erase(m_entries[i]);
+            }
+            m_entries.erase(m_entries.begin() + begin, m_entries.begin() + end);
+            endRemoveRows();
+
+            first_changed_row = begin;
+            end = begin;
+        }
+
+        // insertions, in continuous ranges from the front
+        for (size_t row = 0; row < entries.size();) {
+            if (is_old(entries[row])) {
+                row++;
+                continue;
+            }
+
+            size_t end = row + 1;
+            while (end < entries.size() && !is_old(entries[end]))
+                end++;
+
+            beginInsertRows(QModelIndex(), row, end - 1);
+            m_entries.insert(m_entries.begin() + row, entries.cbegin() + row, entries.cbegin() + end);
+            for (size_t i = row; i < end; i++)
+                connectEntry(m_entries[i]);
+            endInsertRows();
+
+            first_changed_row = std::min(first_changed_row, row);
+            row = end;
+        }
+
+        Q_ASSERT(m_entries == entries);
+        rebuildRows(first_changed_row);
+
+        if (m_entries.size() != old_count)
+            emit countChanged();
+    }
+
     int rowCount(const QModelIndex& parent = QModelIndex()) const override {
         return parent.isValid() ? 0 : m_entries.size();
     }
@@ -79,10 +183,10 @@ public:
     }
 
     int indexOf(QObject* item) const override {
-        const auto it = std::find(m_entries.cbegin(), m_entries.cend(), item);
-        return it == m_entries.cend()
+        const auto it = m_rows.find(item);
+        return it == m_rows.cend()
             ? -1
-            : std::distance(m_entries.cbegin(), it);
+            : static_cast<int>(it->second);
     }
 
     bool isEmpty() const override { return m_entries.empty(); }
@@ -100,6 +204,68 @@ public:
 protected:
     virtual void connectEntry(T* const) {};
 
+    /// Reports a change of the entry's data. The changes made during the same
+    /// event loop cycle are collected, and emitted as ranged dataChanged signals.
+    void entryChanged(const QObject* entry, const QVector<int>& roles) {
+        if (!m_rows.count(entry))
+            return;
+
+        m_changed_entries.emplace_back(entry);
+        for (const int role : roles) {
+            if (!m_changed_roles.contains(role))
+                m_changed_roles.append(role);
+        }
+
+        if (!m_change_flush_pending) {
+            m_change_flush_pending = true;
+            QMetaObject::invokeMethod(this, [this]{ flushChanges(); }, Qt::QueuedConnection);
+        }
+    }
+
     std::vector<T*> m_entries;
+
+private:
+    static constexpr size_t MAX_SYNC_RANGES = 256;
+
+    HashMap<const QObject*, size_t> m_rows;
+    std::vector<const QObject*> m_changed_entries;
+    QVector<int> m_changed_roles;
+    bool m_change_flush_pending = false;
+
+    void rebuildRows(size_t first_row = 0) {
+        if (first_row == 0)
+            m_rows.clear();
+        for (size_t row = first_row; row < m_entries.size(); row++)
+            m_rows[m_entries[row]] = row;
+    }
+
+    void flushChanges() {
+        m_change_flush_pending = false;
+
+        // NOTE: the entries may have been removed or moved since the change
+        std::vector<size_t> rows;
+        rows.reserve(m_changed_entries.size());
+        for (const QObject* entry : m_changed_entries) {
+            const auto it = m_rows.find(entry);
+            if (it != m_rows.cend())
+                rows.emplace_back(it->second);
+        }
+        m_changed_entries.clear();
+
+        const QVector<int> roles = std::move(m_changed_roles);
+        m_changed_roles.clear();
+
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        for (size_t begin = 0; begin < rows.size();) {
+            size_t end = begin + 1;
+            while (end < rows.size() && rows[end] == rows[end - 1] + 1)
+                end++;
+
+            emit dataChanged(index(rows[begin]), index(rows[end - 1]), roles);
+            begin = end;
+        }
+    }
 };
 } // namespace model
@@ -17,49 +17,290 @@
 
 #include "Assets.h"
 
+#include "Log.h"
+#include "utils/FlatHashMap.h"
+
+#include <QReadWriteLock>
 #include <QUrl>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <limits>
+
+
+namespace {
+// The lowest bit of a handle marks local files, the rest is the index in the pool
+constexpr uint32_t FILE_FLAG = 0x1;
+// Lists with up to this many handles are searched for duplicates directly
+constexpr size_t INDEX_THRESHOLD = 32;
+
+/// The single copy of every asset path and URL
+///
+/// The games are filled in by multiple threads during a scan and read by the
+/// UI at the same time, so the pool is guarded by a lock. The URLs of local
+/// files are only created on the first read. The strings are counted by the
+/// number of lists using them, and dropped once the last of these is gone,
+/// so the paths of the removed games don't stay around after a rescan.
+class AssetPool {
+public:
+    /// Returns the id of the string, and counts one more use of it
+    uint32_t acquire(QString str)
+    {
+        {
+            // NOTE: the count is atomic, as there might be other readers
+            const QReadLocker lock(&m_lock);
+            const auto it = m_ids.find(str);
+            if (it != m_ids.cend()) {
+                m_entries[it->second].refs++;
+                return it->second;
+            }
+        }
+
+        const QWriteLocker lock(&m_lock);
+        const auto it = m_ids.find(str);
+        if (it != m_ids.cend()) {
+            m_entries[it->second].refs++;
+            return it->second;
+        }
+
+        uint32_t id = 0;
+        if (m_free_ids.empty()) {
+            id = static_cast<uint32_t>(m_entries.size());
+            m_entries.emplace_back();
+        }
+        else {
+            id = m_free_ids.back();
+            m_free_ids.pop_back();
+        }
+
+        Entry& entry = m_entries[id];
+        entry.value = str;
+        entry.refs = 1;
+        m_ids.emplace(std::move(str), id);
+        return id;
+    }
+
+    /// Counts one less use of the string, and drops it if it's no longer used
+    void release(uint32_t id)
+    {
+        const QWriteLocker lock(&m_lock);
+        release_locked(id);
+    }
+
+    /// Same as release(), for all handles of a list
+    void release_handles(const std::vector<uint32_t>& handles)
+    {
+        if (handles.empty())
+            return;
+
+        const QWriteLocker lock(&m_lock);
+        for (const uint32_t handle : handles)
+            release_locked(handle >> 1);
+    }
+
+    QString value(uint32_t id) const
+    {
+        const QReadLocker lock(&m_lock);
+        return m_entries[id].value;
+    }
+
+    QString file_url(uint32_t id)
+    {
+        QString path;
+        {
+            const QReadLocker lock(&m_lock);
+            const Entry& entry = m_entries[id];
+            if (!entry.file_url.isNull())
+                return entry.file_url;
+
+            path = entry.value;
+        }
+
+        QString url = QUrl::fromLocalFile(path).toString();
+
+        const QWriteLocker lock(&m_lock);
+        m_entries[id].file_url = url;
+        return url;
+    }
+
+    size_t size() const
+    {
+        const QReadLocker lock(&m_lock);
+        return m_ids.size();
+    }
+
+private:
+    struct Entry {
+        QString value;
+        QString file_url;
+        std::atomic<uint32_t> refs;
+    };
+
+    mutable QReadWriteLock m_lock;
+    FlatHashMap<QString, uint32_t> m_ids;
+    // NOTE: a deque never moves the existing items when growing
+    std::deque<Entry> m_entries;
+    std::vector<uint32_t> m_free_ids;
+
+    void release_locked(uint32_t id)
+    {
+        Entry& entry = m_entries[id];
+        Q_ASSERT(entry.refs > 0);
+        if (--entry.refs > 0)
+            return;
+
+        m_ids.erase(entry.value);
+        entry.value = QString();
+        entry.file_url = QString();
+        m_free_ids.push_back(id);
+    }
+};
+
+AssetPool& asset_pool()
+{
+    static AssetPool pool;
+    return pool;
+}
+
+QString handle_to_url(uint32_t handle)
+{
+    return (handle & FILE_FLAG)
+        ? asset_pool().file_url(handle >> 1)
+        : asset_pool().value(handle >> 1);
+}
+} // namespace
 
 
 namespace model {
 
-Assets::Assets(QObject* parent)
-    : QObject(parent)
-{}
+/// The asset types each handle of the list was added as, one bit per type
+struct AssetLists::HandleIndex {
+    static_assert(ASSET_TYPE_COUNT <= 32, "the asset types don't fit into the bits of the index");
+    FlatHashMap<uint32_t, uint32_t> type_bits;
+};
+
+AssetLists::AssetLists()
+{
+    m_offsets.fill(0);
+}
+
+AssetLists::~AssetLists()
+{
+    asset_pool().release_handles(m_handles);
+}
 
-const QStringList& Assets::get(AssetType key) const {
-    static const QStringList empty;
+size_t AssetLists::pool_size()
+{
+    return asset_pool().size();
+}
+
+QStringList AssetLists::get(AssetType key) const
+{
+    const auto type_idx = static_cast<size_t>(key);
 
-    const auto it = m_asset_lists.find(key);
-    if (it != m_asset_lists.cend())
-        return it->second;
+    QStringList out;
+    out.reserve(m_offsets[type_idx + 1] - m_offsets[type_idx]);
+    for (size_t i = m_offsets[type_idx]; i < m_offsets[type_idx + 1]; i++)
+        out.append(handle_to_url(m_handles[i]));
 
-    return empty;
+    return out;
+}
+
+QString AssetLists::getFirst(AssetType key) const
+{
+    const auto type_idx = static_cast<size_t>(key);
+    if (m_offsets[type_idx] == m_offsets[type_idx + 1])
+        return QString();
+
+    return handle_to_url(m_handles[m_offsets[type_idx]]);
+}
+
+bool AssetLists::has(AssetType key) const
+{
+    const auto type_idx = static_cast<size_t>(key);
+    return m_offsets[type_idx] != m_offsets[type_idx + 1];
 }
 
-const QString& Assets::getFirst(AssetType key) const {
-    static const QString empty;
+std::vector<StoredAsset> AssetLists::stored(AssetType key) const
+{
+    const auto type_idx = static_cast<size_t>(key);
+
+    std::vector<StoredAsset> out;
+    out.reserve(m_offsets[type_idx + 1] - m_offsets[type_idx]);
+    for (size_t i = m_offsets[type_idx]; i < m_offsets[type_idx + 1]; i++) {
+        const uint32_t handle = m_handles[i];
+        out.push_back({ asset_pool().value(handle >> 1), !!(handle & FILE_FLAG) });
+    }
+
+    return out;
+}
 
-    const QStringList& list = get(key);
-    if (!list.isEmpty())
-        return list.constFirst();
+AssetLists& AssetLists::add_file(AssetType key, QString path)
+{
+    if (path.isEmpty())
+        return *this;
 
-    return empty;
+    return add_handle(key, (asset_pool().acquire(std::move(path)) << 1) | FILE_FLAG);
 }
 
-Assets& Assets::add_file(AssetType key, QString path)
+AssetLists& AssetLists::add_uri(AssetType key, QString url)
 {
-    QString uri = QUrl::fromLocalFile(std::move(path)).toString();
-    return add_uri(key, std::move(uri));
+    if (url.isEmpty())
+        return *this;
+
+    return add_handle(key, asset_pool().acquire(std::move(url)) << 1);
 }
 
-Assets& Assets::add_uri(AssetType key, QString url)
+AssetLists& AssetLists::add_handle(AssetType key, uint32_t handle)
 {
-    QStringList& target = m_asset_lists[key];
+    const auto type_idx = static_cast<size_t>(key);
+    const auto list_begin = m_handles.begin() + m_offsets[type_idx];
+    const auto list_end = m_handles.begin() + m_offsets[type_idx + 1];
+
+    const uint32_t type_bit = 1u << type_idx;
+
+    // NOTE: the interned strings are equal only if their handles are equal
+    bool is_duplicate = false;
+    if (m_index) {
+        const auto it = m_index->type_bits.find(handle);
+        is_duplicate = it != m_index->type_bits.cend() && (it->second & type_bit);
+    }
+    else {
+        is_duplicate = std::find(list_begin, list_end, handle) != list_end;
+    }
 
-    if (!url.isEmpty() && !target.contains(url))
-        target.append(std::move(url));
+    constexpr size_t MAX_HANDLES = std::numeric_limits<uint16_t>::max();
+    if (is_duplicate || m_handles.size() >= MAX_HANDLES) {
+        asset_pool().release(handle >> 1);
+        return *this;
+    }
+
+    m_handles.insert(list_end, handle);
+    for (size_t i = type_idx + 1; i < m_offsets.size(); i++)
+        m_offsets[i]++;
+
+    if (m_index) {
+        m_index->type_bits[handle] |= type_bit;
+    }
+    else if (m_handles.size() > INDEX_THRESHOLD) {
+        m_index = std::make_unique<HandleIndex>();
+        m_index->type_bits.reserve(m_handles.size() * 2);
+        for (size_t type = 0; type < ASSET_TYPE_COUNT; type++) {
+            for (size_t i = m_offsets[type]; i < m_offsets[type + 1]; i++)
+                m_index->type_bits[m_handles[i]] |= 1u << type;
+        }
+    }
+
+    if (m_handles.size() == MAX_HANDLES)
+        Log::warning(LOGMSG("An item reached the limit of %1 assets, the rest of its assets will be ignored").arg(MAX_HANDLES));
 
     return *this;
 }
 
+
+Assets::Assets(const AssetLists& data, QObject* parent)
+    : QObject(parent)
+    , m_data(data)
+{}
+
 } // namespace model
@@ -18,14 +18,91 @@
 #pragma once
 
 #include "types/AssetType.h"
-#include "utils/HashMap.h"
-#include "utils/MoveOnly.h"
+#include "utils/NoCopyNoMove.h"
 
 #include <QStringList>
 #include <QObject>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 
 namespace model {
+/// An asset in the form it is stored, see AssetLists::stored()
+struct StoredAsset {
+    QString value;
+    bool is_file;
+};
+
+
+/// The assets of a game or collection
+///
+/// The paths and URLs are interned in a program-wide pool, and the lists only
+/// keep handles to them. Local files are stored as paths, and only turned
+/// into URLs when they are actually read. The strings are released from the
+/// pool together with the last list referring them.
+class AssetLists {
+public:
+#define GEN(qmlname, enumname) \
+    QString qmlname() const { return getFirst(AssetType::enumname); } \
+    QStringList qmlname##List() const { return get(AssetType::enumname); }
+
+    GEN(boxFront, BOX_FRONT)
+    GEN(boxBack, BOX_BACK)
+    GEN(boxSpine, BOX_SPINE)
+    GEN(boxFull, BOX_FULL)
+    GEN(cartridge, CARTRIDGE)
+    GEN(logo, LOGO)
+    GEN(poster, POSTER)
+
+    GEN(marquee, ARCADE_MARQUEE)
+    GEN(bezel, ARCADE_BEZEL)
+    GEN(panel, ARCADE_PANEL)
+    GEN(cabinetLeft, ARCADE_CABINET_L)
+    GEN(cabinetRight, ARCADE_CABINET_R)
+
+    GEN(tile, UI_TILE)
+    GEN(banner, UI_BANNER)
+    GEN(steam, UI_STEAMGRID)
+    GEN(background, BACKGROUND)
+    GEN(music, MUSIC)
+
+    GEN(screenshot, SCREENSHOT)
+    GEN(titlescreen, TITLESCREEN)
+    GEN(video, VIDEO)
+#undef GEN
+
+public:
+    explicit AssetLists();
+    ~AssetLists();
+    NO_COPY_NO_MOVE(AssetLists)
+
+    AssetLists& add_file(AssetType, QString);
+    AssetLists& add_uri(AssetType, QString);
+
+    QStringList get(AssetType) const;
+    QString getFirst(AssetType) const;
+    bool has(AssetType) const;
+
+    std::vector<StoredAsset> stored(AssetType) const;
+
+    /// The number of distinct paths and URLs currently in use
+    static size_t pool_size();
+
+private:
+    // the handles of all types, grouped by type, and the start of each group
+    std::vector<uint32_t> m_handles;
+    std::array<uint16_t, ASSET_TYPE_COUNT + 1> m_offsets;
+    // created only for the lists that grow large, to find duplicates quicker
+    struct HandleIndex;
+    std::unique_ptr<HandleIndex> m_index;
+
+    AssetLists& add_handle(AssetType, uint32_t);
+};
+
+
+/// The QML interface of the asset lists, created only when it is actually used
 class Assets : public QObject {
     Q_OBJECT
 
@@ -35,10 +112,10 @@ public:
     // TODO: these could be optimized, see
     //       https://doc.qt.io/qt-5/qtqml-cppintegration-data.html (Sequence Type to JavaScript Array)
 #define GEN(qmlname, enumname) \
-    const QString& qmlname() const { return getFirst(AssetType::enumname); } \
-    const QStringList& qmlname##List() const { return get(AssetType::enumname); } \
-    Q_PROPERTY(QString qmlname READ qmlname CONSTANT) \
-    Q_PROPERTY(QStringList qmlname##List READ qmlname##List CONSTANT) \
+    QString qmlname() const { return m_data.qmlname(); } \
+    QStringList qmlname##List() const { return m_data.qmlname##List(); } \
+    Q_PROPERTY(QString qmlname READ qmlname NOTIFY assetsChanged) \
+    Q_PROPERTY(QStringList qmlname##List READ qmlname##List NOTIFY assetsChanged) \
 
     GEN(boxFront, BOX_FRONT)
     GEN(boxBack, BOX_BACK)
@@ -67,20 +144,18 @@ public:
 
     // deprecated fallacks
     // TODO: remove
-    Q_PROPERTY(QStringList screenshots READ screenshotList CONSTANT)
-    Q_PROPERTY(QStringList videos READ videoList CONSTANT)
+    Q_PROPERTY(QStringList screenshots READ screenshotList NOTIFY assetsChanged)
+    Q_PROPERTY(QStringList videos READ videoList NOTIFY assetsChanged)
 
 public:
-    explicit Assets(QObject* parent);
+    explicit Assets(const AssetLists&, QObject* parent);
 
-    Assets& add_file(AssetType, QString);
-    Assets& add_uri(AssetType, QString);
+signals:
+    // the lists can be extended after the game got published
+    void assetsChanged();
 
 private:
-    const QStringList& get(AssetType) const;
-    const QString& getFirst(AssetType) const;
-
-    HashMap<AssetType, QStringList, EnumHash> m_asset_lists;
+    const AssetLists& m_data;
 };
 
 } // namespace model
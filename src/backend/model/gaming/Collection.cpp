@@ -38,12 +38,44 @@ void CollectionData::set_short_name(const QString& name)
 Collection::Collection(QString name, QObject* parent)
     : QObject(parent)
     , m_data(std::move(name))
-    , m_assets(new model::Assets(this))
 {}
 
+Collection& Collection::setSortBy(QString sort_by)
+{
+    m_data.sort_by = std::move(sort_by);
+    m_sort_key = SortKey();
+    return *this;
+}
+
+const SortKey& Collection::sortKey() const
+{
+    if (!m_sort_key.isValid())
+        m_sort_key = SortKey(m_data.sort_by);
+
+    return m_sort_key;
+}
+
+bool Collection::updateSortKey()
+{
+    if (m_sort_key.isCurrent())
+        return false;
+
+    m_sort_key = SortKey(m_data.sort_by);
+    return true;
+}
+
+Assets* Collection::assetsPtr() const
+{
+    if (!m_assets)
+        m_assets = new model::Assets(m_asset_lists, const_cast<Collection*>(this));
+
+    return m_assets;
+}
+
 Collection& Collection::setGames(std::vector<model::Game*>&& games)
 {
-    std::sort(games.begin(), games.end(), model::sort_games);
+    if (!std::is_sorted(games.cbegin(), games.cend(), model::sort_games))
+        std::sort(games.begin(), games.end(), model::sort_games);
 
     Q_ASSERT(!m_games);
     m_games = new GameListModel(this);
@@ -52,6 +84,6 @@ Collection& Collection::setGames(std::vector<model::Game*>&& games)
 }
 
 bool sort_collections(const model::Collection* const a, const model::Collection* const b) {
-    return QString::localeAwareCompare(a->sortBy(), b->sortBy()) < 0;
+    return a->sortKey() < b->sortKey();
 }
 } // namespace model
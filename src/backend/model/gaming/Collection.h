@@ -17,7 +17,9 @@
 
 #pragma once
 
+#include "Assets.h"
 #include "GameListModel.h"
+#include "utils/SortKey.h"
 
 #include <QString>
 
@@ -26,7 +28,6 @@
 #include "model/gaming/Game.h"
 #endif
 
-namespace model { class Assets; }
 namespace model { class Game; }
 
 
@@ -73,7 +74,7 @@ public:
 #define SETTER(type, name, field) \
     Collection& set##name(type val) { m_data.field = std::move(val); return *this; }
 
-    SETTER(QString, SortBy, sort_by)
+    Collection& setSortBy(QString);
     SETTER(QString, Summary, summary)
     SETTER(QString, Description, description)
     SETTER(QString, CommonLaunchCmd, common_launch_cmd)
@@ -94,11 +95,16 @@ public:
     QVariantMap& extraMapMut() { return m_extra; }
 
 
-    const Assets& assets() const { return *m_assets; }
-    Assets& assetsMut() { return *m_assets; }
-    Assets* assetsPtr() const { return m_assets; }
+    const AssetLists& assets() const { return m_asset_lists; }
+    AssetLists& assetsMut() { return m_asset_lists; }
+    Assets* assetsPtr() const;
     Q_PROPERTY(model::Assets* assets READ assetsPtr CONSTANT)
 
+    // the collation key of sortBy, created on the first use, and
+    // created again after a change of the locale by updateSortKey()
+    const SortKey& sortKey() const;
+    bool updateSortKey();
+
     Collection& setGames(std::vector<model::Game*>&&);
     GameListModel* gameList() const { return m_games; }
     Q_PROPERTY(ObjectListModel* games READ gameList CONSTANT)
@@ -111,7 +117,9 @@ public:
 private:
     CollectionData m_data;
     QVariantMap m_extra;
-    Assets* const m_assets;
+    AssetLists m_asset_lists;
+    mutable SortKey m_sort_key;
+    mutable Assets* m_assets = nullptr;
 
     GameListModel* m_games = nullptr;
 };
@@ -39,13 +39,40 @@ GameData::GameData(QString new_title)
 Game::Game(QString name, QObject* parent)
     : QObject(parent)
     , m_data(std::move(name))
-    , m_assets(new model::Assets(this))
 {}
 
 Game::Game(QObject* parent)
     : Game(QString(), parent)
 {}
 
+Assets* Game::assetsPtr() const
+{
+    if (!m_assets)
+        m_assets = new model::Assets(m_asset_lists, const_cast<Game*>(this));
+
+    return m_assets;
+}
+
+CollectionListModel* Game::collectionsModel() const
+{
+    if (!m_collections_model) {
+        m_collections_model = new CollectionListModel(const_cast<Game*>(this));
+        m_collections_model->update(std::vector<model::Collection*>(m_collections));
+    }
+
+    return m_collections_model;
+}
+
+GameFileListModel* Game::filesModel() const
+{
+    if (!m_files_model) {
+        m_files_model = new GameFileListModel(const_cast<Game*>(this));
+        m_files_model->update(std::vector<model::GameFile*>(m_files));
+    }
+
+    return m_files_model;
+}
+
 QString Game::developerStr() const { return joined_list(m_data.developers); }
 QString Game::publisherStr() const { return joined_list(m_data.publishers); }
 QString Game::genreStr() const { return joined_list(m_data.genres); }
@@ -59,6 +86,30 @@ Game& Game::setTitle(QString title)
     return *this;
 }
 
+Game& Game::setSortBy(QString sort_by)
+{
+    m_data.sort_by = std::move(sort_by);
+    m_sort_key = SortKey();
+    return *this;
+}
+
+const SortKey& Game::sortKey() const
+{
+    if (!m_sort_key.isValid())
+        m_sort_key = SortKey(m_data.sort_by);
+
+    return m_sort_key;
+}
+
+bool Game::updateSortKey()
+{
+    if (m_sort_key.isCurrent())
+        return false;
+
+    m_sort_key = SortKey(m_data.sort_by);
+    return true;
+}
+
 Game& Game::setFavorite(bool new_val)
 {
     m_data.is_favorite = new_val;
@@ -84,27 +135,23 @@ Game& Game::setPlayerCount(int player_count)
     return *this;
 }
 
-void Game::onEntryPlayStatsChanged()
+void Game::updatePlayStats()
 {
     const auto prev_play_count = m_data.playstats.play_count;
     const auto prev_play_time = m_data.playstats.play_time;
     const auto prev_last_played = m_data.playstats.last_played;
 
-    Q_ASSERT(filesModel());
-    const std::vector<model::GameFile*>& filelist = filesModel()->entries();
-
-    m_data.playstats.play_count = std::accumulate(filelist.cbegin(), filelist.cend(), 0,
-        [](int sum, const model::GameFile* const gamefile){
-            return sum + gamefile->playCount();
-        });
-    m_data.playstats.play_time = std::accumulate(filelist.cbegin(), filelist.cend(), 0,
-        [](qint64 sum, const model::GameFile* const gamefile){
-            return sum + gamefile->playTime();
-        });
-    m_data.playstats.last_played = std::accumulate(filelist.cbegin(), filelist.cend(), QDateTime(),
-        [](const QDateTime& current_max, const model::GameFile* const gamefile){
-            return std::max(current_max, gamefile->lastPlayed());
-        });
+    int play_count = 0;
+    qint64 play_time = 0;
+    QDateTime last_played;
+    for (const model::GameFile* const gamefile : m_files) {
+        play_count += gamefile->playCount();
+        play_time += gamefile->playTime();
+        last_played = std::max(last_played, gamefile->lastPlayed());
+    }
+    m_data.playstats.play_count = play_count;
+    m_data.playstats.play_time = static_cast<int>(play_time);
+    m_data.playstats.last_played = std::move(last_played);
 
     const bool changed = prev_play_count != m_data.playstats.play_count
         || prev_play_time != m_data.playstats.play_time
@@ -113,30 +160,31 @@ void Game::onEntryPlayStatsChanged()
         emit playStatsChanged();
 }
 
+void Game::notifyAssetsChanged()
+{
+    // NOTE: if the QML object doesn't exist yet, there's nobody to notify
+    if (m_assets)
+        emit m_assets->assetsChanged();
+}
+
 void Game::launch()
 {
-    Q_ASSERT(m_files->count() > 0);
+    Q_ASSERT(!m_files.empty());
 
-    if (m_files->count() == 1)
-        m_files->entries().front()->launch();
+    if (m_files.size() == 1)
+        m_files.front()->launch();
     else
         emit launchFileSelectorRequested();
 }
 
 Game& Game::setFiles(std::vector<model::GameFile*>&& files)
 {
-    for (model::GameFile* const gamefile : files) {
-        connect(gamefile, &model::GameFile::playStatsChanged,
-                this, &model::Game::onEntryPlayStatsChanged);
-    }
-
     std::sort(files.begin(), files.end(), model::sort_gamefiles);
 
-    Q_ASSERT(!m_files);
-    m_files = new GameFileListModel(this);
-    m_files->update(std::move(files));
+    Q_ASSERT(m_files.empty() && !m_files_model);
+    m_files = std::move(files);
 
-    onEntryPlayStatsChanged();
+    updatePlayStats();
 
     return *this;
 }
@@ -145,13 +193,22 @@ Game& Game::setCollections(std::vector<model::Collection*>&& collections)
 {
     std::sort(collections.begin(), collections.end(), model::sort_collections);
 
-    Q_ASSERT(!m_collections);
-    m_collections = new CollectionListModel(this);
-    m_collections->update(std::move(collections));
+    Q_ASSERT(m_collections.empty() && !m_collections_model);
+    m_collections = std::move(collections);
+    return *this;
+}
+
+Game& Game::syncCollections(std::vector<model::Collection*>&& collections)
+{
+    m_collections = std::move(collections);
+
+    if (m_collections_model)
+        m_collections_model->sync(std::vector<model::Collection*>(m_collections));
+
     return *this;
 }
 
 bool sort_games(const model::Game* const a, const model::Game* const b) {
-   return QString::localeAwareCompare(a->sortBy(), b->sortBy()) < 0;
+   return a->sortKey() < b->sortKey();
 }
 } // namespace model
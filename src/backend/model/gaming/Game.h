@@ -17,8 +17,10 @@
 
 #pragma once
 
+#include "Assets.h"
 #include "CollectionListModel.h"
 #include "GameFileListModel.h"
+#include "utils/SortKey.h"
 
 #include <QDateTime>
 #include <QStringList>
@@ -29,7 +31,6 @@
 #include "model/gaming/GameFile.h"
 #endif
 
-namespace model { class Assets; }
 namespace model { class GameFile; }
 namespace model { class Collection; }
 
@@ -110,7 +111,7 @@ public:
     Game& set##name(type val) { m_data.field = std::move(val); return *this; }
 
     Game& setTitle(QString);
-    SETTER(QString, SortBy, sort_by)
+    Game& setSortBy(QString);
     SETTER(QString, Summary, summary)
     SETTER(QString, Description, description)
     SETTER(QDate, ReleaseDate, release_date)
@@ -163,28 +164,45 @@ public:
     QVariantMap& extraMapMut() { return m_extra; }
 
 
-    const Assets& assets() const { return *m_assets; }
-    Assets& assetsMut() { return *m_assets; }
-    Assets* assetsPtr() const { return m_assets; }
+    // NOTE: the QML objects of the lists are only created when first used
+    const AssetLists& assets() const { return m_asset_lists; }
+    AssetLists& assetsMut() { return m_asset_lists; }
+    Assets* assetsPtr() const;
     Q_PROPERTY(model::Assets* assets READ assetsPtr CONSTANT)
 
-    CollectionListModel* collectionsModel() const { return m_collections; }
+    // NOTE: the collation key of sortBy is created on the first use; this is
+    //       not thread safe, the keys of the found games are prepared in advance.
+    //       The key is not changed by a change of the locale until updateSortKey()
+    //       is called (on the thread of the game), so it's safe to use for sorting.
+    const SortKey& sortKey() const;
+    /// Creates the key again if it's outdated; returns true if it has changed
+    bool updateSortKey();
+
+    const std::vector<model::Collection*>& collections() const { return m_collections; }
+    CollectionListModel* collectionsModel() const;
     Q_PROPERTY(ObjectListModel* collections READ collectionsModel CONSTANT)
 
-    GameFileListModel* filesModel() const { return m_files; }
+    const std::vector<model::GameFile*>& files() const { return m_files; }
+    GameFileListModel* filesModel() const;
     Q_PROPERTY(ObjectListModel* files READ filesModel CONSTANT)
 
     Game& setFiles(std::vector<model::GameFile*>&&);
     Game& setCollections(std::vector<model::Collection*>&&);
+    Game& syncCollections(std::vector<model::Collection*>&&);
 
 
 private:
     GameData m_data;
-    Assets* const m_assets;
+    AssetLists m_asset_lists;
     QVariantMap m_extra;
 
-    CollectionListModel* m_collections = nullptr;
-    GameFileListModel* m_files = nullptr;
+    std::vector<model::Collection*> m_collections;
+    std::vector<model::GameFile*> m_files;
+
+    mutable SortKey m_sort_key;
+    mutable Assets* m_assets = nullptr;
+    mutable CollectionListModel* m_collections_model = nullptr;
+    mutable GameFileListModel* m_files_model = nullptr;
 
 signals:
     void launchFileSelectorRequested();
@@ -192,14 +210,16 @@ signals:
     void playStatsChanged();
     void missingChanged();
 
-private slots:
-    void onEntryPlayStatsChanged();
-
 
 public:
     explicit Game(QObject* parent = nullptr);
     explicit Game(QString name, QObject* parent = nullptr);
 
+    /// Recalculates the play stats from the files of the game
+    void updatePlayStats();
+    /// Notifies the QML side about the assets added since publishing the game
+    void notifyAssetsChanged();
+
     Q_INVOKABLE void launch();
 
     void finalize();
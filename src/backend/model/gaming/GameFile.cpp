@@ -19,6 +19,8 @@
 
 #include "model/gaming/Game.h"
 
+#include <algorithm>
+
 
 namespace model {
 QString pretty_filename(const QFileInfo& fi)
@@ -49,20 +51,67 @@ model::Game* GameFile::parentGame() const
     return static_cast<model::Game*>(parent());
 }
 
+const SortKey& GameFile::sortKey() const
+{
+    if (!m_sort_key.isValid())
+        m_sort_key = SortKey(m_data.name);
+
+    return m_sort_key;
+}
+
+bool GameFile::updateSortKey()
+{
+    if (m_sort_key.isCurrent())
+        return false;
+
+    m_sort_key = SortKey(m_data.name);
+    return true;
+}
+
 void GameFile::launch()
 {
     emit launchRequested();
 }
 
-void GameFile::update_playstats(int playcount, qint64 playtime, QDateTime last_played)
+void GameFile::add_playstats(int playcount, qint64 playtime, QDateTime last_played)
 {
     m_data.playstats.last_played = std::max(m_data.playstats.last_played, std::move(last_played));
     m_data.playstats.play_time += playtime;
     m_data.playstats.play_count += playcount;
+}
+
+void GameFile::update_playstats(int playcount, qint64 playtime, QDateTime last_played)
+{
+    add_playstats(playcount, playtime, std::move(last_played));
     emit playStatsChanged();
+    parentGame()->updatePlayStats();
+}
+
+void GameFile::update_playstats(const std::vector<model::PlaySession>& sessions)
+{
+    std::vector<model::GameFile*> changed_files;
+    changed_files.reserve(sessions.size());
+    for (const model::PlaySession& session : sessions) {
+        session.gamefile->add_playstats(session.play_count, session.play_time, session.last_played);
+        changed_files.emplace_back(session.gamefile);
+    }
+    std::sort(changed_files.begin(), changed_files.end());
+    changed_files.erase(std::unique(changed_files.begin(), changed_files.end()), changed_files.end());
+
+    std::vector<model::Game*> changed_games;
+    changed_games.reserve(changed_files.size());
+    for (model::GameFile* const gamefile : changed_files) {
+        emit gamefile->playStatsChanged();
+        changed_games.emplace_back(gamefile->parentGame());
+    }
+    std::sort(changed_games.begin(), changed_games.end());
+    changed_games.erase(std::unique(changed_games.begin(), changed_games.end()), changed_games.end());
+
+    for (model::Game* const game : changed_games)
+        game->updatePlayStats();
 }
 
 bool sort_gamefiles(const model::GameFile* const a, const model::GameFile* const b) {
-    return QString::localeAwareCompare(a->name(), b->name()) < 0;
+    return a->sortKey() < b->sortKey();
 }
 } // namespace model
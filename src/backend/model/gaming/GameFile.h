@@ -18,12 +18,15 @@
 #pragma once
 
 #include "utils/MoveOnly.h"
+#include "utils/SortKey.h"
 
 #include <QDateTime>
 #include <QFileInfo>
 #include <QString>
+#include <vector>
 
 namespace model { class Game; }
+namespace model { class GameFile; }
 
 
 namespace model {
@@ -53,12 +56,20 @@ struct GameFileData {
 };
 
 
+struct PlaySession {
+    model::GameFile* gamefile;
+    int play_count;
+    qint64 play_time;
+    QDateTime last_played;
+};
+
+
 class GameFile : public QObject {
     Q_OBJECT
 
 public:
     const QString& name() const { return m_data.name; }
-    GameFile& setName(QString val) { m_data.name = std::move(val); return *this; }
+    GameFile& setName(QString val) { m_data.name = std::move(val); m_sort_key = SortKey(); return *this; }
     QString path() const { return m_data.fileinfo.filePath(); }
     Q_PROPERTY(QString name READ name CONSTANT)
     Q_PROPERTY(QString path READ path CONSTANT)
@@ -72,6 +83,11 @@ public:
 
     const QFileInfo& fileinfo() const { return m_data.fileinfo; }
 
+    // the collation key of the name, created on the first use, and
+    // created again after a change of the locale by updateSortKey()
+    const SortKey& sortKey() const;
+    bool updateSortKey();
+
 public:
     explicit GameFile(QString, model::Game&);
 
@@ -80,6 +96,9 @@ public:
     Q_INVOKABLE void launch();
 
     void update_playstats(int playcount, qint64 playtime, QDateTime last_played);
+    /// Adds the play sessions to their files, then updates the stats
+    /// of every affected game once; has to be called on the thread of the objects
+    static void update_playstats(const std::vector<model::PlaySession>&);
 
 signals:
     void launchRequested();
@@ -87,6 +106,9 @@ signals:
 
 private:
     GameFileData m_data;
+    mutable SortKey m_sort_key;
+
+    void add_playstats(int playcount, qint64 playtime, QDateTime last_played);
 };
 
 
@@ -0,0 +1,385 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2022  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "GameQueryModel.h"
+
+#include "model/gaming/Game.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+#include <numeric>
+
+
+namespace {
+constexpr size_t BITS_PER_WORD = 64;
+
+std::vector<quint64> make_bitset(size_t bit_count, bool value)
+{
+    std::vector<quint64> bits((bit_count + BITS_PER_WORD - 1) / BITS_PER_WORD, value ? ~quint64(0) : 0);
+    const size_t tail = bit_count % BITS_PER_WORD;
+    if (value && tail)
+        bits.back() = (quint64(1) << tail) - 1;
+    return bits;
+}
+
+void set_bit(std::vector<quint64>& bits, size_t idx, bool value)
+{
+    const quint64 mask = quint64(1) << (idx % BITS_PER_WORD);
+    if (value)
+        bits[idx / BITS_PER_WORD] |= mask;
+    else
+        bits[idx / BITS_PER_WORD] &= ~mask;
+}
+
+bool test_bit(const std::vector<quint64>& bits, size_t idx)
+{
+    return bits[idx / BITS_PER_WORD] & (quint64(1) << (idx % BITS_PER_WORD));
+}
+
+void and_bits(std::vector<quint64>& target, const std::vector<quint64>& other)
+{
+    Q_ASSERT(target.size() == other.size());
+    for (size_t i = 0; i < target.size(); i++)
+        target[i] &= other[i];
+}
+
+template<typename Func>
+void for_each_set_bit(const std::vector<quint64>& bits, Func&& func)
+{
+    for (size_t word_idx = 0; word_idx < bits.size(); word_idx++) {
+        quint64 word = bits[word_idx];
+        while (word) {
+            func(word_idx * BITS_PER_WORD + qCountTrailingZeroBits(word));
+            word &= word - 1;
+        }
+    }
+}
+} // namespace
+
+
+namespace model {
+GameQueryModel::GameQueryModel(QObject* parent)
+    : GameListModel(parent)
+{
+    // NOTE: changes of the source often arrive in bursts (eg. while syncing
+    // a rescanned library), so those are handled once things calm down
+    m_requery_timer.setSingleShot(true);
+    m_requery_timer.setInterval(0);
+    connect(&m_requery_timer, &QTimer::timeout, this, &GameQueryModel::requery);
+}
+
+void GameQueryModel::classBegin()
+{
+    m_complete = false;
+}
+
+void GameQueryModel::componentComplete()
+{
+    m_complete = true;
+    requery();
+}
+
+void GameQueryModel::setSourceModel(ObjectListModel* source)
+{
+    if (m_source == source)
+        return;
+
+    if (m_source)
+        QObject::disconnect(m_source, nullptr, this, nullptr);
+
+    m_source = source;
+
+    if (m_source) {
+        connect(m_source, &QAbstractItemModel::rowsInserted, this, &GameQueryModel::onSourceRowsChanged);
+        connect(m_source, &QAbstractItemModel::rowsRemoved, this, &GameQueryModel::onSourceRowsChanged);
+        connect(m_source, &QAbstractItemModel::rowsMoved, this, &GameQueryModel::onSourceRowsChanged);
+        connect(m_source, &QAbstractItemModel::layoutChanged, this, &GameQueryModel::onSourceRowsChanged);
+        connect(m_source, &QAbstractItemModel::modelReset, this, &GameQueryModel::onSourceRowsChanged);
+        connect(m_source, &QAbstractItemModel::dataChanged, this, &GameQueryModel::onSourceDataChanged);
+        connect(m_source, &QObject::destroyed, this, &GameQueryModel::onSourceDestroyed);
+    }
+
+    m_index_valid = false;
+    emit sourceModelChanged();
+
+    if (m_complete)
+        requery();
+}
+
+
+void GameQueryModel::setTitleFilter(const QString& val)
+{
+    if (m_title_filter == val)
+        return;
+
+    m_title_filter = val;
+    m_title_filter_folded = val.toCaseFolded();
+    onQueryChanged();
+}
+
+#define QUERY_SETTER(type, setter, field) \
+    void GameQueryModel::setter(type val) { \
+        if (field == val) \
+            return; \
+        field = val; \
+        onQueryChanged(); \
+    }
+
+QUERY_SETTER(bool, setFavoritesOnly, m_favorites_only)
+QUERY_SETTER(bool, setHideMissing, m_hide_missing)
+QUERY_SETTER(const QString&, setGenreFilter, m_genre_filter)
+QUERY_SETTER(int, setMinPlayers, m_min_players)
+QUERY_SETTER(int, setMinYear, m_min_year)
+QUERY_SETTER(int, setMaxYear, m_max_year)
+QUERY_SETTER(const QDateTime&, setPlayedSince, m_played_since)
+QUERY_SETTER(int, setMinPlayCount, m_min_play_count)
+QUERY_SETTER(SortRole, setSortRole, m_sort_role)
+QUERY_SETTER(Qt::SortOrder, setSortOrder, m_sort_order)
+#undef QUERY_SETTER
+
+
+void GameQueryModel::onQueryChanged()
+{
+    emit queryChanged();
+
+    // NOTE: query changes are usually interactive, so they are answered right away
+    if (m_complete)
+        requery();
+}
+
+void GameQueryModel::onSourceRowsChanged()
+{
+    m_index_valid = false;
+    if (m_complete)
+        m_requery_timer.start();
+}
+
+void GameQueryModel::onSourceDataChanged(const QModelIndex& top_left, const QModelIndex& bottom_right)
+{
+    if (!m_index_valid)
+        return;
+
+    const size_t first = static_cast<size_t>(std::max(0, top_left.row()));
+    const size_t last = static_cast<size_t>(std::max(0, bottom_right.row()));
+    for (size_t idx = first; idx <= last; idx++) {
+        if (m_source_games.size() <= idx || m_source_games[idx] != m_source->get(static_cast<int>(idx))) {
+            m_index_valid = false;
+            break;
+        }
+        refreshIndexRow(idx);
+    }
+
+    // only the play stats can change in place, other fields are constant
+    m_sort_permutations.erase(SortRole::PlayCount);
+    m_sort_permutations.erase(SortRole::PlayTime);
+    m_sort_permutations.erase(SortRole::LastPlayed);
+
+    if (m_complete)
+        m_requery_timer.start();
+}
+
+void GameQueryModel::onSourceDestroyed()
+{
+    m_source = nullptr;
+    m_index_valid = false;
+    emit sourceModelChanged();
+
+    if (m_complete)
+        requery();
+}
+
+
+void GameQueryModel::rebuildIndex()
+{
+    m_source_games.clear();
+    m_index_rows.clear();
+    m_genre_bits.clear();
+    m_sort_permutations.clear();
+
+    const int source_count = m_source ? m_source->count() : 0;
+    m_source_games.reserve(source_count);
+    for (int i = 0; i < source_count; i++) {
+        auto* const game = qobject_cast<model::Game*>(m_source->get(i));
+        if (!game) {
+            m_source_games.clear();
+            break;
+        }
+        m_source_games.push_back(game);
+    }
+
+    m_index_rows.resize(m_source_games.size());
+    m_favorite_bits = make_bitset(m_source_games.size(), false);
+    m_present_bits = make_bitset(m_source_games.size(), false);
+    for (size_t idx = 0; idx < m_source_games.size(); idx++) {
+        const model::Game& game = *m_source_games[idx];
+        IndexRow& row = m_index_rows[idx];
+        row.folded_title = game.title().toCaseFolded();
+        row.release_year = game.releaseYear();
+        row.player_count = game.playerCount();
+        refreshIndexRow(idx);
+    }
+
+    m_index_valid = true;
+}
+
+void GameQueryModel::refreshIndexRow(size_t idx)
+{
+    const model::Game& game = *m_source_games[idx];
+    IndexRow& row = m_index_rows[idx];
+    row.play_count = game.playCount();
+    row.last_played = game.lastPlayed().isValid() ? game.lastPlayed().toMSecsSinceEpoch() : 0;
+    set_bit(m_favorite_bits, idx, game.isFavorite());
+    set_bit(m_present_bits, idx, !game.isMissing());
+}
+
+const GameQueryModel::Bitset& GameQueryModel::genreBits(const QString& genre)
+{
+    const auto it = m_genre_bits.find(genre);
+    if (it != m_genre_bits.cend())
+        return it->second;
+
+    Bitset bits = make_bitset(m_source_games.size(), false);
+    for (size_t idx = 0; idx < m_source_games.size(); idx++) {
+        if (m_source_games[idx]->genreListConst().contains(genre, Qt::CaseInsensitive))
+            set_bit(bits, idx, true);
+    }
+    return m_genre_bits.emplace(genre, std::move(bits)).first->second;
+}
+
+const std::vector<quint32>& GameQueryModel::sortPermutation(SortRole role)
+{
+    const auto it = m_sort_permutations.find(role);
+    if (it != m_sort_permutations.cend())
+        return it->second;
+
+    std::vector<quint32> perm(m_source_games.size());
+    std::iota(perm.begin(), perm.end(), 0);
+
+    const std::vector<model::Game*>& games = m_source_games;
+    const std::vector<IndexRow>& rows = m_index_rows;
+    switch (role) {
+        case SortRole::SourceOrder:
+            break;
+        case SortRole::Title:
+            std::stable_sort(perm.begin(), perm.end(), [&games](quint32 a, quint32 b){
+                return sort_games(games[a], games[b]);
+            });
+            break;
+        case SortRole::ReleaseDate:
+            std::stable_sort(perm.begin(), perm.end(), [&games](quint32 a, quint32 b){
+                return games[a]->releaseDate() < games[b]->releaseDate();
+            });
+            break;
+        case SortRole::Players:
+            std::stable_sort(perm.begin(), perm.end(), [&rows](quint32 a, quint32 b){
+                return rows[a].player_count < rows[b].player_count;
+            });
+            break;
+        case SortRole::Rating:
+            std::stable_sort(perm.begin(), perm.end(), [&games](quint32 a, quint32 b){
+                return games[a]->rating() < games[b]->rating();
+            });
+            break;
+        case SortRole::PlayCount:
+            std::stable_sort(perm.begin(), perm.end(), [&rows](quint32 a, quint32 b){
+                return rows[a].play_count < rows[b].play_count;
+            });
+            break;
+        case SortRole::PlayTime:
+            std::stable_sort(perm.begin(), perm.end(), [&games](quint32 a, quint32 b){
+                return games[a]->playTime() < games[b]->playTime();
+            });
+            break;
+        case SortRole::LastPlayed:
+            std::stable_sort(perm.begin(), perm.end(), [&rows](quint32 a, quint32 b){
+                return rows[a].last_played < rows[b].last_played;
+            });
+            break;
+    }
+
+    return m_sort_permutations.emplace(role, std::move(perm)).first->second;
+}
+
+
+bool GameQueryModel::hasRowFilters() const
+{
+    return !m_title_filter_folded.isEmpty()
+        || m_min_players > 0
+        || m_min_year > 0
+        || m_max_year > 0
+        || m_played_since.isValid()
+        || m_min_play_count > 0;
+}
+
+bool GameQueryModel::rowMatches(const IndexRow& row) const
+{
+    if (m_min_players > 0 && row.player_count < m_min_players)
+        return false;
+    if (m_min_year > 0 && row.release_year < m_min_year)
+        return false;
+    if (m_max_year > 0 && (row.release_year <= 0 || m_max_year < row.release_year))
+        return false;
+    if (m_min_play_count > 0 && row.play_count < m_min_play_count)
+        return false;
+    if (m_played_since.isValid() && (row.last_played == 0 || row.last_played < m_played_since.toMSecsSinceEpoch()))
+        return false;
+    if (!m_title_filter_folded.isEmpty() && !row.folded_title.contains(m_title_filter_folded))
+        return false;
+    return true;
+}
+
+void GameQueryModel::requery()
+{
+    m_requery_timer.stop();
+
+    if (!m_index_valid)
+        rebuildIndex();
+
+    const size_t game_count = m_source_games.size();
+
+    Bitset matches = make_bitset(game_count, true);
+    if (m_favorites_only)
+        and_bits(matches, m_favorite_bits);
+    if (m_hide_missing)
+        and_bits(matches, m_present_bits);
+    if (!m_genre_filter.isEmpty())
+        and_bits(matches, genreBits(m_genre_filter));
+
+    if (hasRowFilters()) {
+        Bitset row_matches = make_bitset(game_count, false);
+        for_each_set_bit(matches, [this, &row_matches](size_t idx){
+            if (rowMatches(m_index_rows[idx]))
+                set_bit(row_matches, idx, true);
+        });
+        matches = std::move(row_matches);
+    }
+
+    std::vector<model::Game*> result;
+    const auto add_if_matches = [this, &matches, &result](size_t idx){
+        if (test_bit(matches, idx))
+            result.push_back(m_source_games[idx]);
+    };
+
+    const std::vector<quint32>& perm = sortPermutation(m_sort_role);
+    if (m_sort_order == Qt::AscendingOrder)
+        std::for_each(perm.cbegin(), perm.cend(), add_if_matches);
+    else
+        std::for_each(perm.crbegin(), perm.crend(), add_if_matches);
+
+    sync(std::move(result));
+}
+} // namespace model
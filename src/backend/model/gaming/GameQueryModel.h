@@ -0,0 +1,150 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2022  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "model/gaming/GameListModel.h"
+#include "utils/HashMap.h"
+
+#include <QDateTime>
+#include <QQmlParserStatus>
+#include <QTimer>
+#include <vector>
+
+
+namespace model {
+/// A list of games selected and ordered from a source model by a declarative query
+///
+/// The query is answered from indexes built once per change of the source:
+/// bitsets for the favorite, missing and genre filters, cached values for the
+/// numeric ones, and lazily sorted permutations for the sort roles. Changing
+/// the query thus only needs a pass over these arrays, without having to touch
+/// the QML side of the games. The results are applied as row-level changes when
+/// the order allows it.
+class GameQueryModel : public GameListModel, public QQmlParserStatus {
+    Q_OBJECT
+    Q_INTERFACES(QQmlParserStatus)
+
+    Q_PROPERTY(model::ObjectListModel* sourceModel READ sourceModel WRITE setSourceModel NOTIFY sourceModelChanged)
+
+    Q_PROPERTY(QString titleFilter READ titleFilter WRITE setTitleFilter NOTIFY queryChanged)
+    Q_PROPERTY(bool favoritesOnly READ favoritesOnly WRITE setFavoritesOnly NOTIFY queryChanged)
+    Q_PROPERTY(bool hideMissing READ hideMissing WRITE setHideMissing NOTIFY queryChanged)
+    Q_PROPERTY(QString genreFilter READ genreFilter WRITE setGenreFilter NOTIFY queryChanged)
+    Q_PROPERTY(int minPlayers READ minPlayers WRITE setMinPlayers NOTIFY queryChanged)
+    Q_PROPERTY(int minYear READ minYear WRITE setMinYear NOTIFY queryChanged)
+    Q_PROPERTY(int maxYear READ maxYear WRITE setMaxYear NOTIFY queryChanged)
+    Q_PROPERTY(QDateTime playedSince READ playedSince WRITE setPlayedSince NOTIFY queryChanged)
+    Q_PROPERTY(int minPlayCount READ minPlayCount WRITE setMinPlayCount NOTIFY queryChanged)
+
+    Q_PROPERTY(SortRole sortRole READ sortRole WRITE setSortRole NOTIFY queryChanged)
+    Q_PROPERTY(Qt::SortOrder sortOrder READ sortOrder WRITE setSortOrder NOTIFY queryChanged)
+
+public:
+    enum SortRole {
+        SourceOrder,
+        Title,
+        ReleaseDate,
+        Players,
+        Rating,
+        PlayCount,
+        PlayTime,
+        LastPlayed,
+    };
+    Q_ENUM(SortRole)
+
+    explicit GameQueryModel(QObject* parent = nullptr);
+
+    ObjectListModel* sourceModel() const { return m_source; }
+    void setSourceModel(ObjectListModel*);
+
+#define QUERY_PROP(type, getter, setter, field) \
+    type getter() const { return field; } \
+    void setter(type);
+
+    QUERY_PROP(const QString&, titleFilter, setTitleFilter, m_title_filter)
+    QUERY_PROP(bool, favoritesOnly, setFavoritesOnly, m_favorites_only)
+    QUERY_PROP(bool, hideMissing, setHideMissing, m_hide_missing)
+    QUERY_PROP(const QString&, genreFilter, setGenreFilter, m_genre_filter)
+    QUERY_PROP(int, minPlayers, setMinPlayers, m_min_players)
+    QUERY_PROP(int, minYear, setMinYear, m_min_year)
+    QUERY_PROP(int, maxYear, setMaxYear, m_max_year)
+    QUERY_PROP(const QDateTime&, playedSince, setPlayedSince, m_played_since)
+    QUERY_PROP(int, minPlayCount, setMinPlayCount, m_min_play_count)
+    QUERY_PROP(SortRole, sortRole, setSortRole, m_sort_role)
+    QUERY_PROP(Qt::SortOrder, sortOrder, setSortOrder, m_sort_order)
+#undef QUERY_PROP
+
+    void classBegin() override;
+    void componentComplete() override;
+
+signals:
+    void sourceModelChanged();
+    void queryChanged();
+
+private slots:
+    void onSourceRowsChanged();
+    void onSourceDataChanged(const QModelIndex&, const QModelIndex&);
+    void onSourceDestroyed();
+
+private:
+    using Bitset = std::vector<quint64>;
+
+    struct IndexRow {
+        QString folded_title;
+        qint64 last_played = 0;
+        int play_count = 0;
+        int release_year = 0;
+        int player_count = 1;
+    };
+
+    ObjectListModel* m_source = nullptr;
+
+    QString m_title_filter;
+    QString m_title_filter_folded;
+    bool m_favorites_only = false;
+    bool m_hide_missing = false;
+    QString m_genre_filter;
+    int m_min_players = 0;
+    int m_min_year = 0;
+    int m_max_year = 0;
+    QDateTime m_played_since;
+    int m_min_play_count = 0;
+    SortRole m_sort_role = SortRole::SourceOrder;
+    Qt::SortOrder m_sort_order = Qt::AscendingOrder;
+
+    bool m_complete = true;
+    bool m_index_valid = false;
+    std::vector<model::Game*> m_source_games;
+    std::vector<IndexRow> m_index_rows;
+    Bitset m_favorite_bits;
+    Bitset m_present_bits;
+    HashMap<QString, Bitset> m_genre_bits;
+    HashMap<int, std::vector<quint32>> m_sort_permutations;
+    QTimer m_requery_timer;
+
+    void rebuildIndex();
+    void refreshIndexRow(size_t idx);
+    const Bitset& genreBits(const QString&);
+    const std::vector<quint32>& sortPermutation(SortRole);
+    bool hasRowFilters() const;
+    bool rowMatches(const IndexRow&) const;
+
+    void onQueryChanged();
+    void requery();
+};
+} // namespace model
@@ -0,0 +1,117 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2022  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "GameSearchIndex.h"
+
+#include "model/gaming/Game.h"
+
+
+namespace {
+constexpr uint8_t TITLE_WEIGHT = 4;
+constexpr uint8_t SORT_TITLE_WEIGHT = 3;
+constexpr uint8_t CREATOR_WEIGHT = 2;
+constexpr uint8_t TAG_WEIGHT = 1;
+
+// the index is rebuilt when the removed games exceed a quarter of the live ones
+constexpr size_t COMPACT_RATIO = 4;
+constexpr size_t COMPACT_MIN_REMOVED = 256;
+} // namespace
+
+
+namespace model {
+GameSearchIndex::GameSearchIndex() = default;
+
+void GameSearchIndex::add(model::Game* game)
+{
+    Q_ASSERT(game);
+    if (m_doc_ids.count(game))
+        return;
+
+    const auto doc = static_cast<SearchIndex::DocId>(m_games.size());
+    m_games.push_back(game);
+    m_doc_ids.emplace(game, doc);
+    add_texts(doc, *game);
+}
+
+void GameSearchIndex::add_texts(SearchIndex::DocId doc, const model::Game& game)
+{
+    m_index.add(doc, game.title(), TITLE_WEIGHT);
+    if (game.sortBy() != game.title())
+        m_index.add(doc, game.sortBy(), SORT_TITLE_WEIGHT);
+    for (const QString& developer : game.developerListConst())
+        m_index.add(doc, developer, CREATOR_WEIGHT);
+    for (const QString& publisher : game.publisherListConst())
+        m_index.add(doc, publisher, CREATOR_WEIGHT);
+    for (const QString& tag : game.tagListConst())
+        m_index.add(doc, tag, TAG_WEIGHT);
+}
+
+void GameSearchIndex::remove(model::Game* game)
+{
+    const auto it = m_doc_ids.find(game);
+    if (it == m_doc_ids.cend())
+        return;
+
+    m_index.remove(it->second);
+    m_games[it->second] = nullptr;
+    m_doc_ids.erase(it);
+
+    // NOTE: The removed games are only skipped during the searches, so with
+    //       the library being updated in place, they are cleaned up from time to time
+    const size_t removed = m_index.removed_count();
+    if (removed >= COMPACT_MIN_REMOVED && removed * COMPACT_RATIO > m_doc_ids.size())
+        compact();
+}
+
+void GameSearchIndex::compact()
+{
+    std::vector<model::Game*> games;
+    games.reserve(m_doc_ids.size());
+    for (model::Game* const game : m_games) {
+        if (game)
+            games.push_back(game);
+    }
+
+    m_index.clear();
+    m_games = std::move(games);
+    for (size_t i = 0; i < m_games.size(); i++) {
+        const auto doc = static_cast<SearchIndex::DocId>(i);
+        m_doc_ids[m_games[i]] = doc;
+        add_texts(doc, *m_games[i]);
+    }
+}
+
+void GameSearchIndex::clear()
+{
+    m_index.clear();
+    m_games.clear();
+    m_doc_ids.clear();
+}
+
+std::vector<model::Game*> GameSearchIndex::search(const QString& query, size_t limit) const
+{
+    const std::vector<SearchIndex::Match> matches = m_index.search(query, limit);
+
+    std::vector<model::Game*> games;
+    games.reserve(matches.size());
+    for (const SearchIndex::Match& match : matches) {
+        Q_ASSERT(m_games[match.doc]);
+        games.push_back(m_games[match.doc]);
+    }
+    return games;
+}
+} // namespace model
@@ -0,0 +1,55 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2022  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+#include "utils/SearchIndex.h"
+
+#include <vector>
+
+namespace model { class Game; }
+
+
+namespace model {
+/// Full text search over the games of the library
+///
+/// Indexes the title, sort title, developers, publishers and tags of the games,
+/// with the titles ranked higher. Games can be added and removed at any time,
+/// without rebuilding the whole index.
+class GameSearchIndex {
+public:
+    explicit GameSearchIndex();
+
+    void add(model::Game*);
+    void remove(model::Game*);
+    void clear();
+
+    size_t size() const { return m_doc_ids.size(); }
+
+    /// Returns the matching games, best matches first (limit 0 means all of them)
+    std::vector<model::Game*> search(const QString& query, size_t limit = 0) const;
+
+private:
+    SearchIndex m_index;
+    std::vector<model::Game*> m_games;
+    HashMap<model::Game*, SearchIndex::DocId> m_doc_ids;
+
+    void add_texts(SearchIndex::DocId, const model::Game&);
+    void compact();
+};
+} // namespace model
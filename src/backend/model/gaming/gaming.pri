@@ -5,7 +5,9 @@ HEADERS += \
     $$PWD/Game.h \
     $$PWD/GameFile.h \
     $$PWD/GameFileListModel.h \
-    $$PWD/GameListModel.h
+    $$PWD/GameListModel.h \
+    $$PWD/GameQueryModel.h \
+    $$PWD/GameSearchIndex.h
 
 SOURCES += \
     $$PWD/Assets.cpp \
@@ -14,4 +16,6 @@ SOURCES += \
     $$PWD/Game.cpp \
     $$PWD/GameFile.cpp \
     $$PWD/GameFileListModel.cpp \
-    $$PWD/GameListModel.cpp
+    $$PWD/GameListModel.cpp \
+    $$PWD/GameQueryModel.cpp \
+    $$PWD/GameSearchIndex.cpp
@@ -18,11 +18,95 @@
 #include "MetaFile.h"
 
 #include "Log.h"
+#include "utils/HashMap.h"
 
 #include <QFile>
 #include <QRegularExpression>
 #include <QStringBuilder>
 #include <QTextStream>
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+// A part of the file's contents; the data is not copied until necessary
+struct ByteView {
+    const char* begin;
+    const char* end;
+
+    bool empty() const { return begin == end; }
+    int size() const { return static_cast<int>(end - begin); }
+    bool starts_with(char ch) const { return !empty() && *begin == ch; }
+};
+
+bool is_ascii_space(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+bool is_ascii(char ch)
+{
+    return (static_cast<unsigned char>(ch) & 0x80) == 0;
+}
+
+// NOTE: only ASCII whitespace is removed here; the rare Unicode whitespace
+//       is trimmed after the text got converted to QString
+ByteView trimmed(ByteView view)
+{
+    while (view.begin < view.end && is_ascii_space(*view.begin))
+        view.begin++;
+    while (view.begin < view.end && is_ascii_space(*(view.end - 1)))
+        view.end--;
+    return view;
+}
+
+bool starts_with_space(const ByteView& view)
+{
+    if (view.empty())
+        return false;
+    if (is_ascii(*view.begin))
+        return is_ascii_space(*view.begin);
+
+    // a multibyte character; UTF-8 sequences are at most 4 bytes long
+    const QString first = QString::fromUtf8(view.begin, std::min(view.size(), 4));
+    return !first.isEmpty() && first.at(0).isSpace();
+}
+
+QString to_trimmed_string(const ByteView& view)
+{
+    QString str = QString::fromUtf8(view.begin, view.size());
+    if (!is_ascii(*view.begin) || !is_ascii(*(view.end - 1)))
+        str = str.trimmed();
+    return str;
+}
+
+const char* find_char(const ByteView& view, char ch)
+{
+    // NOTE: memchr is vectorized in all the supported C libraries
+    const void* const found = std::memchr(view.begin, ch, static_cast<size_t>(view.size()));
+    return found ? static_cast<const char*>(found) : view.end;
+}
+
+
+// Metafiles use a small number of different keys, so instead of creating
+// a new string for every entry, the same (implicitly shared) one is reused
+class KeyCache {
+public:
+    const QString& get(const ByteView& raw_key)
+    {
+        // NOTE: fromRawData doesn't copy, the view is valid during the lookup
+        const auto it = m_keys.find(QByteArray::fromRawData(raw_key.begin, raw_key.size()));
+        if (it != m_keys.cend())
+            return it->second;
+
+        QString key = QString::fromUtf8(raw_key.begin, raw_key.size()).trimmed().toLower();
+        return m_keys.emplace(QByteArray(raw_key.begin, raw_key.size()), std::move(key)).first->second;
+    }
+
+private:
+    HashMap<QByteArray, QString> m_keys;
+};
+} // namespace
 
 
 namespace metafile {
@@ -35,31 +119,138 @@ void Entry::reset()
 }
 
 
-/// Opens the file at the path, then calls the stream reading on it.
+/// Opens the file at the path, then calls the buffer reading on its contents.
 /// Returns false if the file could not be opened.
 bool read_file(const QString& path,
                const std::function<void(const Entry&)>& onAttributeFound,
                const std::function<void(const Error&)>& onError)
 {
     QFile file(path);
-    if (!file.open(QFile::ReadOnly | QFile::Text))
+    if (!file.open(QFile::ReadOnly))
         return false;
 
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-    read_stream(stream, onAttributeFound, onError);
+    read_file(file, onAttributeFound, onError);
     return true;
 }
 
-/// Calls the stream reading on an already open, readable text file.
+/// Calls the buffer reading on the contents of an already open, readable file.
+/// The file is memory mapped if possible.
 void read_file(QFile& file,
                const std::function<void(const Entry&)>& onAttributeFound,
                const std::function<void(const Error&)>& onError)
 {
     Q_ASSERT(file.isOpen() && file.isReadable());
-    QTextStream stream(&file);
-    stream.setCodec("UTF-8");
-    return read_stream(stream, onAttributeFound, onError);
+
+    const qint64 size = file.size();
+    uchar* const mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (mapped) {
+        read_buffer(reinterpret_cast<const char*>(mapped), static_cast<size_t>(size), onAttributeFound, onError);
+        file.unmap(mapped);
+        return;
+    }
+
+    // NOTE: not everything can be mapped, eg. compressed resources or pipes
+    const QByteArray contents = file.readAll();
+    read_buffer(contents.constData(), static_cast<size_t>(contents.size()), onAttributeFound, onError);
+}
+
+/// Parse UTF-8 text directly, calling the callbacks when necessary.
+/// Produces the same results as the stream reading, without decoding
+/// the whole text first.
+void read_buffer(const char* data, size_t size,
+                 const std::function<void(const Entry&)>& onAttributeFound,
+                 const std::function<void(const Error&)>& onError)
+{
+    constexpr char CH_COMMENT = '#';
+    constexpr char CH_COLON = ':';
+    constexpr char CH_NEWLINE = '\n';
+    constexpr char CH_EMPTY_LINE_MARK = '.';
+
+    KeyCache key_cache;
+    Entry entry {0, {}, {}};
+    ByteView entry_key {nullptr, nullptr};
+
+    // NOTE: the key is only converted if the entry is valid
+    const auto close_current_attrib = [&](){
+        if (!entry_key.empty()) {
+            if (entry.values.empty()) {
+                onError({ entry.line, LOGMSG("attribute value missing, entry ignored") });
+            }
+            else {
+                entry.key = key_cache.get(entry_key);
+                onAttributeFound(entry);
+            }
+        }
+
+        entry.reset();
+        entry_key = {nullptr, nullptr};
+    };
+
+    ByteView remaining {data, data + size};
+
+    // UTF-8 byte order mark
+    if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0)
+        remaining.begin += 3;
+
+    size_t linenum = 0;
+    while (!remaining.empty()) {
+        const char* const line_end = find_char(remaining, CH_NEWLINE);
+        ByteView line {remaining.begin, line_end};
+        remaining.begin = line_end == remaining.end ? line_end : line_end + 1;
+
+        if (line.end > line.begin && *(line.end - 1) == '\r')
+            line.end--;
+
+        linenum++;
+
+        if (line.starts_with(CH_COMMENT))
+            continue;
+
+        const ByteView trimmed_line = trimmed(line);
+        if (trimmed_line.empty()) {
+            close_current_attrib();
+            continue;
+        }
+
+        // multiline (starts with whitespace but also has content)
+        if (starts_with_space(line)) {
+            if (entry_key.empty()) {
+                onError({ linenum, LOGMSG("line starts with whitespace, but no attribute has been defined yet") });
+                continue;
+            }
+
+            if (trimmed_line.size() == 1 && *trimmed_line.begin == CH_EMPTY_LINE_MARK) {
+                entry.values.emplace_back(QString());
+                continue;
+            }
+
+            entry.values.emplace_back(to_trimmed_string(trimmed_line));
+            continue;
+        }
+
+        // either a new entry or error - in both cases, the previous entry should be closed
+        close_current_attrib();
+
+        // keyval pair (after the multiline check)
+        const char* const key_end = find_char(trimmed_line, CH_COLON);
+        if (key_end != trimmed_line.end && key_end != trimmed_line.begin) {
+            entry_key = trimmed({trimmed_line.begin, key_end});
+
+            // the value can be empty here, if it's purely multiline
+            const ByteView value_part = trimmed({key_end + 1, trimmed_line.end});
+            if (!value_part.empty())
+                entry.values.emplace_back(to_trimmed_string(value_part));
+
+            entry.line = linenum;
+            continue;
+        }
+
+        // invalid line
+        onError({ linenum, LOGMSG("line invalid, skipped") });
+    }
+
+    // the very last line
+    close_current_attrib();
 }
 
 /// Read and parse the stream, calling the callbacks when necessary.
@@ -45,6 +45,10 @@ struct Error {
 };
 
 
+void read_buffer(const char* data, size_t size,
+                 const std::function<void(const Entry&)>& onAttributeFound,
+                 const std::function<void(const Error&)>& onError);
+
 void read_stream(QTextStream& stream,
                  const std::function<void(const Entry&)>& onAttributeFound,
                  const std::function<void(const Error&)>& onError);
@@ -70,6 +70,8 @@ ConfigEntryMaps::ConfigEntryMaps()
         { QStringLiteral("input-mouse-support"), GeneralOption::MOUSE_SUPPORT },
         { QStringLiteral("verify-files"), GeneralOption::VERIFY_FILES },
         { QStringLiteral("show-missing-games"), GeneralOption::SHOW_MISSING_GAMES },
+        { QStringLiteral("parallel-scan"), GeneralOption::PARALLEL_SCAN },
+        { QStringLiteral("watch-game-dirs"), GeneralOption::WATCH_GAME_DIRS },
         { QStringLiteral("locale"), GeneralOption::LOCALE },
         { QStringLiteral("theme"), GeneralOption::THEME },
     }
@@ -180,6 +182,14 @@ void LoadContext::handle_general_attrib(const size_t lineno, const QString& key,
             if (!store_bool_maybe(val, AppSettings::general.show_missing_games))
                 log_needs_bool(lineno, key);
             break;
+        case ConfigEntryGeneralOption::PARALLEL_SCAN:
+            if (!store_bool_maybe(val, AppSettings::general.parallel_scan))
+                log_needs_bool(lineno, key);
+            break;
+        case ConfigEntryGeneralOption::WATCH_GAME_DIRS:
+            if (!store_bool_maybe(val, AppSettings::general.watch_game_dirs))
+                log_needs_bool(lineno, key);
+            break;
         case ConfigEntryGeneralOption::LOCALE:
             AppSettings::general.locale = val;
             break;
@@ -313,6 +323,8 @@ void SaveContext::print_general(QTextStream& stream) const
         { GeneralOption::MOUSE_SUPPORT, AppSettings::general.mouse_support ? STR_TRUE : STR_FALSE },
         { GeneralOption::VERIFY_FILES, AppSettings::general.verify_files ? STR_TRUE : STR_FALSE },
         { GeneralOption::SHOW_MISSING_GAMES, AppSettings::general.show_missing_games ? STR_TRUE : STR_FALSE },
+        { GeneralOption::PARALLEL_SCAN, AppSettings::general.parallel_scan ? STR_TRUE : STR_FALSE },
+        { GeneralOption::WATCH_GAME_DIRS, AppSettings::general.watch_game_dirs ? STR_TRUE : STR_FALSE },
         { GeneralOption::LOCALE, AppSettings::general.locale },
         { GeneralOption::THEME, theme_path },
     };
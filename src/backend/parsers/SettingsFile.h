@@ -39,6 +39,8 @@ enum class ConfigEntryGeneralOption : unsigned char {
     MOUSE_SUPPORT,
     VERIFY_FILES,
     SHOW_MISSING_GAMES,
+    PARALLEL_SCAN,
+    WATCH_GAME_DIRS,
     LOCALE,
     THEME,
 };
@@ -0,0 +1,556 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "LibrarySnapshot.h"
+
+#include "Log.h"
+#include "Paths.h"
+#include "model/gaming/Assets.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "utils/HashMap.h"
+#include "utils/StringPool.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStringBuilder>
+#include <algorithm>
+
+
+namespace {
+constexpr quint32 SNAPSHOT_MAGIC = 0x50474C53; // 'PGLS'
+constexpr quint32 SNAPSHOT_VERSION = 3;
+constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+
+constexpr auto FIRST_ASSET_TYPE = static_cast<unsigned char>(AssetType::BOX_FRONT);
+constexpr auto LAST_ASSET_TYPE = static_cast<unsigned char>(AssetType::VIDEO);
+
+
+using StoredAssetLists = std::vector<std::vector<model::StoredAsset>>;
+
+StoredAssetLists stored_assets(const model::AssetLists& assets)
+{
+    StoredAssetLists lists;
+    lists.reserve(LAST_ASSET_TYPE - FIRST_ASSET_TYPE + 1);
+    for (unsigned char i = FIRST_ASSET_TYPE; i <= LAST_ASSET_TYPE; i++)
+        lists.emplace_back(assets.stored(static_cast<AssetType>(i)));
+    return lists;
+}
+
+// NOTE: the assets are saved in their stored form,
+//       so the local files don't have to be turned into URLs here
+void write_assets(QDataStream& out, const StoredAssetLists& lists)
+{
+    for (const std::vector<model::StoredAsset>& list : lists) {
+        out << static_cast<quint32>(list.size());
+        for (const model::StoredAsset& asset : list)
+            out << asset.is_file << asset.value;
+    }
+}
+
+void write_assets(QDataStream& out, const model::AssetLists& assets)
+{
+    write_assets(out, stored_assets(assets));
+}
+
+void read_assets(QDataStream& in, model::AssetLists& assets)
+{
+    QString value;
+    bool is_file = false;
+    for (unsigned char i = FIRST_ASSET_TYPE; i <= LAST_ASSET_TYPE; i++) {
+        const auto type = static_cast<AssetType>(i);
+
+        quint32 count = 0;
+        in >> count;
+        for (quint32 k = 0; k < count && in.status() == QDataStream::Ok; k++) {
+            in >> is_file >> value;
+            if (is_file)
+                assets.add_file(type, std::move(value));
+            else
+                assets.add_uri(type, std::move(value));
+        }
+    }
+}
+
+
+void write_collection(QDataStream& out, const model::Collection& coll)
+{
+    out << coll.name()
+        << coll.sortBy()
+        << coll.shortName()
+        << coll.summary()
+        << coll.description()
+        << coll.commonLaunchCmd()
+        << coll.commonLaunchWorkdir()
+        << coll.commonLaunchCmdBasedir()
+        << coll.extraMap();
+    write_assets(out, coll.assets());
+}
+
+model::Collection* read_collection(QDataStream& in)
+{
+    QString name;
+    in >> name;
+    if (in.status() != QDataStream::Ok || name.isEmpty())
+        return nullptr;
+
+    QString sort_by, short_name, summary, description, launch_cmd, launch_workdir, launch_basedir;
+    in >> sort_by >> short_name >> summary >> description >> launch_cmd >> launch_workdir >> launch_basedir;
+
+    auto coll = new model::Collection(std::move(name));
+    coll->setSortBy(std::move(sort_by))
+        .setSummary(std::move(summary))
+        .setDescription(std::move(description))
+        .setCommonLaunchCmd(std::move(launch_cmd))
+        .setCommonLaunchWorkdir(std::move(launch_workdir))
+        .setCommonLaunchCmdBasedir(std::move(launch_basedir));
+    if (!short_name.isEmpty())
+        coll->setShortName(std::move(short_name));
+
+    in >> coll->extraMapMut();
+    read_assets(in, coll->assetsMut());
+    return coll;
+}
+
+
+// NOTE: everything except the assets, the collections and the user state (favorite, play stats)
+void write_game_data(QDataStream& out, const model::Game& game)
+{
+    out << game.title()
+        << game.sortBy()
+        << game.summary()
+        << game.description()
+        << game.developerListConst()
+        << game.publisherListConst()
+        << game.genreListConst()
+        << game.tagListConst()
+        << static_cast<qint16>(game.playerCount())
+        << game.rating()
+        << game.releaseDate()
+        << game.isMissing()
+        << game.launchCmd()
+        << game.launchWorkdir()
+        << game.launchCmdBasedir()
+        << game.extraMap();
+
+    const std::vector<model::GameFile*>& files = game.files();
+    out << static_cast<quint32>(files.size());
+    for (const model::GameFile* const gamefile : files)
+        out << gamefile->path() << gamefile->name();
+}
+
+model::Game* read_game(QDataStream& in, StringPool& string_pool, std::vector<quint32>& coll_ids)
+{
+    QString title, sort_by, summary, description;
+    QStringList developers, publishers, genres, tags;
+    qint16 player_count = 1;
+    float rating = 0.f;
+    QDate release_date;
+    bool is_missing = false;
+    QString launch_cmd, launch_workdir, launch_basedir;
+
+    in >> title >> sort_by >> summary >> description
+       >> developers >> publishers >> genres >> tags
+       >> player_count >> rating >> release_date
+       >> is_missing
+       >> launch_cmd >> launch_workdir >> launch_basedir;
+    if (in.status() != QDataStream::Ok)
+        return nullptr;
+
+    auto game = new model::Game(std::move(title));
+    game->setSortBy(std::move(sort_by))
+        .setSummary(std::move(summary))
+        .setDescription(std::move(description))
+        .setReleaseDate(std::move(release_date))
+        .setPlayerCount(player_count)
+        .setRating(rating)
+        .setMissing(is_missing)
+        .setLaunchCmd(std::move(launch_cmd))
+        .setLaunchWorkdir(std::move(launch_workdir))
+        .setLaunchCmdBasedir(std::move(launch_basedir));
+    game->developerList() = std::move(developers);
+    game->publisherList() = std::move(publishers);
+    game->genreList() = std::move(genres);
+    game->tagList() = std::move(tags);
+    string_pool.intern_list(game->developerList());
+    string_pool.intern_list(game->publisherList());
+    string_pool.intern_list(game->genreList());
+    string_pool.intern_list(game->tagList());
+
+    in >> game->extraMapMut();
+
+    quint32 file_count = 0;
+    in >> file_count;
+
+    std::vector<model::GameFile*> files;
+    for (quint32 i = 0; i < file_count && in.status() == QDataStream::Ok; i++) {
+        QString path, name;
+        in >> path >> name;
+
+        auto gamefile = new model::GameFile(std::move(path), *game);
+        gamefile->setName(std::move(name));
+        files.emplace_back(gamefile);
+    }
+
+    read_assets(in, game->assetsMut());
+
+    bool is_favorite = false;
+    in >> is_favorite;
+    game->setFavorite(is_favorite);
+
+    for (model::GameFile* const gamefile : files) {
+        qint32 play_count = 0;
+        qint64 play_time = 0;
+        QDateTime last_played;
+        in >> play_count >> play_time >> last_played;
+        gamefile->update_playstats(play_count, play_time, std::move(last_played));
+    }
+    game->setFiles(std::move(files));
+
+    quint32 coll_count = 0;
+    in >> coll_count;
+
+    coll_ids.clear();
+    for (quint32 i = 0; i < coll_count && in.status() == QDataStream::Ok; i++) {
+        quint32 coll_id = 0;
+        in >> coll_id;
+        coll_ids.emplace_back(coll_id);
+    }
+
+    return game;
+}
+
+
+QByteArray record_digest(const char* const data, const qint64 len)
+{
+    return QCryptographicHash::hash(QByteArray::fromRawData(data, static_cast<int>(len)),
+                                    QCryptographicHash::Sha1);
+}
+
+// NOTE: The game order depends on hash map iteration during the search,
+//       so the checksum is independent of the order of the records
+QByteArray combined_digest(std::vector<QByteArray>& coll_digests, std::vector<QByteArray>& game_digests)
+{
+    std::sort(coll_digests.begin(), coll_digests.end());
+    std::sort(game_digests.begin(), game_digests.end());
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QByteArray& digest : coll_digests)
+        hash.addData(digest);
+    hash.addData("\0", 1);
+    for (const QByteArray& digest : game_digests)
+        hash.addData(digest);
+    return hash.result();
+}
+
+void delete_all(providers::snapshot::Snapshot& snapshot)
+{
+    qDeleteAll(snapshot.games);
+    qDeleteAll(snapshot.collections);
+    snapshot.games.clear();
+    snapshot.collections.clear();
+    snapshot.checksum.clear();
+}
+} // namespace
+
+
+namespace providers {
+namespace snapshot {
+
+QByteArray collection_digest(const model::Collection& coll)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+    write_collection(out, coll);
+    return record_digest(record.constData(), record.size());
+}
+
+QByteArray game_digest(const model::Game& game)
+{
+    QByteArray record;
+    QDataStream out(&record, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+    write_game_data(out, game);
+    write_assets(out, game.assets());
+
+    const std::vector<model::Collection*>& colls = game.collections();
+    out << static_cast<quint32>(colls.size());
+    for (const model::Collection* const coll : colls)
+        out << coll->name();
+
+    return record_digest(record.constData(), record.size());
+}
+
+QString default_path()
+{
+    return paths::writableCacheDir() % QLatin1String("/library.snapshot");
+}
+
+LibraryCopy::LibraryCopy(const std::vector<model::Collection*>& collections,
+                         const std::vector<model::Game*>& games)
+{
+    HashMap<const model::Collection*, quint32> coll_ids;
+    m_collections.reserve(collections.size());
+    for (const model::Collection* const coll : collections) {
+        coll_ids.emplace(coll, static_cast<quint32>(coll_ids.size()));
+
+        QByteArray record;
+        QDataStream out(&record, QIODevice::WriteOnly);
+        out.setVersion(STREAM_VERSION);
+        write_collection(out, *coll);
+        m_collections.emplace_back(std::move(record));
+    }
+
+    m_games.reserve(games.size());
+    m_game_idx.reserve(games.size());
+    for (const model::Game* const game : games) {
+        GameRecord entry;
+        QDataStream out(&entry.data, QIODevice::WriteOnly);
+        out.setVersion(STREAM_VERSION);
+        write_game_data(out, *game);
+
+        entry.assets = stored_assets(game->assets());
+        entry.is_favorite = game->isFavorite();
+
+        const std::vector<model::GameFile*>& files = game->files();
+        entry.files.reserve(files.size());
+        for (const model::GameFile* const gamefile : files) {
+            m_file_idx.emplace(gamefile, std::make_pair(m_games.size(), entry.files.size()));
+            entry.files.push_back({ gamefile->playCount(), gamefile->playTime(), gamefile->lastPlayed() });
+        }
+
+        const std::vector<model::Collection*>& colls = game->collections();
+        entry.coll_ids.reserve(colls.size());
+        for (const model::Collection* const coll : colls)
+            entry.coll_ids.emplace_back(coll_ids.at(coll));
+
+        m_game_idx.emplace(game, m_games.size());
+        m_games.emplace_back(std::move(entry));
+    }
+}
+
+// NOTE: the changes below follow the ones done to the real objects,
+//       see AssetLists::add_file() and GameFile::add_playstats()
+void LibraryCopy::add_asset_file(const model::Game& game, AssetType type, const QString& path)
+{
+    const auto it = m_game_idx.find(&game);
+    if (it == m_game_idx.cend() || path.isEmpty())
+        return;
+
+    std::vector<model::StoredAsset>& list = m_games[it->second].assets[static_cast<unsigned char>(type) - FIRST_ASSET_TYPE];
+    const bool exists = std::any_of(list.cbegin(), list.cend(),
+        [&path](const model::StoredAsset& asset){ return asset.is_file && asset.value == path; });
+    if (!exists)
+        list.push_back({ path, true });
+}
+
+void LibraryCopy::set_favorite(const model::Game& game, bool favorite)
+{
+    const auto it = m_game_idx.find(&game);
+    if (it != m_game_idx.cend())
+        m_games[it->second].is_favorite = favorite;
+}
+
+void LibraryCopy::add_play_sessions(const std::vector<model::PlaySession>& sessions)
+{
+    for (const model::PlaySession& session : sessions) {
+        const auto it = m_file_idx.find(session.gamefile);
+        if (it == m_file_idx.cend())
+            continue;
+
+        FileStats& stats = m_games[it->second.first].files[it->second.second];
+        stats.play_count += session.play_count;
+        stats.play_time += session.play_time;
+        stats.last_played = std::max(stats.last_played, session.last_played);
+    }
+}
+
+Payload LibraryCopy::serialize() const
+{
+    Payload payload;
+    QDataStream out(&payload.data, QIODevice::WriteOnly);
+    out.setVersion(STREAM_VERSION);
+
+    std::vector<QByteArray> coll_digests;
+    coll_digests.reserve(m_collections.size());
+    std::vector<QByteArray> game_digests;
+    game_digests.reserve(m_games.size());
+
+    out << static_cast<quint32>(m_collections.size());
+    for (const QByteArray& record : m_collections) {
+        out.writeRawData(record.constData(), record.size());
+        coll_digests.emplace_back(record_digest(record.constData(), record.size()));
+    }
+
+    out << static_cast<quint32>(m_games.size());
+    for (const GameRecord& entry : m_games) {
+        const int record_start = payload.data.size();
+        out.writeRawData(entry.data.constData(), entry.data.size());
+        write_assets(out, entry.assets);
+
+        out << entry.is_favorite;
+        for (const FileStats& stats : entry.files)
+            out << static_cast<qint32>(stats.play_count) << stats.play_time << stats.last_played;
+
+        out << static_cast<quint32>(entry.coll_ids.size());
+        for (const quint32 coll_id : entry.coll_ids)
+            out << coll_id;
+
+        game_digests.emplace_back(record_digest(payload.data.constData() + record_start, payload.data.size() - record_start));
+    }
+
+    payload.checksum = combined_digest(coll_digests, game_digests);
+    return payload;
+}
+
+Payload serialize(const std::vector<model::Collection*>& collections,
+                  const std::vector<model::Game*>& games)
+{
+    return LibraryCopy(collections, games).serialize();
+}
+
+bool write_file(const QString& path, const Payload& payload)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        Log::warning(LOGMSG("Could not create the library snapshot file `%1`").arg(path));
+        return false;
+    }
+
+    QDataStream header(&file);
+    header.setVersion(STREAM_VERSION);
+    header << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << payload.checksum;
+    header.writeRawData(payload.data.constData(), payload.data.size());
+
+    if (header.status() != QDataStream::Ok || !file.commit()) {
+        Log::warning(LOGMSG("Writing the library snapshot file `%1` failed").arg(path));
+        return false;
+    }
+    return true;
+}
+
+QByteArray write(const QString& path,
+                 const std::vector<model::Collection*>& collections,
+                 const std::vector<model::Game*>& games)
+{
+    const Payload payload = serialize(collections, games);
+    write_file(path, payload);
+    return payload.checksum;
+}
+
+bool read(const QString& path, Snapshot& snapshot)
+{
+    Q_ASSERT(snapshot.collections.empty());
+    Q_ASSERT(snapshot.games.empty());
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    // NOTE: the file is mapped, so only the parts actually read are loaded from the disk
+    QByteArray raw_data;
+    const qint64 file_size = file.size();
+    const uchar* const mapped = file.map(0, file_size);
+    if (mapped)
+        raw_data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), static_cast<int>(file_size));
+    else
+        raw_data = file.readAll();
+
+    QDataStream in(raw_data);
+    in.setVersion(STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray stored_checksum;
+    in >> magic >> version;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION)
+        return false;
+    in >> stored_checksum;
+
+    std::vector<QByteArray> coll_digests;
+    std::vector<QByteArray> game_digests;
+
+    quint32 coll_count = 0;
+    in >> coll_count;
+    for (quint32 i = 0; i < coll_count && in.status() == QDataStream::Ok; i++) {
+        const qint64 record_start = in.device()->pos();
+        model::Collection* const coll = read_collection(in);
+        if (!coll)
+            break;
+
+        snapshot.collections.emplace_back(coll);
+        coll_digests.emplace_back(record_digest(raw_data.constData() + record_start, in.device()->pos() - record_start));
+    }
+
+    quint32 game_count = 0;
+    in >> game_count;
+
+    std::vector<std::vector<model::Game*>> coll_games(snapshot.collections.size());
+    std::vector<quint32> game_coll_ids;
+    StringPool string_pool;
+    for (quint32 i = 0; i < game_count && in.status() == QDataStream::Ok; i++) {
+        const qint64 record_start = in.device()->pos();
+        model::Game* const game = read_game(in, string_pool, game_coll_ids);
+        if (!game)
+            break;
+
+        snapshot.games.emplace_back(game);
+        game_digests.emplace_back(record_digest(raw_data.constData() + record_start, in.device()->pos() - record_start));
+
+        std::vector<model::Collection*> game_colls;
+        game_colls.reserve(game_coll_ids.size());
+        for (const quint32 coll_id : game_coll_ids) {
+            if (coll_id >= coll_games.size()) {
+                in.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+            game_colls.emplace_back(snapshot.collections[coll_id]);
+            coll_games[coll_id].emplace_back(game);
+        }
+        game->setCollections(std::move(game_colls));
+    }
+
+    const bool valid = in.status() == QDataStream::Ok
+        && in.atEnd()
+        && snapshot.collections.size() == coll_count
+        && snapshot.games.size() == game_count
+        && combined_digest(coll_digests, game_digests) == stored_checksum;
+    if (!valid) {
+        Log::warning(LOGMSG("The library snapshot file `%1` is invalid, ignored").arg(path));
+        delete_all(snapshot);
+        return false;
+    }
+
+    for (size_t i = 0; i < snapshot.collections.size(); i++)
+        snapshot.collections[i]->setGames(std::move(coll_games[i]));
+
+    for (model::Game* const game : snapshot.games)
+        snapshot.search_index.add(game);
+
+    snapshot.checksum = std::move(stored_checksum);
+    return true;
+}
+
+} // namespace snapshot
+} // namespace providers
@@ -0,0 +1,119 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "model/gaming/Assets.h"
+#include "model/gaming/GameSearchIndex.h"
+#include "utils/HashMap.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <utility>
+#include <vector>
+
+namespace model { class Collection; }
+namespace model { class Game; }
+namespace model { class GameFile; }
+namespace model { struct PlaySession; }
+
+
+/// A binary copy of the result of the last game search
+///
+/// Makes it possible to show the game library right after startup,
+/// while the real search runs in the background. The checksum can be used
+/// to tell whether the search found anything different than the snapshot.
+namespace providers {
+namespace snapshot {
+
+struct Snapshot {
+    std::vector<model::Collection*> collections;
+    std::vector<model::Game*> games;
+    model::GameSearchIndex search_index;
+    QByteArray checksum;
+};
+
+struct Payload {
+    QByteArray data;
+    QByteArray checksum;
+};
+
+QString default_path();
+
+/// A plain copy of the data of the collections and games
+///
+/// Taken while the objects are only used by the search; the changes the search
+/// makes after publishing the games are recorded in it too, so the snapshot can be
+/// serialized on any thread, without reading the objects used by the frontend.
+class LibraryCopy {
+public:
+    explicit LibraryCopy(const std::vector<model::Collection*>&,
+                         const std::vector<model::Game*>&);
+
+    void add_asset_file(const model::Game&, AssetType, const QString& path);
+    void set_favorite(const model::Game&, bool);
+    void add_play_sessions(const std::vector<model::PlaySession>&);
+
+    Payload serialize() const;
+
+private:
+    struct FileStats {
+        int play_count;
+        qint64 play_time;
+        QDateTime last_played;
+    };
+    struct GameRecord {
+        QByteArray data; // everything except the assets and the user state
+        std::vector<std::vector<model::StoredAsset>> assets;
+        bool is_favorite;
+        std::vector<FileStats> files;
+        std::vector<quint32> coll_ids;
+    };
+
+    std::vector<QByteArray> m_collections;
+    std::vector<GameRecord> m_games;
+    HashMap<const model::Game*, size_t> m_game_idx;
+    HashMap<const model::GameFile*, std::pair<size_t, size_t>> m_file_idx;
+};
+
+/// Serializes the collections and games; reads the objects, so it should run
+/// on their thread if they might be in use
+Payload serialize(const std::vector<model::Collection*>&,
+                  const std::vector<model::Game*>&);
+/// Writes the serialized data to the file, can run on any thread
+bool write_file(const QString& path, const Payload&);
+
+/// Writes the collections and games to the file, returns the checksum of the contents
+QByteArray write(const QString& path,
+                 const std::vector<model::Collection*>&,
+                 const std::vector<model::Game*>&);
+
+/// Recreates the objects stored in the file; returns false if the file
+/// is missing, outdated or invalid. All objects are created at once, so this
+/// still takes time proportional to the size of the library, but it needs no
+/// directory reads or metadata parsing.
+bool read(const QString& path, Snapshot&);
+
+/// Returns a hash of the data of the collection, excluding its games
+QByteArray collection_digest(const model::Collection&);
+/// Returns a hash of the data of the game, including the names of its collections,
+/// but excluding the state changed by the user (favorite, play stats)
+QByteArray game_digest(const model::Game&);
+
+} // namespace snapshot
+} // namespace providers
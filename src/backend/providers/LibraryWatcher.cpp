@@ -0,0 +1,142 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "LibraryWatcher.h"
+
+#include "Log.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+
+
+namespace {
+constexpr int SETTLE_DELAY_MS = 1000;
+constexpr int MAX_SETTLE_DELAY_MS = 10000;
+constexpr int POLL_INTERVAL_MS = 15000;
+
+qint64 mtime_of(const QString& path)
+{
+    const QDateTime mtime = QFileInfo(path).lastModified();
+    return mtime.isValid() ? mtime.toMSecsSinceEpoch() : -1;
+}
+} // namespace
+
+
+LibraryWatcher::LibraryWatcher(QObject* parent)
+    : QObject(parent)
+{
+    m_settle_timer.setSingleShot(true);
+    m_settle_timer.setInterval(SETTLE_DELAY_MS);
+    connect(&m_settle_timer, &QTimer::timeout,
+            this, &LibraryWatcher::onSettled);
+
+    m_poll_timer.setInterval(POLL_INTERVAL_MS);
+    connect(&m_poll_timer, &QTimer::timeout,
+            this, &LibraryWatcher::onPollTimeout);
+}
+
+void LibraryWatcher::stop()
+{
+    unwatch();
+
+    m_settle_timer.stop();
+    m_pending_timer.invalidate();
+    m_changed_paths.clear();
+}
+
+void LibraryWatcher::unwatch()
+{
+    // NOTE: recreating the watcher is much faster than removing the paths one by one
+    delete m_watcher;
+    m_watcher = nullptr;
+
+    m_poll_timer.stop();
+    m_polled_paths.clear();
+    m_watched_dirs.clear();
+}
+
+void LibraryWatcher::watch(const QStringList& dirs, const QStringList& files)
+{
+    // NOTE: the changes not yet taken or reported are kept, see the header
+    unwatch();
+
+    const QStringList all_paths = dirs + files;
+    if (all_paths.isEmpty())
+        return;
+
+    m_watched_dirs = dirs;
+
+    m_watcher = new QFileSystemWatcher(this);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &LibraryWatcher::onPathChanged);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &LibraryWatcher::onPathChanged);
+
+    const QStringList unwatched_paths = m_watcher->addPaths(all_paths);
+    for (const QString& path : unwatched_paths)
+        m_polled_paths.emplace(path, mtime_of(path));
+
+    if (!m_polled_paths.empty())
+        m_poll_timer.start();
+
+    Log::info(LOGMSG("Watching %1 paths for changes, %2 of them by polling")
+        .arg(QString::number(all_paths.size()), QString::number(m_polled_paths.size())));
+}
+
+QStringList LibraryWatcher::take_unchanged_dirs()
+{
+    QStringList out;
+    out.reserve(m_watched_dirs.size());
+    for (const QString& path : qAsConst(m_watched_dirs)) {
+        if (!m_changed_paths.contains(path))
+            out.append(path);
+    }
+
+    m_changed_paths.clear();
+    return out;
+}
+
+void LibraryWatcher::onPathChanged(const QString& path)
+{
+    m_changed_paths.insert(path);
+
+    // NOTE: a steady stream of changes (eg. copying many files) would keep
+    //       postponing the report, so the delay is limited
+    if (!m_pending_timer.isValid())
+        m_pending_timer.start();
+
+    const qint64 remaining_ms = MAX_SETTLE_DELAY_MS - m_pending_timer.elapsed();
+    m_settle_timer.start(static_cast<int>(qBound<qint64>(0, remaining_ms, SETTLE_DELAY_MS)));
+}
+
+void LibraryWatcher::onSettled()
+{
+    m_pending_timer.invalidate();
+    emit libraryChanged();
+}
+
+void LibraryWatcher::onPollTimeout()
+{
+    for (auto& pair : m_polled_paths) {
+        const qint64 mtime = mtime_of(pair.first);
+        if (mtime != pair.second) {
+            pair.second = mtime;
+            onPathChanged(pair.first);
+        }
+    }
+}
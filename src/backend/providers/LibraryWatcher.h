@@ -0,0 +1,72 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class QFileSystemWatcher;
+
+
+/// Watches the game directories and metafiles, and reports when they change
+///
+/// Uses the native file system notifications (inotify on Linux). Paths that
+/// could not be registered (eg. because the inotify watch limit was reached,
+/// or on network shares without notification support) are polled by their
+/// modification time instead. Changes are reported once things calm down,
+/// or at most a few seconds after the first one (eg. during a long copy).
+///
+/// The changed paths are remembered until they are taken, even if the paths
+/// are watched again meanwhile, so the changes made during a rescan are not lost.
+class LibraryWatcher : public QObject {
+    Q_OBJECT
+
+public:
+    explicit LibraryWatcher(QObject* parent = nullptr);
+
+    void watch(const QStringList& dirs, const QStringList& files);
+    void stop();
+
+    /// Returns the watched directories that have not changed since they were
+    /// watched or since the last call, and forgets the changes
+    QStringList take_unchanged_dirs();
+
+signals:
+    void libraryChanged();
+
+private slots:
+    void onPathChanged(const QString&);
+    void onSettled();
+    void onPollTimeout();
+
+private:
+    QFileSystemWatcher* m_watcher = nullptr;
+    QTimer m_settle_timer;
+    QTimer m_poll_timer;
+    QElapsedTimer m_pending_timer;
+    HashMap<QString, qint64> m_polled_paths;
+    QStringList m_watched_dirs;
+    QSet<QString> m_changed_paths;
+
+    void unwatch();
+};
@@ -35,6 +35,8 @@ namespace providers {
 constexpr uint8_t PROVIDER_FLAG_NONE = 0;
 constexpr uint8_t PROVIDER_FLAG_INTERNAL = (1 << 0);
 constexpr uint8_t PROVIDER_FLAG_HIDE_PROGRESS = (1 << 1);
+// Never creates games, only adds data to the ones found by other providers
+constexpr uint8_t PROVIDER_FLAG_NO_NEW_GAMES = (1 << 2);
 
 
 class Provider : public QObject {
@@ -54,6 +56,9 @@ public:
     virtual void onGameFavoriteChanged(const std::vector<model::Game*>&) {}
     virtual void onGameLaunched(model::GameFile* const) {}
     virtual void onGameFinished(model::GameFile* const) {}
+    // a library scan runs between these two, and may miss the data saved meanwhile
+    virtual void onScanStarted() {}
+    virtual void onScanFinished() {}
 
     // common
     const QLatin1String& codename() const { return m_codename; }
@@ -19,11 +19,21 @@
 #include "ProviderManager.h"
 
 #include "AppSettings.h"
+#include "LibrarySnapshot.h"
 #include "Log.h"
+#include "Paths.h"
 #include "Provider.h"
 #include "SearchContext.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "utils/DirIndex.h"
 
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
 #include <QtConcurrent/QtConcurrent>
+#include <atomic>
+#include <memory>
 
 using ProviderPtr = providers::Provider*;
 
@@ -38,6 +48,35 @@ std::vector<ProviderPtr> enabled_providers()
     }
     return out;
 }
+
+QString dir_index_path()
+{
+    return paths::writableConfigDir() + QStringLiteral("/dir_index.dat");
+}
+
+// The media provider used to keep its own cache, which got replaced by the directory index
+void remove_old_media_cache()
+{
+    const QString path = paths::writableConfigDir() + QStringLiteral("/media_cache.json");
+    if (QFileInfo::exists(path) && !QFile::remove(path))
+        Log::warning(LOGMSG("Could not remove the old media cache `%1`").arg(path));
+}
+
+bool has_progress(const providers::Provider& provider)
+{
+    return !(provider.flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS);
+}
+
+void run_timed(providers::Provider& provider, providers::SearchContext& sctx)
+{
+    QElapsedTimer provider_timer;
+    provider_timer.start();
+
+    provider.run(sctx);
+
+    Log::info(provider.display_name(), LOGMSG("Finished searching in %1ms")
+        .arg(QString::number(provider_timer.restart())));
+}
 } // namespace
 
 
@@ -48,30 +87,57 @@ ProviderManager::ProviderManager(QObject* parent)
         connect(provider.get(), &providers::Provider::progressChanged,
                 this, &ProviderManager::onProviderProgressChanged);
     }
+
+    // NOTE: the watcher reports in the thread of the manager,
+    //       after the background task has fully completed
+    connect(&m_future_watcher, &QFutureWatcher<void>::finished,
+            this, &ProviderManager::onScanTaskFinished);
 }
 
-void ProviderManager::run()
+void ProviderManager::run(const QStringList& unchanged_dirs)
 {
     Q_ASSERT(!m_future.isRunning());
 
     m_found_games.clear();
     m_found_collections.clear();
+    m_found_search_index.clear();
+    m_found_checksum.clear();
+    m_found_watch_dirs.clear();
+    m_found_watch_files.clear();
+
+    for (const auto& provider : AppSettings::providers())
+        provider->onScanStarted();
 
-    m_future = QtConcurrent::run([this]{
+    m_future = QtConcurrent::run([this, unchanged_dirs]{
         emit scanStarted();
 
+        DirIndex dir_index;
+        const bool dir_index_found = dir_index.load(dir_index_path());
+        if (dir_index_found)
+            dir_index.assume_unchanged(unchanged_dirs);
+
         providers::SearchContext sctx;
-        sctx.enable_network();
+        sctx.enable_network()
+            .use_dir_index(dir_index);
 
 
         QElapsedTimer run_timer;
         run_timer.start();
 
-        const std::vector<ProviderPtr> providers = enabled_providers();
+        // The providers that only add data to existing games run after the others,
+        // when the games can already be used
+        std::vector<ProviderPtr> game_sources;
+        std::vector<ProviderPtr> data_sources;
+        for (const ProviderPtr provider : enabled_providers()) {
+            if (provider->flags() & providers::PROVIDER_FLAG_NO_NEW_GAMES)
+                data_sources.emplace_back(provider);
+            else
+                game_sources.emplace_back(provider);
+        }
 
-        size_t progress_sections = providers.size();
-        for (const ProviderPtr provider : providers) {
-            if (provider->flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS)
+        size_t progress_sections = game_sources.size();
+        for (const ProviderPtr provider : game_sources) {
+            if (!has_progress(*provider))
                 progress_sections--;
         }
 
@@ -79,23 +145,11 @@ void ProviderManager::run()
         m_current_stage = QString();
         m_current_progress = 0.f;
 
-        for (size_t i = 0; i < providers.size(); i++) {
-            providers::Provider& provider = *providers[i];
-            m_current_stage = provider.display_name();
-            emit scanProgressChanged(m_current_progress, m_current_stage);
-
-            QElapsedTimer provider_timer;
-            provider_timer.start();
-
-            provider.run(sctx);
+        if (AppSettings::general.parallel_scan)
+            run_parallel(game_sources, sctx);
+        else
+            run_sequential(game_sources, sctx);
 
-            Log::info(provider.display_name(), LOGMSG("Finished searching in %1ms")
-                .arg(QString::number(provider_timer.restart())));
-
-            const bool has_progress = !(provider.flags() & providers::PROVIDER_FLAG_HIDE_PROGRESS);
-            if (has_progress)
-                m_current_progress += m_progress_step;
-        }
         m_current_progress = 1.f;
         m_current_stage = QString();
         emit scanProgressChanged(m_current_progress, m_current_stage);
@@ -120,11 +174,152 @@ void ProviderManager::run()
         finalize_timer.start();
 
         // TODO: C++17
-        std::tie(m_found_collections, m_found_games) = sctx.finalize();
+        std::vector<model::Collection*> collections;
+        std::vector<model::Game*> games;
+        std::tie(collections, games) = sctx.finalize();
 
         Log::info(LOGMSG("Game list post-processing took %1ms").arg(finalize_timer.elapsed()));
-        emit scanFinished();
+
+
+        // Publish the games; from here on they are only changed in the thread of the manager
+        QThread* const manager_thread = thread();
+        for (model::Collection* const coll : collections)
+            coll->moveToThread(manager_thread);
+        for (model::Game* const game : games)
+            game->moveToThread(manager_thread);
+
+        // NOTE: The objects are read for the snapshot only here, before publishing them.
+        //       The later changes of the search are recorded in the copy too.
+        QElapsedTimer copy_timer;
+        copy_timer.start();
+        providers::snapshot::LibraryCopy library_copy(collections, games);
+        Log::info(LOGMSG("Copying the library for the snapshot took %1ms").arg(copy_timer.elapsed()));
+
+        // NOTE: these might be taken by the receiver of the signal at any time
+        m_found_collections = std::move(collections);
+        m_found_games = std::move(games);
+        m_found_search_index = std::move(sctx.search_index());
+        emit gamesReady();
+
+        Log::info(LOGMSG("Games ready in %1ms").arg(run_timer.elapsed()));
+
+
+        sctx.publish_updates_to(this, &library_copy);
+        run_data_sources(data_sources, sctx);
+
+        QElapsedTimer snapshot_timer;
+        snapshot_timer.start();
+        providers::snapshot::Payload snapshot = library_copy.serialize();
+        m_found_checksum = snapshot.checksum;
+        Log::info(LOGMSG("Serializing the library snapshot took %1ms").arg(snapshot_timer.elapsed()));
+
+        // NOTE: the file is written in the background, it's not needed until the next start
+        QtConcurrent::run([snapshot]{
+            providers::snapshot::write_file(providers::snapshot::default_path(), snapshot);
+        });
+
+
+        // Paths where changes could affect the results
+        // NOTE: the media directories are also read through the directory index
+        m_found_watch_dirs = sctx.root_game_dirs() + sctx.pegasus_game_dirs() + dir_index.visited_dirs();
+        m_found_watch_dirs.removeDuplicates();
+        m_found_watch_files = sctx.pegasus_metafiles();
+        m_found_watch_files.removeDuplicates();
+
+        if (!dir_index.save(dir_index_path()))
+            Log::warning(LOGMSG("Could not save the directory index to `%1`").arg(dir_index_path()));
+        else if (!dir_index_found)
+            remove_old_media_cache();
     });
+    m_future_watcher.setFuture(m_future);
+}
+
+void ProviderManager::run_sequential(const std::vector<ProviderPtr>& providers, providers::SearchContext& sctx)
+{
+    for (const ProviderPtr provider : providers) {
+        m_current_stage = provider->display_name();
+        emit scanProgressChanged(m_current_progress, m_current_stage);
+
+        run_timed(*provider, sctx);
+
+        if (has_progress(*provider))
+            m_current_progress += m_progress_step;
+    }
+}
+
+void ProviderManager::run_data_sources(const std::vector<ProviderPtr>& providers, providers::SearchContext& sctx)
+{
+    // NOTE: The games may already be on the screen at this point, so there's no
+    //       progress reporting; the changes are sent to the games in batches
+    for (const ProviderPtr provider : providers) {
+        run_timed(*provider, sctx);
+        sctx.flush_updates();
+    }
+}
+
+void ProviderManager::run_parallel(const std::vector<ProviderPtr>& game_sources, providers::SearchContext& sctx)
+{
+    QElapsedTimer parallel_timer;
+    parallel_timer.start();
+
+    // Every game source gets its own staging context, so they don't have to wait for each other.
+    // NOTE: Online metadata is not waited for, so the staging contexts have no network access
+    std::vector<std::unique_ptr<providers::SearchContext>> staging_ctxs;
+    staging_ctxs.reserve(game_sources.size());
+    for (size_t i = 0; i < game_sources.size(); i++) {
+        staging_ctxs.emplace_back(new providers::SearchContext(sctx.root_game_dirs()));
+        staging_ctxs.back()->use_dir_index(sctx.dir_index());
+    }
+
+    QStringList stage_names;
+    for (const ProviderPtr provider : game_sources)
+        stage_names.append(provider->display_name());
+    const QString stage_label = stage_names.join(QLatin1String(", "));
+
+    // Individual progress reports would be ambiguous while the sources run together
+    m_current_stage = QString();
+    emit scanProgressChanged(m_current_progress, stage_label);
+
+    QThread* const merge_thread = QThread::currentThread();
+    const float base_progress = m_current_progress;
+    std::atomic<size_t> finished_sections(0);
+
+    std::vector<QFuture<void>> futures;
+    futures.reserve(game_sources.size());
+    for (size_t i = 0; i < game_sources.size(); i++) {
+        providers::Provider* const provider = game_sources[i];
+        providers::SearchContext* const staging_ctx = staging_ctxs[i].get();
+
+        futures.emplace_back(QtConcurrent::run([this, provider, staging_ctx, merge_thread,
+                                                base_progress, &finished_sections, &stage_label]{
+            run_timed(*provider, *staging_ctx);
+            staging_ctx->move_objects_to(merge_thread);
+
+            if (has_progress(*provider)) {
+                const size_t finished = ++finished_sections;
+                emit scanProgressChanged(base_progress + m_progress_step * finished, stage_label);
+            }
+        }));
+    }
+    for (QFuture<void>& future : futures)
+        future.waitForFinished();
+
+    // Merge in the original provider order, so the results are always the same
+    for (const std::unique_ptr<providers::SearchContext>& staging_ctx : staging_ctxs)
+        sctx.merge_staged(*staging_ctx);
+
+    m_current_progress = base_progress + m_progress_step * finished_sections;
+    Log::info(LOGMSG("Parallel game search took %1ms").arg(parallel_timer.elapsed()));
+}
+
+void ProviderManager::onScanTaskFinished()
+{
+    // NOTE: the providers apply the data held back during the scan to the current
+    //       objects first, see ApiObject::syncGameData
+    for (const auto& provider : AppSettings::providers())
+        provider->onScanFinished();
+
+    emit scanFinished();
 }
 
 void ProviderManager::onProviderProgressChanged(float percent)
@@ -148,18 +343,17 @@ void ProviderManager::onFavoritesChanged(const std::vector<model::Game*>& all_ga
 
 void ProviderManager::onGameLaunched(model::GameFile* const game) const
 {
-    if (m_future.isRunning())
-        return;
-
+    // NOTE: As the library snapshot is usable during the scan, games can be launched
+    //       any time. This event only records the time, so it is safe to forward.
     for (const auto& provider : AppSettings::providers())
         provider->onGameLaunched(game);
 }
 
 void ProviderManager::onGameFinished(model::GameFile* const game) const
 {
-    if (m_future.isRunning())
-        return;
-
+    // NOTE: The events are forwarded when they happen, so the providers can
+    //       record the time. Those that save data defer the writes until the
+    //       scan has finished, see Provider::onScanFinished.
     for (const auto& provider : AppSettings::providers())
         provider->onGameFinished(game);
 }
@@ -17,12 +17,19 @@
 
 #pragma once
 
+#include "model/gaming/GameSearchIndex.h"
+
+#include <QByteArray>
 #include <QObject>
 #include <QFuture>
+#include <QFutureWatcher>
+#include <QStringList>
 
 namespace model { class Collection; }
 namespace model { class Game; }
 namespace model { class GameFile; }
+namespace providers { class Provider; }
+namespace providers { class SearchContext; }
 
 
 class ProviderManager : public QObject {
@@ -31,7 +38,9 @@ class ProviderManager : public QObject {
 public:
     explicit ProviderManager(QObject* parent = nullptr);
 
-    void run();
+    // the cached listings of the unchanged directories are used without checking them
+    void run(const QStringList& unchanged_dirs = {});
+    bool isRunning() const { return m_future.isRunning(); }
 
     void onGameLaunched(model::GameFile* const) const;
     void onGameFinished(model::GameFile* const) const;
@@ -39,23 +48,39 @@ public:
 
     std::vector<model::Collection*>& foundCollections() { return m_found_collections; }
     std::vector<model::Game*>& foundGames() { return m_found_games; }
+    model::GameSearchIndex& foundSearchIndex() { return m_found_search_index; }
+    const QByteArray& foundChecksum() const { return m_found_checksum; }
+    const QStringList& foundWatchDirs() const { return m_found_watch_dirs; }
+    const QStringList& foundWatchFiles() const { return m_found_watch_files; }
 
 signals:
     void scanStarted();
     void scanProgressChanged(float, QString);
+    // the games and collections are complete, but their assets and
+    // other data may still change until the scan has finished
+    void gamesReady();
     void scanFinished();
 
 private slots:
     void onProviderProgressChanged(float);
+    void onScanTaskFinished();
 
 private:
     QFuture<void> m_future;
+    QFutureWatcher<void> m_future_watcher;
     float m_progress_step = 1.f;
     float m_current_progress = 0.f;
     QString m_current_stage;
 
     std::vector<model::Collection*> m_found_collections;
     std::vector<model::Game*> m_found_games;
+    model::GameSearchIndex m_found_search_index;
+    QByteArray m_found_checksum;
+    QStringList m_found_watch_dirs;
+    QStringList m_found_watch_files;
 
+    void run_sequential(const std::vector<providers::Provider*>&, providers::SearchContext&);
+    void run_parallel(const std::vector<providers::Provider*>&, providers::SearchContext&);
+    void run_data_sources(const std::vector<providers::Provider*>&, providers::SearchContext&);
     void finalize();
 };
@@ -18,10 +18,12 @@
 #include "SearchContext.h"
 
 #include "AppSettings.h"
+#include "LibrarySnapshot.h"
 #include "Log.h"
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
+#include "utils/DirIndex.h"
 #include "utils/DiskCachedNAM.h"
 #include "utils/PathTools.h"
 #include "utils/StdHelpers.h"
@@ -31,6 +33,9 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QSslSocket>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
 
 
 namespace {
@@ -47,10 +52,182 @@ QStringList read_game_dirs()
     game_dirs.removeDuplicates();
     return game_dirs;
 }
+
+// The number of changes after which the pending updates are sent to the games
+constexpr size_t UPDATE_BATCH_SIZE = 2048;
+
+// Sorts the parts of a large vector in parallel, then merges them
+template<typename T, typename Compare>
+void parallel_sort(std::vector<T>& vec, Compare comp)
+{
+    constexpr size_t MIN_PART_SIZE = 4096;
+    const size_t thread_count = static_cast<size_t>(std::max(1, QThreadPool::globalInstance()->maxThreadCount()));
+    const size_t part_count = std::min(thread_count, vec.size() / MIN_PART_SIZE);
+    if (part_count < 2) {
+        std::sort(vec.begin(), vec.end(), comp);
+        return;
+    }
+
+    struct Range {
+        size_t begin;
+        size_t mid;
+        size_t end;
+    };
+    std::vector<Range> parts;
+    parts.reserve(part_count);
+    for (size_t i = 0; i < part_count; i++) {
+        const size_t begin = vec.size() * i / part_count;
+        const size_t end = vec.size() * (i + 1) / part_count;
+        parts.push_back({ begin, end, end });
+    }
+
+    QtConcurrent::blockingMap(parts, [&vec, &comp](const Range& part){
+        std::sort(vec.begin() + part.begin, vec.begin() + part.end, comp);
+    });
+
+    while (parts.size() > 1) {
+        std::vector<Range> merges;
+        merges.reserve((parts.size() + 1) / 2);
+        for (size_t i = 0; i + 1 < parts.size(); i += 2)
+            merges.push_back({ parts[i].begin, parts[i].end, parts[i + 1].end });
+        if (parts.size() % 2)
+            merges.push_back(parts.back());
+
+        QtConcurrent::blockingMap(merges, [&vec, &comp](const Range& merge){
+            if (merge.mid < merge.end)
+                std::inplace_merge(vec.begin() + merge.begin, vec.begin() + merge.mid, vec.begin() + merge.end, comp);
+        });
+
+        for (Range& merge : merges)
+            merge.mid = merge.end;
+        parts = std::move(merges);
+    }
+}
+
+// NOTE: The merge functions below apply the data of a staged object to the one
+//       already present, the same way as if the later provider found the existing
+//       object in a sequential scan: the values it set replace the earlier ones,
+//       and the list entries are appended.
+void merge_assets(model::AssetLists& dst, const model::AssetLists& src)
+{
+    for (size_t type_idx = 0; type_idx < ASSET_TYPE_COUNT; type_idx++) {
+        const auto type = static_cast<AssetType>(type_idx);
+        for (model::StoredAsset& asset : src.stored(type)) {
+            if (asset.is_file)
+                dst.add_file(type, std::move(asset.value));
+            else
+                dst.add_uri(type, std::move(asset.value));
+        }
+    }
+}
+
+void merge_extra(QVariantMap& dst, const QVariantMap& src)
+{
+    for (auto it = src.cbegin(); it != src.cend(); ++it)
+        dst.insert(it.key(), it.value());
+}
+
+void merge_game_data(model::Game& dst, const model::Game& src)
+{
+    if (!src.title().isEmpty())
+        dst.setTitle(src.title());
+    // the sort title follows the title, unless it was set separately
+    if (!src.sortBy().isEmpty() && src.sortBy() != src.title())
+        dst.setSortBy(src.sortBy());
+    if (!src.summary().isEmpty())
+        dst.setSummary(src.summary());
+    if (!src.description().isEmpty())
+        dst.setDescription(src.description());
+    if (src.releaseDate().isValid())
+        dst.setReleaseDate(src.releaseDate());
+    if (src.playerCount() > 1)
+        dst.setPlayerCount(src.playerCount());
+    if (src.rating() > 0.f)
+        dst.setRating(src.rating());
+    if (src.isFavorite())
+        dst.setFavorite(true);
+
+    if (!src.launchCmd().isEmpty())
+        dst.setLaunchCmd(src.launchCmd());
+    if (!src.launchWorkdir().isEmpty())
+        dst.setLaunchWorkdir(src.launchWorkdir());
+    if (!src.launchCmdBasedir().isEmpty())
+        dst.setLaunchCmdBasedir(src.launchCmdBasedir());
+
+    dst.developerList().append(src.developerListConst());
+    dst.publisherList().append(src.publisherListConst());
+    dst.genreList().append(src.genreListConst());
+    dst.tagList().append(src.tagListConst());
+
+    merge_extra(dst.extraMapMut(), src.extraMap());
+    merge_assets(dst.assetsMut(), src.assets());
+}
+
+void merge_collection_data(model::Collection& dst, const model::Collection& src)
+{
+    if (src.sortBy() != src.name())
+        dst.setSortBy(src.sortBy());
+    if (src.shortName() != src.name().toLower())
+        dst.setShortName(src.shortName());
+    if (!src.summary().isEmpty())
+        dst.setSummary(src.summary());
+    if (!src.description().isEmpty())
+        dst.setDescription(src.description());
+
+    if (!src.commonLaunchCmd().isEmpty())
+        dst.setCommonLaunchCmd(src.commonLaunchCmd());
+    if (!src.commonLaunchWorkdir().isEmpty())
+        dst.setCommonLaunchWorkdir(src.commonLaunchWorkdir());
+    if (!src.commonLaunchCmdBasedir().isEmpty())
+        dst.setCommonLaunchCmdBasedir(src.commonLaunchCmdBasedir());
+
+    merge_extra(dst.extraMapMut(), src.extraMap());
+    merge_assets(dst.assetsMut(), src.assets());
+}
 } // namespace
 
 
 namespace providers {
+struct SearchContext::PendingUpdates {
+    struct AssetFile {
+        model::Game* game;
+        AssetType type;
+        QString path;
+    };
+
+    std::vector<AssetFile> asset_files;
+    std::vector<std::pair<model::Game*, bool>> favorites;
+    std::vector<model::PlaySession> play_sessions;
+
+    size_t size() const { return asset_files.size() + favorites.size() + play_sessions.size(); }
+    void apply() const;
+};
+
+void SearchContext::PendingUpdates::apply() const
+{
+    std::vector<model::Game*> changed_games;
+    changed_games.reserve(asset_files.size());
+    for (const AssetFile& asset : asset_files) {
+        asset.game->assetsMut().add_file(asset.type, asset.path);
+        changed_games.emplace_back(asset.game);
+    }
+    std::sort(changed_games.begin(), changed_games.end());
+    changed_games.erase(std::unique(changed_games.begin(), changed_games.end()), changed_games.end());
+
+    // trigger update only once per game
+    for (model::Game* const game : changed_games)
+        game->notifyAssetsChanged();
+
+    for (const auto& pair : favorites) {
+        if (pair.first->isFavorite() != pair.second)
+            pair.first->setFavorite(pair.second);
+    }
+
+    if (!play_sessions.empty())
+        model::GameFile::update_playstats(play_sessions);
+}
+
+
 SearchContext::SearchContext(QObject* parent)
     : SearchContext(read_game_dirs(), parent)
 {}
@@ -59,12 +236,31 @@ SearchContext::SearchContext(QStringList game_dirs, QObject* parent)
     : QObject(parent)
     , m_root_game_dirs(std::move(game_dirs))
     , m_pending_downloads(0)
+    , m_own_dir_index(new DirIndex())
+    , m_dir_index(m_own_dir_index.get())
+    , m_pending_updates(new PendingUpdates())
 {}
 
+SearchContext::~SearchContext() = default;
+
+SearchContext& SearchContext::use_dir_index(DirIndex& index)
+{
+    m_dir_index = &index;
+    return *this;
+}
+
 SearchContext& SearchContext::pegasus_add_game_dir(QString path)
 {
-    m_pegasus_game_dirs.append(std::move(path));
-    m_pegasus_game_dirs.removeDuplicates();  // TODO: optimize?
+    if (!m_pegasus_game_dir_set.contains(path)) {
+        m_pegasus_game_dir_set.insert(path);
+        m_pegasus_game_dirs.append(std::move(path));
+    }
+    return *this;
+}
+
+SearchContext& SearchContext::pegasus_add_metafile(QString path)
+{
+    m_pegasus_metafiles.append(std::move(path));
     return *this;
 }
 
@@ -94,7 +290,7 @@ model::Game* SearchContext::create_game_for(model::Collection& collection)
 model::Game* SearchContext::create_game()
 {
     auto* const game_ptr = new model::Game();
-    m_parentless_games.emplace_back(game_ptr);
+    add_parentless_game(game_ptr);
     return game_ptr;
 }
 
@@ -160,10 +356,99 @@ model::GameFile* SearchContext::game_add_uri(model::Game& game, QString uri)
     return entry_ptr;
 }
 
+SearchContext& SearchContext::reserve_games(size_t count)
+{
+    m_game_entries.reserve(m_game_entries.size() + count);
+    m_filepath_to_gamefile.reserve(m_filepath_to_gamefile.size() + count);
+    return *this;
+}
+
+SearchContext& SearchContext::game_add_asset_file(model::Game& game, AssetType type, QString path)
+{
+    if (!m_update_receiver) {
+        game.assetsMut().add_file(type, std::move(path));
+        return *this;
+    }
+
+    if (m_update_copy)
+        m_update_copy->add_asset_file(game, type, path);
+
+    m_pending_updates->asset_files.push_back({ &game, type, std::move(path) });
+    if (m_pending_updates->size() >= UPDATE_BATCH_SIZE)
+        flush_updates();
+
+    return *this;
+}
+
+SearchContext& SearchContext::game_set_favorite(model::Game& game, bool favorite)
+{
+    if (!m_update_receiver) {
+        game.setFavorite(favorite);
+        return *this;
+    }
+
+    if (m_update_copy)
+        m_update_copy->set_favorite(game, favorite);
+
+    m_pending_updates->favorites.emplace_back(&game, favorite);
+    if (m_pending_updates->size() >= UPDATE_BATCH_SIZE)
+        flush_updates();
+
+    return *this;
+}
+
+SearchContext& SearchContext::add_play_sessions(std::vector<model::PlaySession> sessions)
+{
+    if (!m_update_receiver) {
+        model::GameFile::update_playstats(sessions);
+        return *this;
+    }
+
+    if (m_update_copy)
+        m_update_copy->add_play_sessions(sessions);
+
+    std::vector<model::PlaySession>& pending = m_pending_updates->play_sessions;
+    pending.insert(pending.end(), sessions.begin(), sessions.end());
+    if (m_pending_updates->size() >= UPDATE_BATCH_SIZE)
+        flush_updates();
+
+    return *this;
+}
+
+// Once the games are used by another thread, all further changes to them go
+// through the receiver object living in that thread
+SearchContext& SearchContext::publish_updates_to(QObject* const receiver, snapshot::LibraryCopy* const copy)
+{
+    flush_updates();
+    m_update_receiver = receiver;
+    m_update_copy = copy;
+    return *this;
+}
+
+SearchContext& SearchContext::flush_updates()
+{
+    if (m_pending_updates->size() == 0)
+        return *this;
+
+    std::shared_ptr<PendingUpdates> batch(m_pending_updates.release());
+    m_pending_updates.reset(new PendingUpdates());
+
+    // NOTE: The batch is applied on the thread of the receiver, so the games are
+    //       only changed there. The call does not wait for it, as the event loop
+    //       of the receiver might not run anymore (eg. when quitting), in which
+    //       case the batch is simply dropped.
+    if (m_update_receiver && m_update_receiver->thread() != QThread::currentThread())
+        QMetaObject::invokeMethod(m_update_receiver, [batch]{ batch->apply(); }, Qt::QueuedConnection);
+    else
+        batch->apply();
+
+    return *this;
+}
+
 SearchContext& SearchContext::game_add_to(model::Game& game, model::Collection& collection)
 {
     m_collection_games[&collection].emplace_back(&game);
-    VEC_REMOVE_VALUE(m_parentless_games, &game);
+    remove_parentless_game(&game);
 
     if (game.launchCmd().isEmpty())
         game.setLaunchCmd(collection.commonLaunchCmd());
@@ -175,14 +460,195 @@ SearchContext& SearchContext::game_add_to(model::Game& game, model::Collection&
     return *this;
 }
 
+// NOTE: Instead of erasing from the middle of the list, the slot of the game
+//       is cleared, so the lookup index stays valid and the order is kept
+void SearchContext::add_parentless_game(model::Game* const game_ptr)
+{
+    m_parentless_game_idx.emplace(game_ptr, m_parentless_games.size());
+    m_parentless_games.emplace_back(game_ptr);
+}
+
+void SearchContext::remove_parentless_game(model::Game* const game_ptr)
+{
+    const auto it = m_parentless_game_idx.find(game_ptr);
+    if (it == m_parentless_game_idx.cend())
+        return;
+
+    m_parentless_games[it->second] = nullptr;
+    m_parentless_game_idx.erase(game_ptr);
+}
+
+SearchContext& SearchContext::move_objects_to(QThread* const thread)
+{
+    Q_ASSERT(thread);
+
+    // NOTE: moving an object also moves its children (assets, files),
+    // and objects already living in the target thread are skipped by Qt
+    for (const auto& pair : m_collections)
+        pair.second->moveToThread(thread);
+    for (const auto& pair : m_collection_games) {
+        for (model::Game* const game_ptr : pair.second)
+            game_ptr->moveToThread(thread);
+    }
+    for (const auto& pair : m_game_entries)
+        pair.first->moveToThread(thread);
+    for (model::Game* const game_ptr : m_parentless_games) {
+        if (game_ptr)
+            game_ptr->moveToThread(thread);
+    }
+
+    return *this;
+}
+
+// Moves the results of a staging context into this one. Collections are matched
+// by name and games by their files; in case of a conflict the object that was
+// already present is kept, and the data of the staged one is merged into it.
+SearchContext& SearchContext::merge_staged(SearchContext& staged)
+{
+    Q_ASSERT(&staged != this);
+
+    HashMap<model::Collection*, model::Collection*> coll_remap;
+    for (const auto& pair : staged.m_collections) {
+        const auto it = m_collections.find(pair.first);
+        if (it == m_collections.cend())
+            m_collections.emplace(pair.first, pair.second);
+        else
+            coll_remap.emplace(pair.second, it->second);
+    }
+
+    m_game_entries.reserve(m_game_entries.size() + staged.m_game_entries.size());
+    m_filepath_to_gamefile.reserve(m_filepath_to_gamefile.size() + staged.m_filepath_to_gamefile.size());
+    m_uri_to_gamefile.reserve(m_uri_to_gamefile.size() + staged.m_uri_to_gamefile.size());
+
+    HashMap<model::Game*, model::Game*> game_remap;
+    for (const auto& pair : staged.m_filepath_to_gamefile) {
+        model::GameFile* const existing = gamefile_by_filepath(pair.first);
+        if (existing)
+            game_remap.emplace(pair.second->parentGame(), existing->parentGame());
+    }
+    for (const auto& pair : staged.m_uri_to_gamefile) {
+        model::GameFile* const existing = gamefile_by_uri(pair.first);
+        if (existing)
+            game_remap.emplace(pair.second->parentGame(), existing->parentGame());
+    }
+
+    const auto target_game_of = [&game_remap](model::GameFile* const entry_ptr){
+        model::Game* const game_ptr = entry_ptr->parentGame();
+        const auto it = game_remap.find(game_ptr);
+        return it != game_remap.cend() ? it->second : game_ptr;
+    };
+    const auto move_entry = [this, &target_game_of](model::GameFile* const entry_ptr){
+        model::Game* const target_ptr = target_game_of(entry_ptr);
+        if (target_ptr != entry_ptr->parentGame())
+            entry_ptr->setParent(target_ptr);
+        m_game_entries[target_ptr].emplace_back(entry_ptr);
+    };
+
+    // Files already known here stay with their current game, and get deleted
+    // together with the staged duplicate, after their play stats are merged
+    const auto merge_entry = [](model::GameFile& dst, const model::GameFile& src){
+        if (src.playCount() > 0 || src.playTime() > 0 || src.lastPlayed().isValid())
+            dst.update_playstats(src.playCount(), src.playTime(), src.lastPlayed());
+    };
+    for (const auto& pair : staged.m_filepath_to_gamefile) {
+        const auto it = m_filepath_to_gamefile.find(pair.first);
+        if (it != m_filepath_to_gamefile.cend()) {
+            merge_entry(*it->second, *pair.second);
+            continue;
+        }
+        move_entry(pair.second);
+        m_filepath_to_gamefile.emplace(pair.first, pair.second);
+    }
+    for (const auto& pair : staged.m_uri_to_gamefile) {
+        const auto it = m_uri_to_gamefile.find(pair.first);
+        if (it != m_uri_to_gamefile.cend()) {
+            merge_entry(*it->second, *pair.second);
+            continue;
+        }
+        move_entry(pair.second);
+        m_uri_to_gamefile.emplace(pair.first, pair.second);
+    }
+
+    for (const auto& pair : game_remap)
+        merge_game_data(*pair.second, *pair.first);
+    for (const auto& pair : coll_remap)
+        merge_collection_data(*pair.second, *pair.first);
+
+    for (const auto& pair : staged.m_collection_games) {
+        const auto coll_it = coll_remap.find(pair.first);
+        model::Collection* const coll_ptr = coll_it != coll_remap.cend() ? coll_it->second : pair.first;
+
+        std::vector<model::Game*>& game_list = m_collection_games[coll_ptr];
+        for (model::Game* const game_ptr : pair.second) {
+            const auto game_it = game_remap.find(game_ptr);
+            game_list.emplace_back(game_it != game_remap.cend() ? game_it->second : game_ptr);
+        }
+    }
+
+    for (model::Game* const game_ptr : staged.m_parentless_games) {
+        if (game_ptr && !game_remap.count(game_ptr))
+            add_parentless_game(game_ptr);
+    }
+
+    for (const QString& dir_path : staged.m_pegasus_game_dirs)
+        pegasus_add_game_dir(dir_path);
+    m_pegasus_metafiles.append(staged.m_pegasus_metafiles);
+
+    for (const auto& pair : game_remap)
+        delete pair.first;
+    for (const auto& pair : coll_remap)
+        delete pair.first;
+
+    staged.m_collections.clear();
+    staged.m_collection_games.clear();
+    staged.m_game_entries.clear();
+    staged.m_filepath_to_gamefile.clear();
+    staged.m_uri_to_gamefile.clear();
+    staged.m_parentless_games.clear();
+    staged.m_parentless_game_idx.clear();
+    staged.m_pegasus_game_dirs.clear();
+    staged.m_pegasus_game_dir_set.clear();
+    staged.m_pegasus_metafiles.clear();
+
+    return *this;
+}
+
 void SearchContext::finalize_cleanup_games()
 {
     // remove parentless games
+    std::vector<model::GameFile*> deleted_files;
     for (model::Game* const game_ptr : m_parentless_games) {
+        if (!game_ptr)
+            continue;
+
         Log::warning(LOGMSG("The game '%1' does not belong to any collections, ignored").arg(game_ptr->title()));
-        m_game_entries.erase(game_ptr);
+        const auto entries_it = m_game_entries.find(game_ptr);
+        if (entries_it != m_game_entries.end()) {
+            deleted_files.insert(deleted_files.end(), entries_it->second.cbegin(), entries_it->second.cend());
+            m_game_entries.erase(game_ptr);
+        }
         delete game_ptr;
     }
+    m_parentless_games.clear();
+    m_parentless_game_idx.clear();
+
+    // NOTE: the lookup maps remain usable after finalizing,
+    //       so the files of the deleted games are removed from them
+    if (!deleted_files.empty()) {
+        std::sort(deleted_files.begin(), deleted_files.end());
+        const auto is_deleted = [&deleted_files](model::GameFile* const ptr){
+            return std::binary_search(deleted_files.cbegin(), deleted_files.cend(), ptr);
+        };
+        for (FlatHashMap<QString, model::GameFile*>* const map : { &m_filepath_to_gamefile, &m_uri_to_gamefile }) {
+            QStringList dead_keys;
+            for (const auto& pair : *map) {
+                if (is_deleted(pair.second))
+                    dead_keys.append(pair.first);
+            }
+            for (const QString& key : dead_keys)
+                map->erase(key);
+        }
+    }
 
     // Remove entryless games
     for (auto& pair : m_collection_games) {
@@ -226,28 +692,74 @@ void SearchContext::finalize_cleanup_collections()
 
 void SearchContext::finalize_apply_lists()
 {
-    // Apply game entries
-    for (auto& pair : m_game_entries) {
-        Q_ASSERT(!pair.second.empty());
-        pair.first->setFiles(std::move(pair.second));
+    // NOTE: the collation keys of the collections are used from multiple threads
+    //       by the game jobs below, so they have to be created in advance
+    for (const auto& pair : m_collections)
+        pair.second->sortKey();
+
+    // The relations of the games and collections as a flat list, grouped by games
+    using Relation = std::pair<model::Game*, model::Collection*>;
+    std::vector<Relation> relations;
+    {
+        size_t relation_count = 0;
+        for (const auto& pair : m_collection_games)
+            relation_count += pair.second.size();
+
+        relations.reserve(relation_count);
+        for (const auto& pair : m_collection_games) {
+            for (model::Game* const game_ptr : pair.second)
+                relations.emplace_back(game_ptr, pair.first);
+        }
+        parallel_sort(relations, std::less<Relation>());
+        relations.erase(std::unique(relations.begin(), relations.end()), relations.end());
     }
 
-    // Apply collections to games
-    HashMap<model::Game*, std::vector<model::Collection*>> game_collections;
-    for (const auto& pair : m_collection_games) {
-        for (model::Game* const game_ptr : pair.second)
-            game_collections[game_ptr].emplace_back(pair.first);
-    }
-    for (auto& pair : game_collections) {
-        VEC_REMOVE_DUPLICATES(pair.second);
-        pair.first->setCollections(std::move(pair.second));
+    // Apply the files and collections to the games, in parallel
+    struct GameJob {
+        model::Game* game;
+        std::vector<model::GameFile*>* files;
+        std::vector<Relation>::const_iterator relations_begin;
+        std::vector<Relation>::const_iterator relations_end;
+    };
+    std::vector<GameJob> game_jobs;
+    game_jobs.reserve(m_game_entries.size());
+    for (auto& pair : m_game_entries) {
+        const auto range = std::equal_range(relations.cbegin(), relations.cend(), Relation(pair.first, nullptr),
+            [](const Relation& a, const Relation& b){ return std::less<model::Game*>()(a.first, b.first); });
+        game_jobs.push_back({ pair.first, &pair.second, range.first, range.second });
     }
 
-    // Apply games to collections
-    for (auto& pair : m_collection_games) {
-        VEC_REMOVE_DUPLICATES(pair.second);
+    QtConcurrent::blockingMap(game_jobs, [](const GameJob& job){
+        Q_ASSERT(!job.files->empty());
+
+        // NOTE: the sorts in the setters use the collation keys
+        job.game->sortKey();
+        for (const model::GameFile* const gamefile : *job.files)
+            gamefile->sortKey();
+
+        std::vector<model::Collection*> collections;
+        collections.reserve(static_cast<size_t>(std::distance(job.relations_begin, job.relations_end)));
+        for (auto it = job.relations_begin; it != job.relations_end; ++it)
+            collections.emplace_back(it->second);
+
+        job.game->setFiles(std::move(*job.files));
+        job.game->setCollections(std::move(collections));
+    });
+
+    // Sort the game lists of the collections in parallel; the models have to be
+    // created on this thread though
+    std::vector<std::vector<model::Game*>*> game_lists;
+    game_lists.reserve(m_collection_games.size());
+    for (auto& pair : m_collection_games)
+        game_lists.emplace_back(&pair.second);
+
+    QtConcurrent::blockingMap(game_lists, [](std::vector<model::Game*>* game_list){
+        VEC_REMOVE_DUPLICATES(*game_list);
+        std::sort(game_list->begin(), game_list->end(), model::sort_games);
+    });
+
+    for (auto& pair : m_collection_games)
         pair.first->setGames(std::move(pair.second));
-    }
 }
 
 std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchContext::finalize(QObject* const parent)
@@ -265,10 +777,11 @@ std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchCont
     for (const auto& pair : m_game_entries) {
         model::Game& game = *pair.first;
 
-        game.developerList().removeDuplicates();
-        game.publisherList().removeDuplicates();
-        game.genreList().removeDuplicates();
-        game.tagList().removeDuplicates();
+        // NOTE: this also removes the duplicates
+        m_string_pool.intern_list(game.developerList());
+        m_string_pool.intern_list(game.publisherList());
+        m_string_pool.intern_list(game.genreList());
+        m_string_pool.intern_list(game.tagList());
 
         games.emplace_back(pair.first);
     }
@@ -294,7 +807,11 @@ std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> SearchCont
 
 
     std::sort(collections.begin(), collections.end(), model::sort_collections);
-    std::sort(games.begin(), games.end(), model::sort_games);
+    parallel_sort(games, model::sort_games);
+
+    m_search_index.clear();
+    for (model::Game* const game : games)
+        m_search_index.add(game);
 
     return std::make_pair(std::move(collections), std::move(games));
 }
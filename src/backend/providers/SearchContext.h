@@ -17,19 +17,28 @@
 
 #pragma once
 
-#include "utils/HashMap.h"
+#include "model/gaming/GameSearchIndex.h"
+#include "types/AssetType.h"
+#include "utils/FlatHashMap.h"
 #include "utils/NoCopyNoMove.h"
+#include "utils/StringPool.h"
 
 #include <QObject>
+#include <QSet>
 #include <QStringList>
+#include <memory>
 #include <vector>
 
 namespace model { class Game; }
 namespace model { class GameFile; }
 namespace model { class Collection; }
+namespace model { struct PlaySession; }
+class DirIndex;
 class QNetworkAccessManager;
 class QNetworkReply;
+class QThread;
 class QUrl;
+namespace providers { namespace snapshot { class LibraryCopy; } }
 
 
 namespace providers {
@@ -40,6 +49,7 @@ class SearchContext : public QObject {
 public:
     explicit SearchContext(QObject* parent = nullptr);
     explicit SearchContext(QStringList, QObject* parent = nullptr);
+    ~SearchContext();
     NO_COPY_NO_MOVE(SearchContext)
 
     model::Collection* get_or_create_collection(const QString&);
@@ -53,18 +63,42 @@ public:
     model::GameFile* gamefile_by_uri(const QString&) const;
     model::GameFile* game_add_filepath(model::Game&, QString);
     model::GameFile* game_add_uri(model::Game&, QString);
+    // optional hint about the number of game files a provider is about to add
+    SearchContext& reserve_games(size_t);
+
+    // Changes to the data of the found games. Once the games are published, these
+    // are collected and applied in batches on the thread of the update receiver,
+    // and also recorded in the library copy, if there's one.
+    SearchContext& game_add_asset_file(model::Game&, AssetType, QString);
+    SearchContext& game_set_favorite(model::Game&, bool);
+    SearchContext& add_play_sessions(std::vector<model::PlaySession>);
+    SearchContext& publish_updates_to(QObject* const, snapshot::LibraryCopy* const = nullptr);
+    SearchContext& flush_updates();
 
     const QStringList& root_game_dirs() const { return m_root_game_dirs; }
     const QStringList& pegasus_game_dirs() const { return m_pegasus_game_dirs; }
     SearchContext& pegasus_add_game_dir(QString);
+    const QStringList& pegasus_metafiles() const { return m_pegasus_metafiles; }
+    SearchContext& pegasus_add_metafile(QString);
 
     SearchContext& enable_network();
     bool has_network() const;
     SearchContext& schedule_download(const QUrl&, const std::function<void(QNetworkReply* const)>&);
     bool has_pending_downloads() const;
 
-    const HashMap<QString, model::GameFile*>& current_filepath_to_entry_map() const { return m_filepath_to_gamefile; }
+    const FlatHashMap<QString, model::GameFile*>& current_filepath_to_entry_map() const { return m_filepath_to_gamefile; }
+
+    // cached directory listings, by default only for the lifetime of this context
+    DirIndex& dir_index() const { return *m_dir_index; }
+    SearchContext& use_dir_index(DirIndex&);
+
+    // staging support for running providers in parallel
+    SearchContext& move_objects_to(QThread* const);
+    SearchContext& merge_staged(SearchContext&);
+
     std::pair<std::vector<model::Collection*>, std::vector<model::Game*>> finalize(QObject* const parent = nullptr);
+    // the text search index of the finalized games
+    model::GameSearchIndex& search_index() { return m_search_index; }
 
 signals:
     void downloadScheduled();
@@ -73,17 +107,38 @@ signals:
 private:
     const QStringList m_root_game_dirs;
     QStringList m_pegasus_game_dirs;
+    QSet<QString> m_pegasus_game_dir_set;
+    QStringList m_pegasus_metafiles;
 
     QNetworkAccessManager* m_netman = nullptr;
     std::atomic<size_t> m_pending_downloads;
 
-    HashMap<QString, model::Collection*> m_collections;
-    HashMap<model::Collection*, std::vector<model::Game*>> m_collection_games;
-    HashMap<model::Game*, std::vector<model::GameFile*>> m_game_entries;
-    HashMap<QString, model::GameFile*> m_filepath_to_gamefile;
-    HashMap<QString, model::GameFile*> m_uri_to_gamefile;
+    std::unique_ptr<DirIndex> m_own_dir_index;
+    DirIndex* m_dir_index;
+
+    FlatHashMap<QString, model::Collection*> m_collections;
+    FlatHashMap<model::Collection*, std::vector<model::Game*>> m_collection_games;
+    FlatHashMap<model::Game*, std::vector<model::GameFile*>> m_game_entries;
+    FlatHashMap<QString, model::GameFile*> m_filepath_to_gamefile;
+    FlatHashMap<QString, model::GameFile*> m_uri_to_gamefile;
 
+    // games not added to any collections yet, in creation order; the slots of
+    // the games added since are null
     std::vector<model::Game*> m_parentless_games;
+    FlatHashMap<model::Game*, size_t> m_parentless_game_idx;
+
+    // shared copies of the texts used by many games
+    StringPool m_string_pool;
+
+    model::GameSearchIndex m_search_index;
+
+    struct PendingUpdates;
+    std::unique_ptr<PendingUpdates> m_pending_updates;
+    QObject* m_update_receiver = nullptr;
+    snapshot::LibraryCopy* m_update_copy = nullptr;
+
+    void add_parentless_game(model::Game*);
+    void remove_parentless_game(model::Game*);
 
     void finalize_cleanup_games();
     void finalize_cleanup_collections();
@@ -22,14 +22,16 @@
 #include "model/gaming/Collection.h"
 #include "providers/SearchContext.h"
 #include "providers/es2/Es2Systems.h"
+#include "utils/DirIndex.h"
 #include "utils/PathTools.h"
 #include "utils/StdHelpers.h"
 
-#include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QRegularExpression>
 #include <QStringBuilder>
 #include <QTextStream>
+#include <algorithm>
 
 
 namespace {
@@ -52,6 +54,23 @@ QStringList parse_filters(const QString& filters_raw) {
     filter_list.removeDuplicates();
     return filter_list;
 }
+
+std::vector<QRegularExpression> filters_to_regexes(const QStringList& filters)
+{
+    std::vector<QRegularExpression> out;
+    out.reserve(filters.size());
+    for (const QString& filter : filters) {
+        out.emplace_back(QRegularExpression::wildcardToRegularExpression(filter),
+                         QRegularExpression::CaseInsensitiveOption);
+    }
+    return out;
+}
+
+bool matches_any(const std::vector<QRegularExpression>& regexes, const QString& name)
+{
+    return std::any_of(regexes.cbegin(), regexes.cend(),
+        [&name](const QRegularExpression& rx){ return rx.match(name).hasMatch(); });
+}
 } // namespace
 
 
@@ -111,21 +130,6 @@ size_t find_games_for(
         .setShortName(sysentry.shortname)
         .setCommonLaunchCmd(sysentry.launch_cmd);
 
-    // find all (sub-)directories, but ignore 'media'
-    const QStringList dirs = [&sysentry]{
-        QStringList result;
-
-        constexpr auto subdir_filters = QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
-        constexpr auto subdir_flags = QDirIterator::FollowSymlinks | QDirIterator::Subdirectories;
-        QDirIterator dirs_it(sysentry.path, subdir_filters, subdir_flags);
-        while (dirs_it.hasNext())
-            result.append(dirs_it.next());
-
-        result.removeOne(sysentry.path + QStringLiteral("/media"));
-        result.append(sysentry.path);
-        return result;
-    }();
-
     // use the blacklist maybe
     const QVector<QStringRef> platforms = split_list(sysentry.platforms);
     const bool use_blacklist = VEC_CONTAINS(platforms, QLatin1String("arcade"))
@@ -134,31 +138,45 @@ size_t find_games_for(
 
     // scan for game files
 
-    constexpr auto entry_filters = QDir::Files | QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto entry_flags = QDirIterator::FollowSymlinks;
-    const QStringList name_filters = parse_filters(sysentry.extensions);
+    const std::vector<QRegularExpression> name_filters = filters_to_regexes(parse_filters(sysentry.extensions));
 
-    size_t found_games = 0;
-    for (const QString& dir_path : dirs) {
-        QDirIterator files_it(dir_path, name_filters, entry_filters, entry_flags);
-        while (files_it.hasNext()) {
-            files_it.next();
-            QFileInfo fileinfo = files_it.fileInfo();
-
-            const QString filename = fileinfo.completeBaseName();
-            if (use_blacklist && VEC_CONTAINS(filename_blacklist, filename))
-                continue;
+    const auto add_entry = [&](const QString& dir_path, const QString& name) -> bool {
+        if (!matches_any(name_filters, name))
+            return false;
+
+        const QFileInfo fileinfo(dir_path, name);
+
+        const QString filename = fileinfo.completeBaseName();
+        if (use_blacklist && VEC_CONTAINS(filename_blacklist, filename))
+            return false;
 
-            QString path = ::clean_abs_path(fileinfo);
-            model::Game* game_ptr = sctx.game_by_filepath(path);
-            if (!game_ptr) {
-                game_ptr = sctx.create_game_for(collection);
-                sctx.game_add_filepath(*game_ptr, std::move(path));
-            }
-            sctx.game_add_to(*game_ptr, collection);
-            found_games++;
+        QString path = ::clean_abs_path(fileinfo);
+        model::Game* game_ptr = sctx.game_by_filepath(path);
+        if (!game_ptr) {
+            game_ptr = sctx.create_game_for(collection);
+            sctx.game_add_filepath(*game_ptr, std::move(path));
         }
-    }
+        sctx.game_add_to(*game_ptr, collection);
+        return true;
+    };
+
+    // check all (sub-)directories, but ignore 'media'
+    // NOTE: Directory listings come from the index of the search context,
+    //       so unchanged directories are not read again on a rescan
+    // NOTE: Only the contents of 'media' itself are ignored, its subdirectories
+    //       are checked like any other
+    const QString media_dir = sysentry.path + QStringLiteral("/media");
+
+    size_t found_games = 0;
+    sctx.dir_index().walk(sysentry.path, [&](const QString& dir_path, const DirIndex::Listing& listing){
+        if (dir_path == media_dir)
+            return;
+
+        for (const QString& name : listing.files)
+            found_games += add_entry(dir_path, name);
+        for (const QString& name : listing.dirs)
+            found_games += add_entry(dir_path, name);
+    });
 
     return found_games;
 }
@@ -54,7 +54,7 @@ bool apply_api_json(const QString&, model::Game& game, const QJsonDocument& json
     game.setReleaseDate(QDate::fromString(date_raw, Qt::ISODate));
 
 
-    model::Assets& assets = game.assetsMut();  // FIXME: update signals?
+    model::AssetLists& assets = game.assetsMut();
 
     const auto images = json_root[QLatin1String("images")].toObject();
     if (!images.isEmpty()) {
@@ -82,6 +82,8 @@ bool apply_api_json(const QString&, model::Game& game, const QJsonDocument& json
             assets.add_uri(AssetType::SCREENSHOT, url);
     }
 
+    // the data may arrive after the game is already in use
+    game.notifyAssetsChanged();
     return true;
 }
 
@@ -19,26 +19,47 @@
 
 #include "model/gaming/Assets.h"
 #include "model/gaming/Game.h"
+#include "utils/DirIndex.h"
+#include "utils/PathTools.h"
 
-#include <QDirIterator>
+#include <QRegularExpression>
 #include <QStringBuilder>
 
 
 namespace {
-HashMap<QString, model::Game*> build_escaped_title_map(const std::vector<model::Game*>& games)
+// NOTE: the keys of the map point into `escaped_titles`
+HashMap<QStringView, model::Game*> build_escaped_title_map(
+    const std::vector<model::Game*>& games,
+    std::vector<QString>& escaped_titles)
 {
     const QRegularExpression rx_invalid(QStringLiteral(R"([<>:"\/\\|?*'])"));
     const QString underscore(QLatin1Char('_'));
 
-    HashMap<QString, model::Game*> out;
+    escaped_titles.reserve(games.size());
+
+    HashMap<QStringView, model::Game*> out;
+    out.reserve(games.size());
     for (model::Game* const game_ptr : games) {
         QString title = game_ptr->title();
         title.replace(rx_invalid, underscore);
-        out.emplace(std::move(title), game_ptr);
+        escaped_titles.emplace_back(std::move(title));
+        out.emplace(escaped_titles.back(), game_ptr);
     }
 
     return out;
 }
+
+// Matches the `-xx` numbering of the additional images of a game
+bool has_number_suffix(QStringView basename)
+{
+    const auto is_digit = [](QChar c){ return QLatin1Char('0') <= c && c <= QLatin1Char('9'); };
+
+    const int len = basename.size();
+    return len >= 3
+        && basename[len - 3] == QLatin1Char('-')
+        && is_digit(basename[len - 2])
+        && is_digit(basename[len - 1]);
+}
 } // namespace
 
 
@@ -84,53 +105,54 @@ Assets::Assets(QString log_tag, QString lb_root_path)
         { QStringLiteral("Steam Poster"), AssetType::POSTER },
         { QStringLiteral("Steam Screenshot"), AssetType::SCREENSHOT },
     }
-    , rx_number_suffix(QStringLiteral(R"(-[0-9]{2}$)"))
 {}
 
-void Assets::find_assets_for(const QString& platform_name, const std::vector<model::Game*>& games) const
+void Assets::find_assets_for(const QString& platform_name, const std::vector<model::Game*>& games, DirIndex& dir_index) const
 {
-    const HashMap<QString, model::Game*> esctitle_to_game_map = build_escaped_title_map(games);
+    std::vector<QString> escaped_titles;
+    const HashMap<QStringView, model::Game*> esctitle_to_game_map = build_escaped_title_map(games, escaped_titles);
 
     const QString images_root = m_lb_root_path % QLatin1String("Images/") % platform_name % QLatin1Char('/');
     // TODO: C++17
     for (const auto& assetdir_pair : m_dir_list) {
         const QString assetdir_path = images_root + assetdir_pair.first;
         const AssetType assetdir_type = assetdir_pair.second;
-        find_assets_in(assetdir_path, assetdir_type, esctitle_to_game_map);
+        find_assets_in(assetdir_path, assetdir_type, esctitle_to_game_map, dir_index);
     }
 
     const QString music_root = m_lb_root_path % QLatin1String("Music/") % platform_name % QLatin1Char('/');
-    find_assets_in(music_root, AssetType::MUSIC, esctitle_to_game_map);
+    find_assets_in(music_root, AssetType::MUSIC, esctitle_to_game_map, dir_index);
 
     const QString video_root = m_lb_root_path % QLatin1String("Videos/") % platform_name % QLatin1Char('/');
-    find_assets_in(video_root, AssetType::VIDEO, esctitle_to_game_map);
+    find_assets_in(video_root, AssetType::VIDEO, esctitle_to_game_map, dir_index);
 }
 
 void Assets::find_assets_in(
     const QString& asset_dir,
     const AssetType asset_type,
-    const HashMap<QString, model::Game*>& title_to_game_map) const
+    const HashMap<QStringView, model::Game*>& title_to_game_map,
+    DirIndex& dir_index) const
 {
-    constexpr auto FIND_ONLY_FILES = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto ITER_RECURSIVE = QDirIterator::Subdirectories;
-
-    QDirIterator file_it(asset_dir, FIND_ONLY_FILES, ITER_RECURSIVE);
-    while (file_it.hasNext()) {
-        QString path = file_it.next();
-
-        const QString basename = file_it.fileInfo().completeBaseName();
-        auto it = title_to_game_map.find(basename);
-        if (it != title_to_game_map.cend())
-            it->second->assetsMut().add_file(asset_type, path);
-
-        const bool has_number_suffix = rx_number_suffix.match(basename).hasMatch();
-        const QString game_title = has_number_suffix
-            ? basename.left(basename.length() - 3) // gamename "-xx" .ext
-            : basename;
-        it = title_to_game_map.find(game_title);
-        if (it != title_to_game_map.cend())
-            it->second->assetsMut().add_file(asset_type, std::move(path));
-    }
+    // NOTE: Directory listings come from the index of the search context;
+    //       symbolic links to directories are not followed
+    const auto check_files = [&](const QString& dir_path, const DirIndex::Listing& listing){
+        // NOTE: the names are only looked up as views, the path is built on a match
+        for (const QString& name : listing.files) {
+            const QStringView basename = ::complete_basename(name);
+            auto it = title_to_game_map.find(basename);
+            if (it != title_to_game_map.cend())
+                it->second->assetsMut().add_file(asset_type, ::join_path(dir_path, name));
+
+            if (!has_number_suffix(basename))
+                continue;
+
+            const QStringView game_title = basename.left(basename.size() - 3); // gamename "-xx" .ext
+            it = title_to_game_map.find(game_title);
+            if (it != title_to_game_map.cend())
+                it->second->assetsMut().add_file(asset_type, ::join_path(dir_path, name));
+        }
+    };
+    dir_index.walk(asset_dir, check_files, nullptr, DirIndex::Links::SKIP);
 }
 
 } // namespace launchbox
@@ -20,11 +20,12 @@
 #include "utils/HashMap.h"
 
 #include <QString>
-#include <QRegularExpression>
+#include <QStringView>
 #include <vector>
 
 namespace model { class Game; }
 enum class AssetType : unsigned char;
+class DirIndex;
 class QString;
 
 
@@ -35,16 +36,15 @@ class Assets {
 public:
     explicit Assets(QString, QString);
 
-    void find_assets_for(const QString&, const std::vector<model::Game*>&) const;
+    void find_assets_for(const QString&, const std::vector<model::Game*>&, DirIndex&) const;
 
 private:
     const QString m_log_tag;
     const QString m_lb_root_path;
 
     const std::vector<std::pair<QString, AssetType>> m_dir_list;
-    const QRegularExpression rx_number_suffix;
 
-    void find_assets_in(const QString&, const AssetType, const HashMap<QString, model::Game*>&) const;
+    void find_assets_in(const QString&, const AssetType, const HashMap<QStringView, model::Game*>&, DirIndex&) const;
 };
 
 } // namespace launchbox
@@ -20,6 +20,7 @@
 #include "Log.h"
 #include "Paths.h"
 #include "providers/ProviderUtils.h"
+#include "providers/SearchContext.h"
 #include "providers/launchbox/LaunchBoxAssets.h"
 #include "providers/launchbox/LaunchBoxEmulatorsXml.h"
 #include "providers/launchbox/LaunchBoxGamelistXml.h"
@@ -80,7 +81,7 @@ Provider& LaunchboxProvider::run(providers::SearchContext& sctx)
         progress += progress_step;
         emit progressChanged(progress);
 
-        assethelper.find_assets_for(platform.name, games);
+        assethelper.find_assets_for(platform.name, games, sctx.dir_index());
         progress += progress_step;
         emit progressChanged(progress);
     }
@@ -47,7 +47,7 @@ Favorites::Favorites(QObject* parent)
 {}
 
 Favorites::Favorites(QString db_path, QObject* parent)
-    : Provider(QLatin1String("pegasus_favorites"), QStringLiteral("Pegasus Favorites"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS, parent)
+    : Provider(QLatin1String("pegasus_favorites"), QStringLiteral("Pegasus Favorites"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS | PROVIDER_FLAG_NO_NEW_GAMES, parent)
     , m_db_path(std::move(db_path))
 {}
 
@@ -79,7 +79,7 @@ Provider& Favorites::run(SearchContext& sctx)
         }
 
         if (game_ptr)
-            game_ptr->setFavorite(true);
+            sctx.game_set_favorite(*game_ptr, true);
     }
 
     return *this;
@@ -94,7 +94,7 @@ void Favorites::onGameFavoriteChanged(const std::vector<model::Game*>& game_list
     m_pending_task << QStringLiteral("# List of favorites, one path per line");
     for (const model::Game* const game : game_list) {
         if (game->isFavorite()) {
-            for (const model::GameFile* const file : game->filesModel()->entries()) {
+            for (const model::GameFile* const file : game->files()) {
                 QString written_path;
                 if (!file->fileinfo().exists()) {
                     written_path = file->path();
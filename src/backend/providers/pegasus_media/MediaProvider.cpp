@@ -24,21 +24,15 @@
 #include "model/gaming/GameFile.h"
 #include "types/AssetType.h"
 #include "providers/SearchContext.h"
+#include "utils/DirIndex.h"
+#include "utils/FlatHashMap.h"
 #include "utils/PathTools.h"
 
-#include <QDir>
-#include <QDirIterator>
 #include <QFileInfo>
 #include <QStringBuilder>
 #include <QStringList>
 #include <array>
 
-#include "Log.h"
-#include "Paths.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
-#include <QStandardPaths>
 
 namespace {
 const QStringList& allowed_asset_exts(AssetType type)
@@ -60,18 +54,21 @@ const QStringList& allowed_asset_exts(AssetType type)
     }
 }
 
-AssetType detect_asset_type(const QString& basename, const QString& ext)
+AssetType detect_asset_type(QStringView basename, QStringView ext)
 {
     const AssetType type = pegasus_assets::str_to_type(basename);
-    if (allowed_asset_exts(type).contains(ext))
-        return type;
+    for (const QString& allowed_ext : allowed_asset_exts(type)) {
+        if (QStringView(allowed_ext) == ext)
+            return type;
+    }
 
     return AssetType::UNKNOWN;
 }
 
-HashMap<QString, model::Game*> create_lookup_map(const HashMap<QString, model::GameFile*>& games)
+FlatHashMap<QString, model::Game*> create_lookup_map(const FlatHashMap<QString, model::GameFile*>& games)
 {
-    HashMap<QString, model::Game*> out;
+    FlatHashMap<QString, model::Game*> out;
+    out.reserve(games.size() * 2);
 
     // TODO: C++17
     for (const auto& pair : games) {
@@ -95,16 +92,11 @@ namespace providers {
 namespace media {
 
 MediaProvider::MediaProvider(QObject* parent)
-    : Provider(QLatin1String("pegasus_media"), QStringLiteral("Pegasus Media"), parent)
-{
-    QString frontendDir = paths::writableConfigDir();  // pegasus-frontend目录
-    m_cache_path = frontendDir + "/media_cache.json";
-}
+    : Provider(QLatin1String("pegasus_media"), QStringLiteral("Pegasus Media"), PROVIDER_FLAG_NO_NEW_GAMES, parent)
+{}
 
 Provider& MediaProvider::run(SearchContext& sctx)
 {
-    constexpr auto dir_filters = QDir::Files | QDir::NoDotAndDotDot;
-    constexpr auto dir_flags = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
     /*const std::array<QLatin1String, 2> MEDIA_SUBDIRS {
         QLatin1String("/media"),
         QLatin1String("/.media"),
@@ -113,138 +105,34 @@ Provider& MediaProvider::run(SearchContext& sctx)
         QLatin1String("/media"),
     };
 
-    // 步骤1：加载缓存
-    load_cache();
+    const FlatHashMap<QString, model::Game*> lookup_map = create_lookup_map(sctx.current_filepath_to_entry_map());
 
-    // 步骤2：创建游戏查找映射（与原逻辑一致）
-    const HashMap<QString, model::Game*> lookup_map = create_lookup_map(sctx.current_filepath_to_entry_map());
-
-    // 步骤3：遍历媒体目录（优先使用缓存，仅扫描变更文件）
-    QJsonArray cached_media_dirs = m_cache_data["media_dirs"].toArray();
     for (const QString& dir_base : sctx.pegasus_game_dirs()) {
         for (const QLatin1String& media_subdir_name : MEDIA_SUBDIRS) {
             const QString media_dir = dir_base % media_subdir_name;
-            QDir dir(media_dir);
-            if (!dir.exists()) continue;
-
-            // 查找当前媒体目录的缓存记录（若存在）
-            bool dir_exists_in_cache = false;
-            QJsonObject cached_dir;
-            for (const auto& item : cached_media_dirs) {
-                QJsonObject obj = item.toObject();
-                if (obj["dir_path"].toString() == media_dir) {
-                    cached_dir = obj;
-                    dir_exists_in_cache = true;
-                    break;
-                }
-            }
-
-            // 步骤3.1：使用缓存中的有效文件
-            if (dir_exists_in_cache){
-                QJsonArray cached_files = cached_dir["files"].toArray();
-                for (const auto& item : cached_files) {
-                    QJsonObject cached_file = item.toObject();
-                    QString file_path = cached_file["file_path"].toString();
-                    //QFileInfo fileinfo(file_path);
-
-                    // 检查文件是否存在且未变更
-                    //if (!fileinfo.exists() || !is_file_unchanged(fileinfo, cached_file))
-                    //    continue;
-
-                    // 查找关联的游戏（与原逻辑一致）
-                    const QString lookup_key = cached_file["game_key"].toString();
-                    const auto lookup_it = lookup_map.find(lookup_key);
-                    if (lookup_it == lookup_map.cend())
-                        continue;
 
-                    // 直接使用缓存的asset_type关联资产
-                    AssetType asset_type = pegasus_assets::str_to_type(cached_file["asset_type"].toString());
-                    lookup_it->second->assetsMut().add_file(asset_type, file_path);
-                }
-                continue;
-            }
-
-            // 步骤3.2：扫描未缓存或变更的文件（原逻辑优化）
-            QDirIterator dir_it(media_dir, dir_filters, dir_flags);
-            QJsonArray new_cached_files;
-            while (dir_it.hasNext()) {
-                dir_it.next();
-                const QFileInfo fileinfo = dir_it.fileInfo();
-                const QString file_path = dir_it.filePath();
-
-                // 原逻辑：检测文件类型并关联游戏
-                const QString lookup_key = ::clean_abs_dir(fileinfo).remove(dir_base.length(), media_subdir_name.size());
+            // NOTE: The listings come from the directory index of the search context,
+            //       which is stored between runs and checks every directory by its
+            //       modification time, so unchanged media directories are not read again
+            //       and removed files disappear as soon as their directory changes
+            sctx.dir_index().walk(media_dir, [&](const QString& dir_path, const DirIndex::Listing& listing){
+                const QString lookup_key = QString(dir_path).remove(dir_base.length(), media_subdir_name.size());
                 const auto lookup_it = lookup_map.find(lookup_key);
                 if (lookup_it == lookup_map.cend())
-                    continue;
-
-                const AssetType asset_type = detect_asset_type(fileinfo.completeBaseName(), fileinfo.suffix());
-                if (asset_type == AssetType::UNKNOWN)
-                    continue;
-
-                lookup_it->second->assetsMut().add_file(asset_type, file_path);
-
-                QJsonObject new_cached_file{
-                    {"file_path", file_path},
-                    {"asset_type", pegasus_assets::type_to_str(asset_type)},
-                    {"mtime", fileinfo.lastModified().toSecsSinceEpoch()},
-                    {"size", fileinfo.size()},
-                    {"game_key", lookup_key}
-                };
-                new_cached_files.append(new_cached_file);
-            }
-
-            // 步骤3.3：更新缓存目录记录（优化逻辑）
-            QJsonObject new_dir{
-                {"dir_path", media_dir},
-                {"last_scan_time", QDateTime::currentDateTime().toString(Qt::ISODate)},
-                {"files", new_cached_files}
-            };
-            cached_media_dirs.append(new_dir);
-        }
-    }
-
-    // 步骤4：保存更新后的缓存
-    m_cache_data["media_dirs"] = cached_media_dirs;
-    save_cache();
-
-    return *this;
-}
-
-void MediaProvider::load_cache()
-{
-    QFile file(m_cache_path);
-    if (!file.open(QIODevice::ReadOnly)) {
-        Log::info(LOGMSG("No existing media cache found, will create a new one."));
-        m_cache_data = QJsonObject{{"version", "1.0"}, {"media_dirs", QJsonArray{}}};
-        return;
-    }
+                    return;
 
-    QByteArray data = file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data);
-    if (doc.isNull()) {
-        Log::warning(LOGMSG("Invalid media cache format, will reset."));
-        m_cache_data = QJsonObject{{"version", "1.0"}, {"media_dirs", QJsonArray{}}};
-        return;
-    }
+                for (const QString& name : listing.files) {
+                    const AssetType asset_type = detect_asset_type(::complete_basename(name), ::file_suffix(name));
+                    if (asset_type == AssetType::UNKNOWN)
+                        continue;
 
-    m_cache_data = doc.object();
-    // 检查缓存版本，若不匹配则重置（示例：仅支持1.0）
-    if (m_cache_data["version"].toString() != "1.0") {
-        Log::info(LOGMSG("Cache version mismatch, resetting."));
-        m_cache_data = QJsonObject{{"version", "1.0"}, {"media_dirs", QJsonArray{}}};
+                    sctx.game_add_asset_file(*lookup_it->second, asset_type, dir_path % QLatin1Char('/') % name);
+                }
+            });
+        }
     }
-}
 
-void MediaProvider::save_cache()
-{
-    QJsonDocument doc(m_cache_data);
-    QFile file(m_cache_path);
-    if (!file.open(QIODevice::WriteOnly)) {
-        Log::warning(LOGMSG("Failed to save media cache to %1").arg(m_cache_path));
-        return;
-    }
-    file.write(doc.toJson());
+    return *this;
 }
 
 } // namespace media
@@ -21,33 +21,17 @@
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
 #include "providers/SearchContext.h"
+#include "utils/DirIndex.h"
+#include "utils/ExistenceCache.h"
+#include "utils/HashMap.h"
 #include "utils/PathTools.h"
 #include "utils/StdHelpers.h"
 
-#include <QDirIterator>
+#include <QDir>
+#include <unordered_set>
 
 
 namespace {
-// Find all dirs and subdirectories, but ignore 'media'
-std::vector<QString> all_valid_direct_subdirs(const QString& filter_dir)
-{
-    Q_ASSERT(!filter_dir.isEmpty());
-
-    constexpr auto subdir_filters = QDir::Dirs | QDir::NoDotAndDotDot;
-    constexpr auto subdir_flags = QDirIterator::FollowSymlinks;
-
-    std::vector<QString> result;
-
-    QDirIterator dirs_it(filter_dir, subdir_filters, subdir_flags);
-    while (dirs_it.hasNext())
-        result.emplace_back(dirs_it.next());
-
-    const QString media_dir = filter_dir + QStringLiteral("/media");
-    VEC_REMOVE_VALUE(result, media_dir);
-
-    return result;
-}
-
 std::vector<QString> resolve_filelist(const std::vector<QString>& relpaths, const std::vector<QString>& dirs)
 {
     std::vector<QString> found_paths;
@@ -67,30 +51,93 @@ std::vector<QString> resolve_filelist(const std::vector<QString>& relpaths, cons
     return found_paths;
 }
 
-bool rx_match(const QRegularExpression& rx, const QString& str) {
-    return !rx.pattern().isEmpty() && rx.match(str).hasMatch();
+struct ExtensionLess {
+    bool operator()(QStringView a, QStringView b) const {
+        return a.compare(b, Qt::CaseInsensitive) < 0;
+    }
+};
+
+std::vector<QString> sorted_extensions(const std::vector<QString>& exts)
+{
+    std::vector<QString> out(exts);
+    std::sort(out.begin(), out.end(), ExtensionLess());
+    return out;
 }
 
-bool file_passes_filter(
-    const QFileInfo& finfo,
-    const providers::pegasus::FileFilter& filter,
-    const std::vector<QString>& exclude_files)
+bool has_extension(const std::vector<QString>& sorted_exts, QStringView ext)
 {
-    const QString file_ext = finfo.suffix().toLower();
+    return std::binary_search(sorted_exts.cbegin(), sorted_exts.cend(), ext, ExtensionLess());
+}
 
-    const bool exclude = VEC_CONTAINS(filter.exclude.extensions, file_ext)
-        || VEC_CONTAINS(exclude_files, ::clean_abs_path(finfo))
-        || rx_match(filter.exclude.regex, finfo.filePath());
-    if (exclude)
-        return false;
+QRegularExpression prepare_regex(const QRegularExpression& rx)
+{
+    QRegularExpression out(rx);
+    if (!out.pattern().isEmpty() && out.isValid())
+        out.optimize();
+    return out;
+}
 
-    const bool include = VEC_CONTAINS(filter.include.extensions, file_ext)
-        || rx_match(filter.include.regex, finfo.filePath());
-    if (!include)
-        return false;
 
-    return true;
-}
+/// A file filter prepared for checking many files
+///
+/// The extensions are looked up in sorted tables and the excluded files in
+/// a hash set. The regular expressions are compiled only once, and only
+/// evaluated for the files that pass all the cheaper checks.
+class CompiledFilter {
+public:
+    explicit CompiledFilter(const providers::pegasus::FileFilter& filter, const std::vector<QString>& exclude_files)
+        : m_include_exts(sorted_extensions(filter.include.extensions))
+        , m_exclude_exts(sorted_extensions(filter.exclude.extensions))
+        , m_exclude_files(exclude_files.cbegin(), exclude_files.cend())
+        , m_include_rx(prepare_regex(filter.include.regex))
+        , m_exclude_rx(prepare_regex(filter.exclude.regex))
+        , m_use_include_rx(!m_include_rx.pattern().isEmpty() && m_include_rx.isValid())
+        , m_use_exclude_rx(!m_exclude_rx.pattern().isEmpty() && m_exclude_rx.isValid())
+    {}
+
+    bool needs_scan() const {
+        return !m_include_exts.empty() || m_use_include_rx;
+    }
+    bool is_excluded_file(const QString& path) const {
+        return m_exclude_files.count(path) != 0;
+    }
+
+    // the path is clean and absolute, and ends with the name
+    bool matches(const QString& path, const QString& name) const
+    {
+        const QStringView ext = ::file_suffix(name);
+
+        const bool ext_included = has_extension(m_include_exts, ext);
+        if (!ext_included && !m_use_include_rx)
+            return false;
+
+        const bool excluded = has_extension(m_exclude_exts, ext)
+            || is_excluded_file(path)
+            || (m_use_exclude_rx && m_exclude_rx.match(path).hasMatch());
+        if (excluded)
+            return false;
+
+        return ext_included || m_include_rx.match(path).hasMatch();
+    }
+
+private:
+    const std::vector<QString> m_include_exts;
+    const std::vector<QString> m_exclude_exts;
+    const std::unordered_set<QString> m_exclude_files;
+    const QRegularExpression m_include_rx;
+    const QRegularExpression m_exclude_rx;
+    const bool m_use_include_rx;
+    const bool m_use_exclude_rx;
+};
+
+
+struct FilterJob {
+    providers::pegasus::FileFilter* filter;
+    std::vector<QString> include_files;
+    CompiledFilter matcher;
+    // the files found by scanning, per directory of the filter
+    std::vector<std::vector<QString>> found_files;
+};
 
 void accept_filtered_file(
     const QString& filepath,
@@ -122,57 +169,116 @@ FileFilter::FileFilter(model::Collection* const collection_ptr, QString base_dir
     Q_ASSERT(!directories.front().isEmpty());
 }
 
-void apply_filter(FileFilter& filter, SearchContext& sctx)
+// NOTE: The directories are walked only once, even if multiple filters use them,
+//       but the results are applied in the order of the filters, as if they
+//       were applied one by one (eg. the first matching collection creates the game)
+void apply_filters(std::vector<FileFilter>& filters, ExistenceCache& existence, SearchContext& sctx)
 {
-    VEC_REMOVE_DUPLICATES(filter.directories);
-    VEC_REMOVE_DUPLICATES(filter.include.extensions);
-    VEC_REMOVE_DUPLICATES(filter.include.files);
-    VEC_REMOVE_DUPLICATES(filter.exclude.extensions);
-    VEC_REMOVE_DUPLICATES(filter.exclude.files);
-
-    Q_ASSERT(filter.collection);
-    model::Collection& collection = *filter.collection;
-
-    const std::vector<QString> include_files = resolve_filelist(filter.include.files, filter.directories);
-    const std::vector<QString> exclude_files = resolve_filelist(filter.exclude.files, filter.directories);
-    for (const QString& filepath: include_files) {
-        if (VEC_CONTAINS(exclude_files, filepath))
-            continue;
-        if (AppSettings::general.verify_files && !AppSettings::general.show_missing_games && !QFileInfo::exists(filepath))
+    std::vector<FilterJob> jobs;
+    jobs.reserve(filters.size());
+
+    for (FileFilter& filter : filters) {
+        Q_ASSERT(filter.collection);
+
+        for (QString& dir_path : filter.directories)
+            dir_path = QDir::cleanPath(dir_path);
+
+        VEC_REMOVE_DUPLICATES(filter.directories);
+        VEC_REMOVE_DUPLICATES(filter.include.extensions);
+        VEC_REMOVE_DUPLICATES(filter.include.files);
+        VEC_REMOVE_DUPLICATES(filter.exclude.extensions);
+        VEC_REMOVE_DUPLICATES(filter.exclude.files);
+
+        std::vector<QString> include_files = resolve_filelist(filter.include.files, filter.directories);
+        const std::vector<QString> exclude_files = resolve_filelist(filter.exclude.files, filter.directories);
+
+        jobs.push_back(FilterJob {
+            &filter,
+            std::move(include_files),
+            CompiledFilter(filter, exclude_files),
+            std::vector<std::vector<QString>>(filter.directories.size()),
+        });
+    }
+
+
+    const bool check_includes = AppSettings::general.verify_files && !AppSettings::general.show_missing_games;
+    if (check_includes) {
+        for (const FilterJob& job : jobs) {
+            for (const QString& filepath : job.include_files)
+                existence.add(filepath);
+        }
+        existence.resolve();
+    }
+
+
+    // The filters to check for every directory, in the order of first use
+    using Target = std::pair<const FilterJob*, std::vector<QString>*>;
+    std::vector<QString> scan_dirs;
+    HashMap<QString, std::vector<Target>> scan_targets;
+    for (FilterJob& job : jobs) {
+        if (!job.matcher.needs_scan())
             continue;
-        accept_filtered_file(filepath, collection, sctx);
+
+        for (size_t i = 0; i < job.filter->directories.size(); i++) {
+            const QString& dir_path = job.filter->directories[i];
+            Q_ASSERT(!dir_path.isEmpty());
+
+            std::vector<Target>& targets = scan_targets[dir_path];
+            if (targets.empty())
+                scan_dirs.emplace_back(dir_path);
+            targets.emplace_back(&job, &job.found_files[i]);
+        }
     }
 
-    const bool has_valid_regex = !filter.include.regex.pattern().isEmpty() && filter.include.regex.isValid();
-    const bool needs_scan = !filter.include.extensions.empty() || has_valid_regex;
-    if (!needs_scan)
-        return;
+    // NOTE: Directory listings come from the index of the search context,
+    //       so unchanged directories are not read again on a rescan
+    DirIndex& dir_index = sctx.dir_index();
+    for (const QString& scan_dir : scan_dirs) {
+        const std::vector<Target>& targets = scan_targets.at(scan_dir);
+
+        const auto check_entry = [&targets](const QString& dir_path, const QString& name){
+            const QString path = ::join_path(dir_path, name);
+            for (const Target& target : targets) {
+                if (target.first->matcher.matches(path, name))
+                    target.second->emplace_back(path);
+            }
+        };
+        const auto check_all_entries = [&check_entry](const QString& dir_path, const DirIndex::Listing& listing){
+            for (const QString& name : listing.files)
+                check_entry(dir_path, name);
+            for (const QString& name : listing.dirs)
+                check_entry(dir_path, name);
+        };
 
-    constexpr auto entry_filters_files = QDir::Files | QDir::NoDotAndDotDot;
-    constexpr auto entry_filters_all = QDir::Dirs | entry_filters_files;
-    constexpr auto entry_flags = QDirIterator::FollowSymlinks | QDirIterator::Subdirectories;
-    for (const QString& filter_dir : filter.directories) {
-        Q_ASSERT(!filter_dir.isEmpty());
+        const DirIndex::Listing listing = dir_index.list(scan_dir);
 
         // directly contained files
-        QDirIterator file_it(filter_dir, entry_filters_files);
-        while (file_it.hasNext()) {
-            file_it.next();
-            const QString path = ::clean_abs_path(file_it.fileInfo());
-            if (file_passes_filter(file_it.fileInfo(), filter, exclude_files))
-                accept_filtered_file(path, collection, sctx);
+        for (const QString& name : listing.files)
+            check_entry(scan_dir, name);
+
+        // directly contained directories (recursively), except media
+        for (const QString& name : listing.dirs) {
+            if (name != QLatin1String("media"))
+                dir_index.walk(::join_path(scan_dir, name), check_all_entries);
+        }
+    }
+
+
+    for (const FilterJob& job : jobs) {
+        model::Collection& collection = *job.filter->collection;
+
+        sctx.reserve_games(job.include_files.size());
+        for (const QString& filepath : job.include_files) {
+            if (job.matcher.is_excluded_file(filepath))
+                continue;
+            if (check_includes && !existence.exists(filepath))
+                continue;
+            accept_filtered_file(filepath, collection, sctx);
         }
 
-        // directly contained directories, except media
-        const std::vector<QString> dirs_to_check = all_valid_direct_subdirs(filter_dir);
-        for (const QString& subdir : dirs_to_check) {
-            QDirIterator subdir_it(subdir, entry_filters_all, entry_flags);
-            while (subdir_it.hasNext()) {
-                subdir_it.next();
-                const QString path = ::clean_abs_path(subdir_it.fileInfo());
-                if (file_passes_filter(subdir_it.fileInfo(), filter, exclude_files))
-                    accept_filtered_file(path, collection, sctx);
-            }
+        for (const std::vector<QString>& found_files : job.found_files) {
+            for (const QString& filepath : found_files)
+                accept_filtered_file(filepath, collection, sctx);
         }
     }
 }
@@ -24,6 +24,7 @@
 
 namespace model { class Collection; }
 namespace providers { class SearchContext; }
+class ExistenceCache;
 
 
 namespace providers {
@@ -49,7 +50,8 @@ struct FileFilter {
     MOVE_ONLY(FileFilter)
 };
 
-void apply_filter(FileFilter&, SearchContext&);
+// finds the files of the collections, walking every directory only once
+void apply_filters(std::vector<FileFilter>&, ExistenceCache&, SearchContext&);
 
 } // namespace pegasus
 } // namespace providers
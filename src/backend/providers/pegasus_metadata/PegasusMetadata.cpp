@@ -27,10 +27,9 @@
 #include "providers/SearchContext.h"
 #include "providers/pegasus_metadata/PegasusFilter.h"
 #include "types/AssetType.h"
+#include "utils/ExistenceCache.h"
 #include "utils/PathTools.h"
 
-#include <QUrl>
-
 
 namespace {
 constexpr size_t ISSUE_LOG_LIMIT = 100;
@@ -49,9 +48,10 @@ QStringList tokenize_by_comma(const QString& str)
 namespace providers {
 namespace pegasus {
 
-ParserState::ParserState(const QString& path_ref)
+ParserState::ParserState(const QString& path_ref, const ExistenceCache& existence_ref)
     : path(path_ref)
     , dir(QFileInfo(path_ref).absoluteDir())
+    , existence(existence_ref)
 {}
 
 
@@ -202,8 +202,31 @@ void Metadata::replace_newlines(QString& text) const
         .replace(QLatin1String(R"(\\n)"), QLatin1String(R"(\n)"));  // '\\n' -> '\n'
 }
 
-void Metadata::apply_collection_entry(ParserState& ps, const metafile::Entry& entry) const
+bool Metadata::is_file_entry(const metafile::Entry& entry, bool in_game) const
 {
+    if (in_game) {
+        const auto attrib_it = m_game_attribs.find(entry.key);
+        return attrib_it != m_game_attribs.cend() && attrib_it->second == GameAttrib::FILES;
+    }
+
+    const auto attrib_it = m_coll_attribs.find(entry.key);
+    return attrib_it != m_coll_attribs.cend() && attrib_it->second == CollAttrib::DIRECTORIES;
+}
+
+bool Metadata::is_asset_entry(const metafile::Entry& entry) const
+{
+    return rx_asset_key.match(entry.key).hasMatch();
+}
+
+bool Metadata::is_remote_asset(const QString& value) const
+{
+    return value.startsWith(QLatin1String("http://")) || value.startsWith(QLatin1String("https://"));
+}
+
+void Metadata::apply_collection_entry(ParserState& ps, const MetaRecord& record) const
+{
+    const metafile::Entry& entry = record.entry;
+
     Q_ASSERT(ps.cur_coll);
     Q_ASSERT(!ps.filters.empty());
     Q_ASSERT(!ps.cur_game);
@@ -230,8 +253,8 @@ void Metadata::apply_collection_entry(ParserState& ps, const metafile::Entry& en
             ps.cur_coll->setCommonLaunchWorkdir(first_line_of(ps, entry));
             break;
         case CollAttrib::DIRECTORIES:
-            for (const QString& line : entry.values) {
-                const QFileInfo finfo(ps.dir, line);
+            Q_ASSERT(record.file_infos.size() == entry.values.size());
+            for (const QFileInfo& finfo : record.file_infos) {
                 if (!finfo.isDir()) {
                     print_warning(ps, entry, LOGMSG("Directory path `%1` doesn't seem to exist").arg(::pretty_path(finfo)));
                     continue;
@@ -285,8 +308,10 @@ void Metadata::apply_collection_entry(ParserState& ps, const metafile::Entry& en
     }
 }
 
-void Metadata::apply_game_entry(ParserState& ps, const metafile::Entry& entry, SearchContext& sctx) const
+void Metadata::apply_game_entry(ParserState& ps, const MetaRecord& record, SearchContext& sctx) const
 {
+    const metafile::Entry& entry = record.entry;
+
     // NOTE: m_cur_coll may be null when the entry is defined before any collection
     Q_ASSERT(ps.cur_game);
 
@@ -298,7 +323,9 @@ void Metadata::apply_game_entry(ParserState& ps, const metafile::Entry& entry, S
 
     switch (attrib_it->second) {
         case GameAttrib::FILES:
-            for (const QString& line : entry.values) {
+            Q_ASSERT(record.file_infos.size() == entry.values.size());
+            for (size_t i = 0; i < entry.values.size(); i++) {
+                const QString& line = entry.values[i];
                 const bool is_uri = rx_uri.match(line).hasMatch();
                 if (is_uri) {
                     model::Game* const game_ptr = sctx.game_by_uri(line);
@@ -315,15 +342,15 @@ void Metadata::apply_game_entry(ParserState& ps, const metafile::Entry& entry, S
                     sctx.game_add_uri(*ps.cur_game, line);
                 }
                 else {
-                    QFileInfo finfo(ps.dir, line);
-                    if (AppSettings::general.verify_files && !finfo.exists()) {
+                    const QFileInfo& finfo = record.file_infos[i];
+                    QString path = ::clean_abs_path(finfo);
+                    if (AppSettings::general.verify_files && !ps.existence.exists(path)) {
                         print_warning(ps, entry, LOGMSG("Game file `%1` doesn't seem to exist").arg(::pretty_path(finfo)));
                         ps.cur_game->setMissing(true);
                         if (!AppSettings::general.show_missing_games)
                             continue;
                     }
 
-                    QString path = ::clean_abs_path(finfo);
                     model::Game* const game_ptr = sctx.game_by_filepath(path);
                     if (game_ptr == ps.cur_game) {
                         print_warning(ps, entry, LOGMSG("Duplicate file entry detected: `%1`").arg(line));
@@ -457,25 +484,23 @@ bool Metadata::apply_extra_entry_maybe(ParserState& ps, const metafile::Entry& e
 }
 
 
-QString Metadata::assetline_to_url(ParserState& ps, const metafile::Entry& entry, const QString& value) const
+QString Metadata::assetline_to_path(ParserState& ps, const metafile::Entry& entry, const QFileInfo& finfo) const
 {
-    Q_ASSERT(!value.isEmpty());
+    QString path = ::clean_abs_path(finfo);
 
-    if (value.startsWith(QLatin1String("http://")) || value.startsWith(QLatin1String("https://")))
-        return value;
-
-    const QFileInfo finfo(ps.dir, value);
-    if (AppSettings::general.verify_files && !finfo.exists()) {
+    if (AppSettings::general.verify_files && !ps.existence.exists(path)) {
         print_warning(ps, entry, LOGMSG("Asset file `%1` doesn't seem to exist").arg(finfo.absoluteFilePath()));
         return QString();
     }
 
-    return QUrl::fromLocalFile(finfo.absoluteFilePath()).toString();
+    return path;
 }
 
 // Returns true if the entry is an asset entry
-bool Metadata::apply_asset_entry_maybe(ParserState& ps, const metafile::Entry& entry) const
+bool Metadata::apply_asset_entry_maybe(ParserState& ps, const MetaRecord& record) const
 {
+    const metafile::Entry& entry = record.entry;
+
     Q_ASSERT(ps.cur_coll || ps.cur_game);
 
     const auto rx_match = rx_asset_key.match(entry.key);
@@ -489,17 +514,29 @@ bool Metadata::apply_asset_entry_maybe(ParserState& ps, const metafile::Entry& e
         return true;
     }
 
-    model::Assets& assets = ps.cur_game
+    model::AssetLists& assets = ps.cur_game
         ? ps.cur_game->assetsMut()
         : ps.cur_coll->assetsMut();
-    for (const QString& line : entry.values)
-        assets.add_uri(asset_type, assetline_to_url(ps, entry, line));
+    Q_ASSERT(record.file_infos.size() == entry.values.size());
+    for (size_t i = 0; i < entry.values.size(); i++) {
+        const QString& value = entry.values[i];
+        Q_ASSERT(!value.isEmpty());
+
+        // NOTE: local files are stored by their path, the same way as the files
+        //       found by the other providers, so the same image is kept only once
+        if (is_remote_asset(value))
+            assets.add_uri(asset_type, value);
+        else
+            assets.add_file(asset_type, assetline_to_path(ps, entry, record.file_infos[i]));
+    }
 
     return true;
 }
 
-void Metadata::apply_entry(ParserState& ps, const metafile::Entry& entry, SearchContext& sctx) const
+void Metadata::apply_entry(ParserState& ps, const MetaRecord& record, SearchContext& sctx) const
 {
+    const metafile::Entry& entry = record.entry;
+
     Q_ASSERT(!entry.key.isEmpty());
     Q_ASSERT(!entry.values.empty());
     Q_ASSERT(!entry.values.front().isEmpty());
@@ -537,29 +574,85 @@ void Metadata::apply_entry(ParserState& ps, const metafile::Entry& entry, Search
 
     if (apply_extra_entry_maybe(ps, entry))
         return;
-    if (apply_asset_entry_maybe(ps, entry))
+    if (apply_asset_entry_maybe(ps, record))
         return;
 
     if (ps.cur_game)
-        apply_game_entry(ps, entry, sctx);
+        apply_game_entry(ps, record, sctx);
     else
-        apply_collection_entry(ps, entry);
+        apply_collection_entry(ps, record);
 }
 
-std::vector<FileFilter> Metadata::apply_metafile(const QString& metafile_path, SearchContext& sctx) const
+// Reads the metafile and resolves the files it refers to. As this doesn't
+// depend on the previous metafiles, it can run on any thread.
+ParsedMetafile Metadata::read_metafile(const QString& metafile_path) const
 {
-    ParserState ps(metafile_path);
+    ParsedMetafile result { metafile_path, false, {} };
+    const QDir dir = QFileInfo(metafile_path).absoluteDir();
+
+    // NOTE: this follows the collection and game blocks the same way `apply_entry` does
+    bool in_block = false;
+    bool in_game = false;
 
-    const auto on_error = [&](const metafile::Error& error){
-        print_error(ps, error);
+    const auto on_error = [&result](const metafile::Error& error){
+        result.records.push_back(MetaRecord { metafile::Entry { error.line, {}, {} }, {}, error.message });
     };
     const auto on_entry = [&](const metafile::Entry& entry){
-        apply_entry(ps, entry, sctx);
+        MetaRecord record { metafile::Entry { entry.line, entry.key, entry.values }, {}, {} };
+
+        if (entry.key == m_primary_key_collection) {
+            in_block = true;
+            in_game = false;
+        }
+        else if (entry.key == m_primary_key_game) {
+            in_block = true;
+            in_game = true;
+        }
+        else if (in_block) {
+            const bool is_asset = is_asset_entry(entry);
+            if (is_asset || is_file_entry(entry, in_game)) {
+                record.file_infos.reserve(entry.values.size());
+
+                // NOTE: the existence of the files is checked later, together;
+                //       directories are checked here, and cached by QFileInfo
+                for (const QString& value : entry.values) {
+                    const bool is_remote = is_asset
+                        ? is_remote_asset(value)
+                        : in_game && rx_uri.match(value).hasMatch();
+                    if (is_remote) {
+                        record.file_infos.emplace_back();
+                        continue;
+                    }
+
+                    QFileInfo finfo(dir, value);
+                    if (!is_asset && !in_game)
+                        finfo.isDir();
+                    record.file_infos.emplace_back(std::move(finfo));
+                }
+            }
+        }
+
+        result.records.push_back(std::move(record));
     };
 
-    if (!metafile::read_file(metafile_path, on_entry, on_error)) {
+    result.read_ok = metafile::read_file(metafile_path, on_entry, on_error);
+    return result;
+}
+
+std::vector<FileFilter> Metadata::apply_metafile(const ParsedMetafile& metafile, const ExistenceCache& existence, SearchContext& sctx) const
+{
+    ParserState ps(metafile.path, existence);
+
+    for (const MetaRecord& record : metafile.records) {
+        if (record.error.isEmpty())
+            apply_entry(ps, record, sctx);
+        else
+            print_error(ps, metafile::Error { record.entry.line, record.error });
+    }
+
+    if (!metafile.read_ok) {
         Log::error(m_log_tag, LOGMSG("Failed to read metadata file `%1`")
-            .arg(::pretty_path(metafile_path)));
+            .arg(::pretty_path(metafile.path)));
     }
     if (ps.found_issues > ISSUE_LOG_LIMIT) {
         Log::warning(m_log_tag, LOGMSG("%1 other issues omitted").arg(QString::number(ps.found_issues - ISSUE_LOG_LIMIT)));
@@ -17,16 +17,18 @@
 
 #pragma once
 
+#include "parsers/MetaFile.h"
 #include "utils/HashMap.h"
+#include "utils/MoveOnly.h"
 #include "utils/NoCopyNoMove.h"
 
 #include <QDir>
+#include <QFileInfo>
 #include <QString>
 #include <QRegularExpression>
 
-namespace metafile { struct Entry; }
-namespace metafile { struct Error; }
 namespace model { class Game; }
+class ExistenceCache;
 namespace model { class Collection; }
 namespace providers { class SearchContext; }
 
@@ -39,16 +41,37 @@ enum class GameAttrib : unsigned char;
 struct FileFilter;
 
 
+// A metafile entry or parsing error, together with the file system
+// information of the files it refers to (one for each value, if any)
+struct MetaRecord {
+    metafile::Entry entry;
+    std::vector<QFileInfo> file_infos;
+    QString error;
+
+    MOVE_ONLY(MetaRecord)
+};
+
+// The contents of a metafile, read independently of the other metafiles
+struct ParsedMetafile {
+    QString path;
+    bool read_ok;
+    std::vector<MetaRecord> records;
+
+    MOVE_ONLY(ParsedMetafile)
+};
+
+
 struct ParserState {
     const QString& path;
     const QDir dir;
+    const ExistenceCache& existence;
     model::Game* cur_game = nullptr;
     model::Collection* cur_coll = nullptr;
     std::vector<FileFilter> filters;
     std::vector<model::Collection*> all_colls;
     size_t found_issues = 0;
 
-    explicit ParserState(const QString&);
+    explicit ParserState(const QString&, const ExistenceCache&);
     NO_COPY_NO_MOVE(ParserState)
 };
 
@@ -57,7 +80,9 @@ class Metadata {
 public:
     explicit Metadata(QString);
 
-    std::vector<FileFilter> apply_metafile(const QString&, SearchContext&) const;
+    // thread safe, does not touch the search context
+    ParsedMetafile read_metafile(const QString&) const;
+    std::vector<FileFilter> apply_metafile(const ParsedMetafile&, const ExistenceCache&, SearchContext&) const;
 
 private:
     const QString m_log_tag;
@@ -84,13 +109,17 @@ private:
     const QString& first_line_of(ParserState&, const metafile::Entry&) const;
     void replace_newlines(QString&) const;
 
-    void apply_collection_entry(ParserState&, const metafile::Entry&) const;
-    void apply_game_entry(ParserState&, const metafile::Entry&, SearchContext&) const;
+    bool is_file_entry(const metafile::Entry&, bool in_game) const;
+    bool is_asset_entry(const metafile::Entry&) const;
+    bool is_remote_asset(const QString&) const;
+
+    void apply_collection_entry(ParserState&, const MetaRecord&) const;
+    void apply_game_entry(ParserState&, const MetaRecord&, SearchContext&) const;
     bool apply_extra_entry_maybe(ParserState&, const metafile::Entry&) const;
-    bool apply_asset_entry_maybe(ParserState&, const metafile::Entry&) const;
-    void apply_entry(ParserState&, const metafile::Entry&, SearchContext&) const;
+    bool apply_asset_entry_maybe(ParserState&, const MetaRecord&) const;
+    void apply_entry(ParserState&, const MetaRecord&, SearchContext&) const;
 
-    QString assetline_to_url(ParserState&, const metafile::Entry&, const QString&) const;
+    QString assetline_to_path(ParserState&, const metafile::Entry&, const QFileInfo&) const;
 };
 
 } // namespace pegasus
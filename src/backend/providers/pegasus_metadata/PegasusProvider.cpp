@@ -18,15 +18,18 @@
 
 #include "PegasusProvider.h"
 
+#include "AppSettings.h"
 #include "Log.h"
 #include "Paths.h"
 #include "providers/SearchContext.h"
 #include "providers/pegasus_metadata/PegasusMetadata.h"
 #include "providers/pegasus_metadata/PegasusFilter.h"
+#include "utils/ExistenceCache.h"
 #include "utils/PathTools.h"
 #include "utils/StdHelpers.h"
 
 #include <QDirIterator>
+#include <QtConcurrent/QtConcurrent>
 
 
 namespace {
@@ -78,13 +81,39 @@ Provider& PegasusProvider::run(SearchContext& sctx)
     const Metadata metahelper(display_name());
     std::vector<FileFilter> all_filters;
 
-    const float progress_step = 1.f / metafile_paths.size();
+    // Reading the metafiles is independent from each other, but the results are
+    // applied in the original order, so the reported issues are always the same
+    std::vector<ParsedMetafile> metafiles;
+    metafiles.reserve(metafile_paths.size());
+    for (const QString& path : metafile_paths)
+        metafiles.push_back(ParsedMetafile { path, false, {} });
+
+    QtConcurrent::blockingMap(metafiles, [&metahelper](ParsedMetafile& metafile){
+        metafile = metahelper.read_metafile(metafile.path);
+    });
+
+    // The files are checked together, so every directory is read only once
+    ExistenceCache existence;
+    if (AppSettings::general.verify_files) {
+        for (const ParsedMetafile& metafile : metafiles) {
+            for (const MetaRecord& record : metafile.records) {
+                for (const QFileInfo& finfo : record.file_infos) {
+                    if (!finfo.filePath().isEmpty())
+                        existence.add(::clean_abs_path(finfo));
+                }
+            }
+        }
+        existence.resolve();
+    }
+
+    const float progress_step = 1.f / metafiles.size();
     float progress = 0.f;
 
-    for (const QString& path : metafile_paths) {
-        Log::info(display_name(), LOGMSG("Found `%1`").arg(::pretty_path(path)));
+    for (const ParsedMetafile& metafile : metafiles) {
+        Log::info(display_name(), LOGMSG("Found `%1`").arg(::pretty_path(metafile.path)));
+        sctx.pegasus_add_metafile(metafile.path);
 
-        std::vector<FileFilter> filters = metahelper.apply_metafile(path, sctx);
+        std::vector<FileFilter> filters = metahelper.apply_metafile(metafile, existence, sctx);
         all_filters.insert(all_filters.end(),
             std::make_move_iterator(filters.begin()),
             std::make_move_iterator(filters.end()));
@@ -93,9 +122,8 @@ Provider& PegasusProvider::run(SearchContext& sctx)
         emit progressChanged(progress);
     }
 
+    apply_filters(all_filters, existence, sctx);
     for (FileFilter& filter : all_filters) {
-        apply_filter(filter, sctx);
-
         for (QString& dir_path : filter.directories)
             sctx.pegasus_add_game_dir(dir_path);
     }
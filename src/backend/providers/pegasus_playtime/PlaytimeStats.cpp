@@ -137,12 +137,6 @@ void save_play_entry(const QString& log_tag, const int path_id, const QDateTime&
         print_query_error(log_tag, query);
 }
 
-void update_modelgame(model::GameFile* const gamefile, const QDateTime& start_time, const qint64 duration)
-{
-    Q_ASSERT(gamefile);
-    gamefile->update_playstats(1, duration, start_time.addSecs(duration));
-}
-
 } // namespace
 
 
@@ -154,7 +148,7 @@ PlaytimeStats::PlaytimeStats(QObject* parent)
 {}
 
 PlaytimeStats::PlaytimeStats(QString db_path, QObject* parent)
-    : Provider(QLatin1String("pegasus_playtime"), QStringLiteral("Pegasus Playtime"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS, parent)
+    : Provider(QLatin1String("pegasus_playtime"), QStringLiteral("Pegasus Playtime"), PROVIDER_FLAG_INTERNAL | PROVIDER_FLAG_HIDE_PROGRESS | PROVIDER_FLAG_NO_NEW_GAMES, parent)
     , m_db_path(std::move(db_path))
 {}
 
@@ -210,11 +204,13 @@ Provider& PlaytimeStats::run(SearchContext& sctx)
 
     // trigger update only once
     // TODO: C++17
+    std::vector<model::PlaySession> sessions;
+    sessions.reserve(stat_map.size());
     for (const auto& pair : stat_map) {
-        model::GameFile* const gamefile = pair.first;
         const Stats& stats = pair.second;
-        gamefile->update_playstats(stats.playcount, stats.playtime, stats.last_played);
+        sessions.push_back({ pair.first, stats.playcount, stats.playtime, stats.last_played });
     }
+    sctx.add_play_sessions(std::move(sessions));
 
     return *this;
 }
@@ -230,15 +226,42 @@ void PlaytimeStats::onGameFinished(model::GameFile* const gamefile)
     Q_ASSERT(gamefile);
     Q_ASSERT(m_last_launch_time.isValid());
 
-    QMutexLocker lock(&m_queue_guard);
-
     const auto now = QDateTime::currentDateTimeUtc();
     const auto duration = m_last_launch_time.secsTo(now);
 
+    const Session session { gamefile, m_last_launch_time, duration };
+    if (m_hold_sessions)
+        m_held_sessions.push_back(session);
+    else
+        save_session(session);
+}
+
+void PlaytimeStats::onScanStarted()
+{
+    m_hold_sessions = true;
+}
+
+void PlaytimeStats::onScanFinished()
+{
+    m_hold_sessions = false;
+
+    for (const Session& session : m_held_sessions)
+        save_session(session);
+    m_held_sessions.clear();
+}
+
+void PlaytimeStats::save_session(const Session& session)
+{
+    // NOTE: the model objects are updated here, on their own thread;
+    //       the background task only writes the database
+    session.gamefile->update_playstats(1, session.duration, session.launch_time.addSecs(session.duration));
+
+    QMutexLocker lock(&m_queue_guard);
+
     m_pending_tasks.emplace_back(
-        gamefile,
-        m_last_launch_time,
-        duration
+        ::clean_abs_path(session.gamefile->fileinfo()),
+        session.launch_time,
+        session.duration
     );
 
     if (m_active_tasks.empty())
@@ -255,9 +278,6 @@ void PlaytimeStats::start_processing()
         emit startedWriting();
 
         while (!m_active_tasks.empty()) {
-            for (const QueueEntry& entry : m_active_tasks)
-                update_modelgame(entry.gamefile, entry.launch_time, entry.duration);
-
             SqliteDb channel(m_db_path);
             if (!channel.open()) {
                 Log::warning(display_name(), LOGMSG("Could not open or create `%1`, play time will not be saved")
@@ -273,8 +293,7 @@ void PlaytimeStats::start_processing()
             }
 
             for (const QueueEntry& entry : m_active_tasks) {
-                const QString path = ::clean_abs_path(entry.gamefile->fileinfo());
-                const int path_id = get_path_id(display_name(), path);
+                const int path_id = get_path_id(display_name(), entry.path);
                 if (path_id >= 0)
                     save_play_entry(display_name(), path_id, entry.launch_time, entry.duration);
             }
@@ -37,6 +37,8 @@ public:
 
     void onGameLaunched(model::GameFile* const) final;
     void onGameFinished(model::GameFile* const) final;
+    void onScanStarted() final;
+    void onScanFinished() final;
 
 signals:
     void startedWriting();
@@ -47,13 +49,22 @@ private:
 
     QDateTime m_last_launch_time;
 
-    struct QueueEntry {
+    // sessions that ended while a scan was running, saved after the scan
+    struct Session {
         model::GameFile* const gamefile;
         const QDateTime launch_time;
         const qint64 duration;
+    };
+    std::vector<Session> m_held_sessions;
+    bool m_hold_sessions = false;
+
+    struct QueueEntry {
+        const QString path;
+        const QDateTime launch_time;
+        const qint64 duration;
 
-        QueueEntry(model::GameFile* const gamefile, QDateTime launch_time, qint64 duration)
-            : gamefile(std::move(gamefile))
+        QueueEntry(QString path, QDateTime launch_time, qint64 duration)
+            : path(std::move(path))
             , launch_time(std::move(launch_time))
             , duration(std::move(duration))
         {}
@@ -62,6 +73,7 @@ private:
     std::vector<QueueEntry> m_active_tasks;
     QMutex m_queue_guard;
 
+    void save_session(const Session&);
     void start_processing();
 };
 
@@ -173,6 +173,7 @@ std::vector<model::Game*> PlayniteProvider::create_games(const QString& playnite
     int game_count = 0;
     float progress = 0.f;
 
+    sctx.reserve_games(components.games.size());
     for (const PlayniteGame& game_info : components.games) {
         game_count++;
         progress += progress_step;
@@ -1,10 +1,14 @@
 HEADERS += \
+    $$PWD/LibrarySnapshot.h \
+    $$PWD/LibraryWatcher.h \
     $$PWD/Provider.h \
     $$PWD/ProviderManager.h \
     $$PWD/ProviderUtils.h \
     $$PWD/SearchContext.h \
 
 SOURCES += \
+    $$PWD/LibrarySnapshot.cpp \
+    $$PWD/LibraryWatcher.cpp \
     $$PWD/Provider.cpp \
     $$PWD/ProviderManager.cpp \
     $$PWD/ProviderUtils.cpp \
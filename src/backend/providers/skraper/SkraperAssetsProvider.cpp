@@ -22,17 +22,20 @@
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
 #include "providers/SearchContext.h"
+#include "utils/DirIndex.h"
+#include "utils/FlatHashMap.h"
 #include "utils/PathTools.h"
 
-#include <QDirIterator>
+#include <QFileInfo>
 #include <QStringBuilder>
 #include <array>
 
 
 namespace {
-HashMap<QString, model::Game*> build_gamepath_db(const HashMap<QString, model::GameFile*>& filepath_to_entry_map)
+FlatHashMap<QString, model::Game*> build_gamepath_db(const FlatHashMap<QString, model::GameFile*>& filepath_to_entry_map)
 {
-    HashMap<QString, model::Game*> map;
+    FlatHashMap<QString, model::Game*> map;
+    map.reserve(filepath_to_entry_map.size());
 
     // TODO: C++17
     for (const auto& entry : filepath_to_entry_map) {
@@ -50,7 +53,7 @@ namespace providers {
 namespace skraper {
 
 SkraperAssetsProvider::SkraperAssetsProvider(QObject* parent)
-    : Provider(QLatin1String("skraper"), QStringLiteral("Skraper Assets"), parent)
+    : Provider(QLatin1String("skraper"), QStringLiteral("Skraper Assets"), PROVIDER_FLAG_NO_NEW_GAMES, parent)
 {}
 
 Provider& SkraperAssetsProvider::run(SearchContext& sctx)
@@ -106,11 +109,8 @@ Provider& SkraperAssetsProvider::run(SearchContext& sctx)
         QStringLiteral("/.media/"),
     };
 
-    constexpr auto DIR_FILTERS = QDir::Files | QDir::Readable | QDir::NoDotAndDotDot;
-    constexpr auto DIR_FLAGS = QDirIterator::Subdirectories | QDirIterator::FollowSymlinks;
-
-
-    const HashMap<QString, model::Game*> extless_path_to_game = build_gamepath_db(sctx.current_filepath_to_entry_map());
+    DirIndex& dir_index = sctx.dir_index();
+    const FlatHashMap<QString, model::Game*> extless_path_to_game = build_gamepath_db(sctx.current_filepath_to_entry_map());
 
     size_t found_assets_cnt = 0;
     for (const QString& root_dir : sctx.pegasus_game_dirs()) {
@@ -127,21 +127,20 @@ Provider& SkraperAssetsProvider::run(SearchContext& sctx)
                     const QString search_dir = game_media_dir % dir_name;
                     const int subpath_len = media_dir_subpath.length() + dir_name.length();
 
-                    QDirIterator dir_it(search_dir, DIR_FILTERS, DIR_FLAGS);
-                    while (dir_it.hasNext()) {
-                        dir_it.next();
-                        const QFileInfo finfo = dir_it.fileInfo();
-
-                        const QString game_path = ::clean_abs_dir(finfo).remove(root_dir.length(), subpath_len)
-                                                % '/' % finfo.completeBaseName();
-                        const auto it = extless_path_to_game.find(game_path);
-                        if (it == extless_path_to_game.cend())
-                            continue;
-
-                        model::Game& game = *(it->second);
-                        game.assetsMut().add_file(asset_type, dir_it.filePath());
-                        found_assets_cnt++;
-                    }
+                    // NOTE: Directory listings come from the index of the search context,
+                    //       so the media directories are read only once per scan
+                    dir_index.walk(search_dir, [&](const QString& dir_path, const DirIndex::Listing& listing){
+                        const QString game_dir = QString(dir_path).remove(root_dir.length(), subpath_len);
+                        for (const QString& name : listing.files) {
+                            const QString game_path = game_dir % '/' % ::complete_basename(name);
+                            const auto it = extless_path_to_game.find(game_path);
+                            if (it == extless_path_to_game.cend())
+                                continue;
+
+                            sctx.game_add_asset_file(*(it->second), asset_type, dir_path % '/' % name);
+                            found_assets_cnt++;
+                        }
+                    });
                 }
             }
         }
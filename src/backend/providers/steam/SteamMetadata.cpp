@@ -58,7 +58,7 @@ bool apply_json(model::Game& game, const QJsonDocument& json)
 
     // now the actual field reading
 
-    model::Assets& assets = game.assetsMut(); // FIXME: update signals
+    model::AssetLists& assets = game.assetsMut();
 
     game.setTitle(app_data[QL1("name")].toString())
         .setSummary(app_data[QL1("short_description")].toString())
@@ -146,6 +146,8 @@ bool apply_json(model::Game& game, const QJsonDocument& json)
             assets.add_uri(AssetType::VIDEO, p480_path);
     }
 
+    // the data may arrive after the game is already in use
+    game.notifyAssetsChanged();
     return true;
 }
 } // namespace
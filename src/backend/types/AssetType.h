@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 enum class AssetType : unsigned char {
     UNKNOWN,
 
@@ -44,3 +46,6 @@ enum class AssetType : unsigned char {
     TITLESCREEN,
     VIDEO,
 };
+
+// NOTE: assumes VIDEO is the last item above
+constexpr size_t ASSET_TYPE_COUNT = static_cast<size_t>(AssetType::VIDEO) + 1;
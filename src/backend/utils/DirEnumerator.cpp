@@ -0,0 +1,336 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "DirEnumerator.h"
+
+#include <QFile>
+#include <utility>
+
+#ifdef Q_OS_UNIX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#include <cstddef>
+#endif
+#else
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFileInfo>
+#endif
+
+
+namespace {
+bool is_dot_or_dotdot(const char* name)
+{
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+#ifdef Q_OS_UNIX
+DirEnumerator::EntryType type_of_mode(mode_t mode)
+{
+    if (S_ISREG(mode))
+        return DirEnumerator::EntryType::FILE;
+    if (S_ISDIR(mode))
+        return DirEnumerator::EntryType::DIRECTORY;
+    if (S_ISLNK(mode))
+        return DirEnumerator::EntryType::SYMLINK;
+    return DirEnumerator::EntryType::OTHER;
+}
+
+DirEnumerator::EntryType type_of_dtype(unsigned char d_type)
+{
+    switch (d_type) {
+        case DT_REG:
+            return DirEnumerator::EntryType::FILE;
+        case DT_DIR:
+            return DirEnumerator::EntryType::DIRECTORY;
+        case DT_LNK:
+            return DirEnumerator::EntryType::SYMLINK;
+        case DT_UNKNOWN:
+            return DirEnumerator::EntryType::UNKNOWN;
+        default:
+            return DirEnumerator::EntryType::OTHER;
+    }
+}
+
+qint64 mtime_ms_of(const struct stat& info)
+{
+#if defined(Q_OS_DARWIN)
+    return static_cast<qint64>(info.st_mtimespec.tv_sec) * 1000 + info.st_mtimespec.tv_nsec / 1000000;
+#else
+    return static_cast<qint64>(info.st_mtim.tv_sec) * 1000 + info.st_mtim.tv_nsec / 1000000;
+#endif
+}
+#endif // Q_OS_UNIX
+
+#ifdef Q_OS_LINUX
+// NOTE: glibc only provides a wrapper since 2.30, and Android might lack it too
+struct linux_dirent64 {
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[256];
+};
+
+constexpr size_t DIRENT_BUFFER_SIZE = 32 * 1024;
+#endif
+} // namespace
+
+
+#ifdef Q_OS_UNIX
+
+DirEnumerator::DirEnumerator(QString dir_path)
+    : m_dir_path(std::move(dir_path))
+{
+    const QByteArray path_raw = QFile::encodeName(m_dir_path);
+#ifdef Q_OS_LINUX
+    m_dir_fd = ::open(path_raw.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (m_dir_fd >= 0)
+        m_buffer.resize(DIRENT_BUFFER_SIZE);
+#else
+    m_dir = ::opendir(path_raw.constData());
+    if (m_dir)
+        m_dir_fd = ::dirfd(m_dir);
+#endif
+}
+
+DirEnumerator::~DirEnumerator()
+{
+#ifdef Q_OS_LINUX
+    if (m_dir_fd >= 0)
+        ::close(m_dir_fd);
+#else
+    if (m_dir)
+        ::closedir(m_dir);
+#endif
+}
+
+bool DirEnumerator::is_open() const
+{
+    return m_dir_fd >= 0;
+}
+
+bool DirEnumerator::read_entry()
+{
+#ifdef Q_OS_LINUX
+    if (m_buffer_pos >= m_buffer_len) {
+        const long read_len = ::syscall(SYS_getdents64, m_dir_fd, m_buffer.data(), m_buffer.size());
+        if (read_len <= 0)
+            return false;
+
+        m_buffer_pos = 0;
+        m_buffer_len = static_cast<size_t>(read_len);
+    }
+
+    const char* const record = m_buffer.data() + m_buffer_pos;
+    const auto* const entry = reinterpret_cast<const linux_dirent64*>(record);
+    m_buffer_pos += entry->d_reclen;
+
+    m_name = record + offsetof(linux_dirent64, d_name);
+    m_type = type_of_dtype(entry->d_type);
+    return true;
+#else
+    const struct dirent* const entry = ::readdir(m_dir);
+    if (!entry)
+        return false;
+
+    m_name = entry->d_name;
+    m_type = type_of_dtype(entry->d_type);
+    return true;
+#endif
+}
+
+bool DirEnumerator::next()
+{
+    if (!is_open())
+        return false;
+
+    do {
+        if (!read_entry()) {
+            m_name = nullptr;
+            return false;
+        }
+    } while (is_dot_or_dotdot(m_name));
+
+    m_target_type = EntryType::UNKNOWN;
+    m_stat_done = false;
+    m_size = -1;
+    m_mtime_ms = -1;
+    return true;
+}
+
+DirEnumerator::EntryType DirEnumerator::type()
+{
+    Q_ASSERT(m_name);
+
+    if (m_type == EntryType::UNKNOWN) {
+        struct stat info;
+        if (::fstatat(m_dir_fd, m_name, &info, AT_SYMLINK_NOFOLLOW) == 0)
+            m_type = type_of_mode(info.st_mode);
+    }
+    return m_type;
+}
+
+void DirEnumerator::stat_entry()
+{
+    Q_ASSERT(m_name);
+    if (m_stat_done)
+        return;
+
+    m_stat_done = true;
+
+    struct stat info;
+    if (::fstatat(m_dir_fd, m_name, &info, 0) != 0)
+        return;
+
+    m_target_type = type_of_mode(info.st_mode);
+    m_size = static_cast<qint64>(info.st_size);
+    m_mtime_ms = mtime_ms_of(info);
+}
+
+QString DirEnumerator::name() const
+{
+    Q_ASSERT(m_name);
+    return QFile::decodeName(m_name);
+}
+
+const char* DirEnumerator::raw_name() const
+{
+    Q_ASSERT(m_name);
+    return m_name;
+}
+
+bool DirEnumerator::is_hidden() const
+{
+    Q_ASSERT(m_name);
+    return m_name[0] == '.';
+}
+
+#else // Q_OS_UNIX
+
+DirEnumerator::DirEnumerator(QString dir_path)
+    : m_dir_path(std::move(dir_path))
+    , m_dir_it(new QDirIterator(m_dir_path, QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot))
+{}
+
+DirEnumerator::~DirEnumerator() = default;
+
+bool DirEnumerator::is_open() const
+{
+    return QFileInfo(m_dir_path).isDir();
+}
+
+bool DirEnumerator::next()
+{
+    if (!m_dir_it->hasNext()) {
+        m_has_entry = false;
+        m_name.clear();
+        return false;
+    }
+
+    // NOTE: The name is kept as it is, as converting it to the local 8-bit
+    //       encoding (eg. an ANSI code page on Windows) could lose characters
+    m_dir_it->next();
+    m_has_entry = true;
+    m_name = m_dir_it->fileName();
+    m_raw_name.clear();
+
+    const QFileInfo& finfo = m_dir_it->fileInfo();
+    m_type = finfo.isSymLink() ? EntryType::SYMLINK
+        : finfo.isDir() ? EntryType::DIRECTORY
+        : finfo.isFile() ? EntryType::FILE
+        : EntryType::OTHER;
+    m_target_type = EntryType::UNKNOWN;
+    m_stat_done = false;
+    m_size = -1;
+    m_mtime_ms = -1;
+    return true;
+}
+
+DirEnumerator::EntryType DirEnumerator::type()
+{
+    Q_ASSERT(m_has_entry);
+    return m_type;
+}
+
+void DirEnumerator::stat_entry()
+{
+    Q_ASSERT(m_has_entry);
+    if (m_stat_done)
+        return;
+
+    m_stat_done = true;
+
+    const QFileInfo& finfo = m_dir_it->fileInfo();
+    if (!finfo.exists())
+        return;
+
+    m_target_type = finfo.isDir() ? EntryType::DIRECTORY
+        : finfo.isFile() ? EntryType::FILE
+        : EntryType::OTHER;
+    m_size = finfo.size();
+    m_mtime_ms = finfo.lastModified().toMSecsSinceEpoch();
+}
+
+QString DirEnumerator::name() const
+{
+    Q_ASSERT(m_has_entry);
+    return m_name;
+}
+
+const char* DirEnumerator::raw_name() const
+{
+    Q_ASSERT(m_has_entry);
+    if (m_raw_name.isNull())
+        m_raw_name = QFile::encodeName(m_name);
+    return m_raw_name.constData();
+}
+
+bool DirEnumerator::is_hidden() const
+{
+    Q_ASSERT(m_has_entry);
+    return m_name.startsWith(QLatin1Char('.'));
+}
+
+#endif // Q_OS_UNIX
+
+
+DirEnumerator::EntryType DirEnumerator::target_type()
+{
+    const EntryType own_type = type();
+    if (own_type != EntryType::SYMLINK)
+        return own_type;
+
+    stat_entry();
+    return m_target_type;
+}
+
+qint64 DirEnumerator::size()
+{
+    stat_entry();
+    return m_size;
+}
+
+qint64 DirEnumerator::mtime_ms()
+{
+    stat_entry();
+    return m_mtime_ms;
+}
@@ -0,0 +1,110 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/NoCopyNoMove.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_LINUX)
+#include <dirent.h>
+#elif !defined(Q_OS_UNIX)
+class QDirIterator;
+#endif
+
+
+/// Lists the entries of a single directory with as little overhead as possible
+///
+/// On Linux the entries are read in large batches with getdents64, on other
+/// Unix systems with readdir. The type of the entries comes from the listing
+/// itself, and the entries are only stat'ed (relative to the descriptor of the
+/// directory) when their type is not reported, or when their size or
+/// modification time is requested. Other platforms use QDirIterator.
+/// The special entries '.' and '..' are skipped, and the name of the current
+/// entry is only valid until the next call of next().
+class DirEnumerator {
+public:
+    enum class EntryType : unsigned char {
+        UNKNOWN,
+        FILE,
+        DIRECTORY,
+        SYMLINK,
+        OTHER,
+    };
+
+    explicit DirEnumerator(QString dir_path);
+    ~DirEnumerator();
+    NO_COPY_NO_MOVE(DirEnumerator)
+
+    /// Returns false if the directory could not be opened
+    bool is_open() const;
+    const QString& dir_path() const { return m_dir_path; }
+
+    /// Moves to the next entry; returns false if there are no more entries
+    bool next();
+
+    /// The name of the current entry
+    QString name() const;
+    /// The name of the current entry, in the local 8-bit encoding; on non-Unix
+    /// systems this is converted from name() on request, and might be lossy
+    const char* raw_name() const;
+    /// True if the name of the current entry starts with a dot
+    bool is_hidden() const;
+
+    /// The type of the current entry, without following symbolic links
+    EntryType type();
+    /// The type of the current entry, following symbolic links
+    EntryType target_type();
+    /// The size of the current entry, or -1 on error
+    qint64 size();
+    /// The modification time of the current entry in ms since the epoch, or -1 on error
+    qint64 mtime_ms();
+
+private:
+    const QString m_dir_path;
+
+    EntryType m_type = EntryType::UNKNOWN;
+    EntryType m_target_type = EntryType::UNKNOWN;
+    bool m_stat_done = false;
+    qint64 m_size = -1;
+    qint64 m_mtime_ms = -1;
+
+#ifdef Q_OS_UNIX
+    const char* m_name = nullptr;
+    int m_dir_fd = -1;
+#ifdef Q_OS_LINUX
+    std::vector<char> m_buffer;
+    size_t m_buffer_pos = 0;
+    size_t m_buffer_len = 0;
+#else
+    DIR* m_dir = nullptr;
+#endif
+    bool read_entry();
+#else
+    std::unique_ptr<QDirIterator> m_dir_it;
+    bool m_has_entry = false;
+    QString m_name;
+    mutable QByteArray m_raw_name;
+#endif
+
+    void stat_entry();
+};
@@ -0,0 +1,398 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "DirIndex.h"
+
+#include "DirEnumerator.h"
+#include "PathTools.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+
+
+namespace {
+constexpr quint32 INDEX_MAGIC = 0x50474449; // 'PGDI'
+constexpr quint32 INDEX_VERSION = 2;
+constexpr QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+
+// The index file is a header followed by records, the later ones overriding the earlier
+constexpr quint8 RECORD_LISTING = 1;
+constexpr quint8 RECORD_REMOVED = 2;
+
+// The file is rewritten when less than this part of its records is up to date
+constexpr size_t MAX_RECORDS_PER_ENTRY = 2;
+
+// NOTE: Some file systems store the modification time with low precision
+//       (eg. 2 seconds on FAT), so a directory changed right after (or while)
+//       it was read might keep its old modification time. Such listings are
+//       not trusted, similarly to how Git handles "racily clean" files.
+constexpr qint64 MTIME_PRECISION_MS = 2000;
+
+
+// NOTE: Qt resources (eg. in the tests) are not visible to the system calls
+DirIndex::Listing read_resource_dir(const QString& dir_path)
+{
+    DirIndex::Listing listing;
+
+    QDirIterator dir_it(dir_path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+    while (dir_it.hasNext()) {
+        dir_it.next();
+        if (dir_it.fileInfo().isDir())
+            listing.dirs.append(dir_it.fileName());
+        else
+            listing.files.append(dir_it.fileName());
+    }
+
+    return listing;
+}
+
+DirIndex::Listing read_dir(const QString& dir_path)
+{
+    if (dir_path.startsWith(QLatin1Char(':')))
+        return read_resource_dir(dir_path);
+
+    DirIndex::Listing listing;
+
+    DirEnumerator dir_it(dir_path);
+    while (dir_it.next()) {
+        if (dir_it.is_hidden())
+            continue;
+
+        switch (dir_it.type()) {
+            case DirEnumerator::EntryType::FILE:
+                listing.files.append(dir_it.name());
+                break;
+            case DirEnumerator::EntryType::DIRECTORY:
+                listing.dirs.append(dir_it.name());
+                break;
+            case DirEnumerator::EntryType::SYMLINK:
+                switch (dir_it.target_type()) {
+                    case DirEnumerator::EntryType::FILE:
+                        listing.files.append(dir_it.name());
+                        break;
+                    case DirEnumerator::EntryType::DIRECTORY:
+                        listing.dirs.append(dir_it.name());
+                        listing.linked_dirs.append(listing.dirs.last());
+                        break;
+                    default:
+                        break; // broken links, links to special files
+                }
+                break;
+            default:
+                break; // devices, sockets, pipes
+        }
+    }
+
+    return listing;
+}
+
+void walk_recursive(
+    DirIndex& index,
+    const QString& dir_path,
+    QSet<QString>& visited_links,
+    const std::function<void(const QString&, const DirIndex::Listing&)>& func,
+    const std::function<bool(const QString&)>& enter_dir,
+    const DirIndex::Links links)
+{
+    const DirIndex::Listing listing = index.list(dir_path);
+    func(dir_path, listing);
+
+    for (const QString& name : listing.dirs) {
+        // NOTE: the root might end with a separator (eg. `C:/`)
+        const QString subdir_path = ::join_path(dir_path, name);
+        if (enter_dir && !enter_dir(subdir_path))
+            continue;
+
+        if (listing.linked_dirs.contains(name)) {
+            if (links == DirIndex::Links::SKIP)
+                continue;
+
+            const QString target = QFileInfo(subdir_path).canonicalFilePath();
+            if (target.isEmpty() || visited_links.contains(target))
+                continue;
+            visited_links.insert(target);
+        }
+
+        walk_recursive(index, subdir_path, visited_links, func, enter_dir, links);
+    }
+}
+} // namespace
+
+
+DirIndex::DirIndex() = default;
+
+DirIndex::Listing DirIndex::list(const QString& dir_path)
+{
+    // NOTE: Directories already checked during this run are not checked again
+    //       (unless their listing is not trusted, see above), so multiple
+    //       providers walking the same tree cost no extra I/O
+    {
+        const QMutexLocker lock(&m_lock);
+
+        const auto it = m_entries.find(dir_path);
+        if (it != m_entries.end()) {
+            Entry& entry = it->second;
+            if ((entry.used || entry.unchanged) && entry.mtime + MTIME_PRECISION_MS < entry.listed_at) {
+                entry.used = true;
+                return entry.listing;
+            }
+        }
+    }
+
+    const QDateTime mtime_dt = QFileInfo(dir_path).lastModified();
+    if (!mtime_dt.isValid())
+        return {};
+
+    const qint64 mtime = mtime_dt.toMSecsSinceEpoch();
+
+    {
+        const QMutexLocker lock(&m_lock);
+
+        const auto it = m_entries.find(dir_path);
+        if (it != m_entries.end()) {
+            Entry& entry = it->second;
+            const bool reusable = entry.mtime == mtime
+                && mtime + MTIME_PRECISION_MS < entry.listed_at;
+            if (reusable) {
+                entry.used = true;
+                return entry.listing;
+            }
+        }
+    }
+
+    Entry entry;
+    entry.mtime = mtime;
+    entry.listed_at = QDateTime::currentMSecsSinceEpoch();
+    entry.used = true;
+    entry.dirty = true;
+    entry.listing = read_dir(dir_path);
+
+    const Listing listing = entry.listing;
+
+    const QMutexLocker lock(&m_lock);
+    m_entries[dir_path] = std::move(entry);
+    return listing;
+}
+
+void DirIndex::assume_unchanged(const QStringList& dir_paths)
+{
+    const QMutexLocker lock(&m_lock);
+
+    for (const QString& dir_path : dir_paths) {
+        const auto it = m_entries.find(dir_path);
+        if (it != m_entries.end())
+            it->second.unchanged = true;
+    }
+}
+
+void DirIndex::walk(
+    const QString& root_path,
+    const std::function<void(const QString&, const Listing&)>& func,
+    const std::function<bool(const QString&)>& enter_dir,
+    const Links links)
+{
+    QSet<QString> visited_links;
+    visited_links.insert(QFileInfo(root_path).canonicalFilePath());
+    walk_recursive(*this, root_path, visited_links, func, enter_dir, links);
+}
+
+QStringList DirIndex::visited_dirs() const
+{
+    const QMutexLocker lock(&m_lock);
+
+    QStringList out;
+    for (const auto& pair : m_entries) {
+        if (pair.second.used)
+            out.append(pair.first);
+    }
+    return out;
+}
+
+bool DirIndex::load(const QString& index_path)
+{
+    QFile file(index_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(STREAM_VERSION);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION)
+        return false;
+
+    HashMap<QString, Entry> entries;
+    size_t record_count = 0;
+    qint64 valid_size = file.pos();
+
+    // NOTE: A record at the end may be incomplete if writing it was interrupted;
+    //       the records before it are still valid, and the next save overwrites it
+    while (!in.atEnd()) {
+        quint8 record_type = 0;
+        QString path;
+        in >> record_type >> path;
+
+        if (record_type == RECORD_LISTING) {
+            Entry entry;
+            quint32 child_count = 0;
+            in >> entry.mtime >> entry.listed_at >> child_count
+               >> entry.listing.files >> entry.listing.dirs >> entry.listing.linked_dirs;
+
+            const int real_count = entry.listing.files.count() + entry.listing.dirs.count();
+            if (in.status() != QDataStream::Ok || static_cast<quint32>(real_count) != child_count)
+                break;
+
+            entries[path] = std::move(entry);
+        }
+        else if (record_type == RECORD_REMOVED) {
+            if (in.status() != QDataStream::Ok)
+                break;
+
+            entries.erase(path);
+        }
+        else {
+            break;
+        }
+
+        record_count++;
+        valid_size = file.pos();
+    }
+
+    const QMutexLocker lock(&m_lock);
+    m_entries = std::move(entries);
+    m_file_path = index_path;
+    m_file_size = valid_size;
+    m_file_records = record_count;
+    return true;
+}
+
+bool DirIndex::save(const QString& index_path)
+{
+    const QMutexLocker lock(&m_lock);
+
+    // NOTE: Directories not visited during this run are dropped,
+    //       so removed game directories don't stay in the index forever
+    size_t used_count = 0;
+    size_t change_count = 0;
+    for (const auto& pair : m_entries) {
+        const Entry& entry = pair.second;
+        if (entry.used)
+            used_count++;
+        if (entry.dirty || !entry.used)
+            change_count++;
+    }
+
+    const bool appendable = index_path == m_file_path
+        && m_file_records + change_count <= std::max<size_t>(used_count, 1) * MAX_RECORDS_PER_ENTRY;
+    const bool success = appendable
+        ? append_changes(index_path)
+        : rewrite(index_path);
+    if (!success)
+        return false;
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->second.used) {
+            it->second.dirty = false;
+            ++it;
+        }
+        else {
+            it = m_entries.erase(it);
+        }
+    }
+    return true;
+}
+
+bool DirIndex::append_changes(const QString& index_path)
+{
+    QFile file(index_path);
+    if (!file.open(QIODevice::ReadWrite))
+        return false;
+    if (file.size() != m_file_size && !file.resize(m_file_size))
+        return false;
+    if (!file.seek(m_file_size))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+
+    size_t record_count = 0;
+    for (const auto& pair : m_entries) {
+        const Entry& entry = pair.second;
+        if (!entry.used) {
+            out << RECORD_REMOVED << pair.first;
+        }
+        else if (entry.dirty) {
+            const int child_count = entry.listing.files.count() + entry.listing.dirs.count();
+            out << RECORD_LISTING << pair.first
+                << entry.mtime << entry.listed_at << static_cast<quint32>(child_count)
+                << entry.listing.files << entry.listing.dirs << entry.listing.linked_dirs;
+        }
+        else {
+            continue;
+        }
+        record_count++;
+    }
+
+    if (out.status() != QDataStream::Ok || !file.flush())
+        return false;
+
+    m_file_size = file.pos();
+    m_file_records += record_count;
+    return true;
+}
+
+bool DirIndex::rewrite(const QString& index_path)
+{
+    QSaveFile file(index_path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(STREAM_VERSION);
+    out << INDEX_MAGIC << INDEX_VERSION;
+
+    size_t record_count = 0;
+    for (const auto& pair : m_entries) {
+        const Entry& entry = pair.second;
+        if (!entry.used)
+            continue;
+
+        const int child_count = entry.listing.files.count() + entry.listing.dirs.count();
+        out << RECORD_LISTING << pair.first
+            << entry.mtime << entry.listed_at << static_cast<quint32>(child_count)
+            << entry.listing.files << entry.listing.dirs << entry.listing.linked_dirs;
+        record_count++;
+    }
+
+    const qint64 file_size = file.pos();
+    if (out.status() != QDataStream::Ok || !file.commit())
+        return false;
+
+    m_file_path = index_path;
+    m_file_size = file_size;
+    m_file_records = record_count;
+    return true;
+}
@@ -0,0 +1,101 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "HashMap.h"
+#include "NoCopyNoMove.h"
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+
+/// Cached directory listings, validated by the modification time of the directories
+///
+/// The modification time of a directory changes when entries are added to,
+/// removed from or renamed in it, so as long as it stays the same, the
+/// previous listing can be reused without reading the directory again.
+/// The cache can be stored on the disk, making rescans of large, rarely
+/// changing (eg. network mounted) game directories much cheaper. The file
+/// is a log of records: saving only appends the directories that have changed
+/// since loading it, and the file is rewritten when it has grown too large.
+/// This class is thread safe.
+class DirIndex {
+public:
+    struct Listing {
+        QStringList files;
+        QStringList dirs;
+        QStringList linked_dirs; ///< the subset of `dirs` that are symbolic links
+    };
+
+    explicit DirIndex();
+    NO_COPY_NO_MOVE(DirIndex)
+
+    bool load(const QString& index_path);
+    bool save(const QString& index_path);
+
+    /// Returns the names of the (non-hidden) files and subdirectories
+    /// of the directory, reading it only if it has changed since the last call.
+    /// Within one run (ie. since the index was created or loaded), every
+    /// directory is read or validated only once.
+    Listing list(const QString& dir_path);
+
+    /// Marks the listings of the directories as up to date, so they are reused
+    /// without checking the directories again. Useful when the changes are
+    /// known from elsewhere, eg. from file system notifications.
+    void assume_unchanged(const QStringList& dir_paths);
+
+    enum class Links : unsigned char {
+        FOLLOW,
+        SKIP,
+    };
+
+    /// Calls the function for the directory and all of its subdirectories, recursively.
+    /// By default symbolic links to directories are followed, but every link target
+    /// is visited only once. If set, subdirectories for which `enter_dir` returns
+    /// false are skipped.
+    void walk(const QString& root_path,
+              const std::function<void(const QString&, const Listing&)>&,
+              const std::function<bool(const QString&)>& enter_dir = nullptr,
+              Links links = Links::FOLLOW);
+
+    /// Returns the directories listed since the index was created or loaded
+    QStringList visited_dirs() const;
+
+private:
+    struct Entry {
+        qint64 mtime = 0;
+        qint64 listed_at = 0;
+        bool used = false;
+        bool unchanged = false; ///< known to be up to date, see assume_unchanged()
+        bool dirty = false; ///< not yet in the index file
+        Listing listing;
+    };
+
+    mutable QMutex m_lock;
+    HashMap<QString, Entry> m_entries;
+
+    // the index file the entries are stored in, and its contents
+    QString m_file_path;
+    qint64 m_file_size = 0;
+    size_t m_file_records = 0;
+
+    bool append_changes(const QString& index_path);
+    bool rewrite(const QString& index_path);
+};
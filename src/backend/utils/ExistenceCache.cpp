@@ -0,0 +1,98 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "ExistenceCache.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+#include <vector>
+
+
+namespace {
+// Returns the position of the separator between the directory and the file name
+int find_last_separator(const QString& path)
+{
+    return path.lastIndexOf(QLatin1Char('/'));
+}
+
+QString dir_of(const QString& path, int sep)
+{
+    // keep the separator for root directories, eg. `/` or `C:/`
+    const bool is_root = sep == 0 || path.at(sep - 1) == QLatin1Char(':');
+    return path.left(is_root ? sep + 1 : sep);
+}
+
+QString normalized_name(QString name)
+{
+#if defined(Q_OS_WIN) || defined(Q_OS_MACOS)
+    // case insensitive file systems
+    return name.toLower();
+#else
+    return name;
+#endif
+}
+} // namespace
+
+
+ExistenceCache::ExistenceCache() = default;
+
+void ExistenceCache::add(const QString& path)
+{
+    const int sep = find_last_separator(path);
+    if (sep < 0)
+        return;
+
+    m_dirs[dir_of(path, sep)];
+}
+
+void ExistenceCache::resolve()
+{
+    std::vector<std::pair<const QString*, DirContents*>> pending;
+    for (auto& pair : m_dirs) {
+        if (!pair.second.listed)
+            pending.emplace_back(&pair.first, &pair.second);
+    }
+    if (pending.empty())
+        return;
+
+    QtConcurrent::blockingMap(pending, [](const std::pair<const QString*, DirContents*>& item){
+        // NOTE: without System, broken symlinks and Windows shortcuts are
+        //       skipped, the same way QFileInfo::exists() reports them
+        constexpr auto filters = QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot;
+        const QStringList names = QDir(*item.first).entryList(filters, QDir::NoSort);
+
+        DirContents& contents = *item.second;
+        contents.names.reserve(static_cast<size_t>(names.size()));
+        for (const QString& name : names)
+            contents.names.emplace(normalized_name(name));
+        contents.listed = true;
+    });
+}
+
+bool ExistenceCache::exists(const QString& path) const
+{
+    const int sep = find_last_separator(path);
+    if (sep < 0)
+        return QFileInfo::exists(path);
+
+    const auto it = m_dirs.find(dir_of(path, sep));
+    if (it == m_dirs.cend() || !it->second.listed)
+        return QFileInfo::exists(path);
+
+    return it->second.names.count(normalized_name(path.mid(sep + 1))) > 0;
+}
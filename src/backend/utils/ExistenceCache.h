@@ -0,0 +1,53 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "HashMap.h"
+#include "NoCopyNoMove.h"
+
+#include <QString>
+#include <unordered_set>
+
+
+/// Checks the existence of many files using directory listings
+///
+/// Checking files one by one can be slow, especially on network file systems
+/// where every check is a separate round-trip. Instead, the paths are first
+/// registered, then every directory they are in gets read only once (in
+/// parallel), and the existence of the files is answered from the listings.
+class ExistenceCache {
+public:
+    explicit ExistenceCache();
+    NO_COPY_NO_MOVE(ExistenceCache)
+
+    /// Registers a clean, absolute path to be checked later
+    void add(const QString& path);
+    /// Reads the directories of the paths registered since the last call
+    void resolve();
+    /// Returns whether the clean, absolute path exists. Paths in directories
+    /// not yet read are checked directly.
+    bool exists(const QString& path) const;
+
+private:
+    struct DirContents {
+        bool listed = false;
+        std::unordered_set<QString> names;
+    };
+
+    HashMap<QString, DirContents> m_dirs;
+};
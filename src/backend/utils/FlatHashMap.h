@@ -0,0 +1,284 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "utils/HashMap.h"
+
+#include <QtGlobal>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+
+/// A hash map with open addressing and linear probing, stored in flat arrays.
+///
+/// Compared to HashMap (std::unordered_map), there is no allocation per entry,
+/// and the full hash of every entry is stored next to it, so the probing only
+/// compares the keys when their hashes are equal. Erasing uses backward
+/// shifting, so there are no tombstones either. On the other hand
+/// - the keys and values have to be default constructible (empty slots),
+/// - inserting or erasing invalidates all iterators and references,
+/// - the keys must not be modified through the iterators.
+template <typename Key, typename Val, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class FlatHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = Val;
+    using value_type = std::pair<Key, Val>;
+    using size_type = size_t;
+
+private:
+    template <bool IsConst>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = typename std::conditional<IsConst, const value_type*, value_type*>::type;
+        using reference = typename std::conditional<IsConst, const value_type&, value_type&>::type;
+
+        Iterator() = default;
+        Iterator(const std::uint64_t* hash_it, const std::uint64_t* hash_end, pointer slot_it)
+            : m_hash_it(hash_it)
+            , m_hash_end(hash_end)
+            , m_slot_it(slot_it)
+        {
+            skip_empty();
+        }
+        // non-const to const conversion
+        template <bool OtherConst, typename = typename std::enable_if<IsConst && !OtherConst>::type>
+        Iterator(const Iterator<OtherConst>& other)
+            : m_hash_it(other.m_hash_it)
+            , m_hash_end(other.m_hash_end)
+            , m_slot_it(other.m_slot_it)
+        {}
+
+        reference operator*() const { return *m_slot_it; }
+        pointer operator->() const { return m_slot_it; }
+        Iterator& operator++() {
+            ++m_hash_it;
+            ++m_slot_it;
+            skip_empty();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+        bool operator==(const Iterator& other) const { return m_slot_it == other.m_slot_it; }
+        bool operator!=(const Iterator& other) const { return m_slot_it != other.m_slot_it; }
+
+    private:
+        friend class FlatHashMap;
+        friend class Iterator<!IsConst>;
+
+        const std::uint64_t* m_hash_it = nullptr;
+        const std::uint64_t* m_hash_end = nullptr;
+        pointer m_slot_it = nullptr;
+
+        void skip_empty() {
+            while (m_hash_it != m_hash_end && *m_hash_it == EMPTY) {
+                ++m_hash_it;
+                ++m_slot_it;
+            }
+        }
+    };
+
+public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    size_type size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_type capacity() const { return m_slots.size(); }
+
+    // makes room for `count` entries without rehashing
+    void reserve(size_type count) {
+        const size_type needed = count + count / 3 + 1;
+        size_type new_capacity = MIN_CAPACITY;
+        while (new_capacity < needed)
+            new_capacity *= 2;
+
+        if (new_capacity > m_slots.size())
+            rehash(new_capacity);
+    }
+
+    void clear() {
+        m_hashes.clear();
+        m_slots.clear();
+        m_size = 0;
+        m_shift = 64;
+    }
+
+    iterator begin() { return make_iterator(0); }
+    iterator end() { return make_iterator(m_slots.size()); }
+    const_iterator begin() const { return make_iterator(0); }
+    const_iterator end() const { return make_iterator(m_slots.size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    iterator find(const Key& key) { return make_iterator(find_index(key)); }
+    const_iterator find(const Key& key) const { return make_iterator(find_index(key)); }
+    size_type count(const Key& key) const { return find_index(key) != m_slots.size() ? 1 : 0; }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace(K&& key, V&& val) {
+        Key new_key(std::forward<K>(key));
+        const std::uint64_t hash = hash_of(new_key);
+
+        const size_type existing = find_index(new_key, hash);
+        if (existing != m_slots.size())
+            return { make_iterator(existing), false };
+
+        const size_type idx = insert_new(hash, std::move(new_key), Val(std::forward<V>(val)));
+        return { make_iterator(idx), true };
+    }
+
+    Val& operator[](const Key& key) {
+        const std::uint64_t hash = hash_of(key);
+
+        size_type idx = find_index(key, hash);
+        if (idx == m_slots.size())
+            idx = insert_new(hash, Key(key), Val());
+
+        return m_slots[idx].second;
+    }
+
+    size_type erase(const Key& key) {
+        const size_type idx = find_index(key);
+        if (idx == m_slots.size())
+            return 0;
+
+        erase_at(idx);
+        return 1;
+    }
+
+private:
+    static constexpr std::uint64_t EMPTY = 0;
+    static constexpr size_type MIN_CAPACITY = 16;
+
+    std::vector<std::uint64_t> m_hashes;
+    std::vector<value_type> m_slots;
+    size_type m_size = 0;
+    unsigned m_shift = 64;
+
+    // NOTE: The hash is spread by a Fibonacci multiplication, and the top bits
+    //       are used as the slot index. This matters for hashes that are mostly
+    //       the same in their low bits, like the ones of pointers.
+    static std::uint64_t hash_of(const Key& key) {
+        const std::uint64_t hash = static_cast<std::uint64_t>(Hash()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+        return hash | 1;  // never EMPTY
+    }
+
+    size_type mask() const { return m_slots.size() - 1; }
+    size_type home_index(std::uint64_t hash) const { return static_cast<size_type>(hash >> m_shift); }
+
+    iterator make_iterator(size_type idx) {
+        const std::uint64_t* const hashes = m_hashes.data();
+        return iterator(hashes + idx, hashes + m_hashes.size(), m_slots.data() + idx);
+    }
+    const_iterator make_iterator(size_type idx) const {
+        const std::uint64_t* const hashes = m_hashes.data();
+        return const_iterator(hashes + idx, hashes + m_hashes.size(), m_slots.data() + idx);
+    }
+
+    size_type find_index(const Key& key) const {
+        return find_index(key, hash_of(key));
+    }
+    size_type find_index(const Key& key, std::uint64_t hash) const {
+        if (m_slots.empty())
+            return m_slots.size();
+
+        // NOTE: the load factor is kept below 1, so there is always an empty slot
+        size_type idx = home_index(hash);
+        while (m_hashes[idx] != EMPTY) {
+            if (m_hashes[idx] == hash && KeyEqual()(m_slots[idx].first, key))
+                return idx;
+            idx = (idx + 1) & mask();
+        }
+        return m_slots.size();
+    }
+
+    size_type insert_new(std::uint64_t hash, Key&& key, Val&& val) {
+        // max. load factor is 3/4
+        if ((m_size + 1) * 4 > m_slots.size() * 3)
+            rehash(m_slots.empty() ? MIN_CAPACITY : m_slots.size() * 2);
+
+        const size_type idx = place(hash, value_type(std::move(key), std::move(val)));
+        m_size++;
+        return idx;
+    }
+
+    size_type place(std::uint64_t hash, value_type&& entry) {
+        size_type idx = home_index(hash);
+        while (m_hashes[idx] != EMPTY)
+            idx = (idx + 1) & mask();
+
+        m_hashes[idx] = hash;
+        m_slots[idx] = std::move(entry);
+        return idx;
+    }
+
+    void rehash(size_type new_capacity) {
+        Q_ASSERT(new_capacity >= MIN_CAPACITY);
+        Q_ASSERT((new_capacity & (new_capacity - 1)) == 0);
+
+        std::vector<std::uint64_t> old_hashes(new_capacity);  // zeroed, ie. EMPTY
+        std::vector<value_type> old_slots(new_capacity);
+        m_hashes.swap(old_hashes);
+        m_slots.swap(old_slots);
+
+        m_shift = 64;
+        for (size_type cap = new_capacity; cap > 1; cap >>= 1)
+            m_shift--;
+
+        for (size_type i = 0; i < old_slots.size(); i++) {
+            if (old_hashes[i] != EMPTY)
+                place(old_hashes[i], std::move(old_slots[i]));
+        }
+    }
+
+    // NOTE: Instead of leaving a tombstone, the following entries of the probe
+    //       sequence are moved back, if that doesn't put them before their home slot
+    void erase_at(size_type hole) {
+        size_type idx = hole;
+        while (true) {
+            idx = (idx + 1) & mask();
+            if (m_hashes[idx] == EMPTY)
+                break;
+
+            const size_type home = home_index(m_hashes[idx]);
+            const size_type dist_from_home = (idx - home) & mask();
+            const size_type dist_from_hole = (idx - hole) & mask();
+            if (dist_from_home >= dist_from_hole) {
+                m_hashes[hole] = m_hashes[idx];
+                m_slots[hole] = std::move(m_slots[idx]);
+                hole = idx;
+            }
+        }
+
+        m_hashes[hole] = EMPTY;
+        m_slots[hole] = value_type();
+        m_size--;
+    }
+};
@@ -39,6 +39,16 @@ namespace std {
             return qHash(s);
         }
     };
+    template<> struct hash<QByteArray> {
+        std::size_t operator()(const QByteArray& s) const {
+            return qHash(s);
+        }
+    };
+    template<> struct hash<QStringView> {
+        std::size_t operator()(QStringView s) const {
+            return qHash(s);
+        }
+    };
 }
 #endif
 
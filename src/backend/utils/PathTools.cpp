@@ -19,6 +19,7 @@
 
 #include <QDir>
 #include <QFileInfo>
+#include <QStringBuilder>
 
 
 QString clean_abs_path(const QFileInfo& finfo) {
@@ -40,3 +41,23 @@ QString pretty_dir(const QFileInfo& finfo) {
 QString pretty_path(const QString& path) {
     return QDir::toNativeSeparators(QDir::cleanPath(path));
 }
+
+QString join_path(const QString& dir_path, const QString& name) {
+    return dir_path.endsWith(QLatin1Char('/'))
+        ? dir_path % name
+        : dir_path % QLatin1Char('/') % name;
+}
+
+QStringView complete_basename(QStringView file_name) {
+    const auto dot_idx = file_name.lastIndexOf(QLatin1Char('.'));
+    return dot_idx < 0
+        ? file_name
+        : file_name.left(dot_idx);
+}
+
+QStringView file_suffix(QStringView file_name) {
+    const auto dot_idx = file_name.lastIndexOf(QLatin1Char('.'));
+    return dot_idx < 0
+        ? QStringView()
+        : file_name.mid(dot_idx + 1);
+}
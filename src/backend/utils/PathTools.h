@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <QStringView>
+
 class QString;
 class QFileInfo;
 
@@ -30,6 +32,15 @@ QString pretty_path(const QFileInfo&);
 QString pretty_dir(const QFileInfo&);
 /// Returns a displayable path
 QString pretty_path(const QString&);
+/// Appends the name to the directory path, with a single separator between them
+QString join_path(const QString& dir_path, const QString& name);
+
+/// Returns the part of a file name before its last dot, like QFileInfo::completeBaseName(),
+/// but without allocating
+QStringView complete_basename(QStringView file_name);
+/// Returns the part of a file name after its last dot, like QFileInfo::suffix(),
+/// but without allocating
+QStringView file_suffix(QStringView file_name);
 
 template <typename T>
 void pretty_dir(T) = delete;
@@ -0,0 +1,300 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+namespace {
+// the score of a word of the query matching a word of a document
+constexpr float EXACT_MATCH_SCORE = 1.f;
+constexpr float PREFIX_MATCH_BASE = 0.5f;
+constexpr float PREFIX_MATCH_RANGE = 0.4f;
+constexpr float FUZZY_MATCH_SCALE = 0.4f;
+
+// the minimal trigram similarity for a fuzzy match
+constexpr float FUZZY_MIN_SIMILARITY = 0.5f;
+constexpr int FUZZY_MIN_LENGTH = 3;
+constexpr int FUZZY_MAX_LENGTH = 64;
+
+
+bool is_ascii(const QString& str)
+{
+    return std::all_of(str.cbegin(), str.cend(), [](QChar ch){ return ch.unicode() < 0x80; });
+}
+
+QString normalized(const QString& text)
+{
+    if (is_ascii(text))
+        return text.toLower();
+
+    // NOTE: decomposing separates the diacritics from the base letters
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString out;
+    out.reserve(decomposed.size());
+    for (const QChar ch : decomposed) {
+        if (!ch.isMark())
+            out.append(ch);
+    }
+    return out.toCaseFolded();
+}
+
+std::vector<quint64> trigrams_of(const QString& token)
+{
+    // NOTE: the padding makes the beginning and end of the word count more
+    const QString padded = QLatin1Char(' ') + token + QLatin1Char(' ');
+
+    std::vector<quint64> trigrams;
+    trigrams.reserve(static_cast<size_t>(token.size()));
+    for (int i = 0; i + 2 < padded.size(); i++) {
+        trigrams.push_back(quint64(padded[i].unicode()) << 32
+                         | quint64(padded[i + 1].unicode()) << 16
+                         | quint64(padded[i + 2].unicode()));
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+} // namespace
+
+
+SearchIndex::SearchIndex() = default;
+
+QStringList SearchIndex::tokenize(const QString& text)
+{
+    const QString norm = normalized(text);
+
+    QStringList tokens;
+    int token_begin = -1;
+    for (int i = 0; i < norm.size(); i++) {
+        if (norm[i].isLetterOrNumber()) {
+            if (token_begin < 0)
+                token_begin = i;
+            continue;
+        }
+        if (token_begin >= 0) {
+            tokens.append(norm.mid(token_begin, i - token_begin));
+            token_begin = -1;
+        }
+    }
+    if (token_begin >= 0)
+        tokens.append(norm.mid(token_begin));
+
+    return tokens;
+}
+
+SearchIndex::TokenId SearchIndex::token_id(const QString& token)
+{
+    const auto it = m_token_ids.find(token);
+    if (it != m_token_ids.cend())
+        return it->second;
+
+    const TokenId id = static_cast<TokenId>(m_tokens.size());
+    m_tokens.emplace_back(token);
+    m_postings.emplace_back();
+    m_token_ids.emplace(token, id);
+
+    for (const quint64 trigram : trigrams_of(token))
+        m_trigram_tokens[trigram].push_back(id);
+
+    m_sorted_tokens_valid = false;
+    return id;
+}
+
+void SearchIndex::add(DocId doc, const QString& text, uint8_t weight)
+{
+    Q_ASSERT(m_doc_count == 0 || m_doc_count - 1 <= doc);
+    if (m_doc_count <= doc) {
+        m_doc_count = doc + 1;
+        m_removed.resize(m_doc_count, false);
+    }
+
+    for (const QString& token : tokenize(text)) {
+        std::vector<Posting>& postings = m_postings[token_id(token)];
+        if (!postings.empty() && postings.back().doc == doc)
+            postings.back().weight = std::max(postings.back().weight, weight);
+        else
+            postings.push_back({doc, weight});
+    }
+}
+
+void SearchIndex::remove(DocId doc)
+{
+    if (doc < m_doc_count && !m_removed[doc]) {
+        m_removed[doc] = true;
+        m_removed_count++;
+    }
+}
+
+void SearchIndex::clear()
+{
+    m_token_ids.clear();
+    m_tokens.clear();
+    m_postings.clear();
+    m_trigram_tokens.clear();
+    m_removed.clear();
+    m_removed_count = 0;
+    m_doc_count = 0;
+    m_sorted_tokens.clear();
+    m_sorted_tokens_valid = true;
+
+    m_doc_scores.clear();
+    m_word_scores.clear();
+    m_matched_words.clear();
+    m_shared_trigrams.clear();
+}
+
+const std::vector<SearchIndex::TokenId>& SearchIndex::sorted_tokens() const
+{
+    if (!m_sorted_tokens_valid) {
+        m_sorted_tokens.resize(m_tokens.size());
+        std::iota(m_sorted_tokens.begin(), m_sorted_tokens.end(), 0);
+        std::sort(m_sorted_tokens.begin(), m_sorted_tokens.end(),
+            [this](TokenId a, TokenId b){ return m_tokens[a] < m_tokens[b]; });
+        m_sorted_tokens_valid = true;
+    }
+    return m_sorted_tokens;
+}
+
+std::vector<SearchIndex::Match> SearchIndex::search(const QString& query, size_t limit) const
+{
+    const QStringList query_tokens = tokenize(query);
+    if (query_tokens.isEmpty() || m_doc_count == 0)
+        return {};
+
+    const std::vector<TokenId>& sorted = sorted_tokens();
+
+    // NOTE: a document stays a candidate only while it matches every word
+    //       of the query so far, so the later words have less to look at
+    m_doc_scores.resize(m_doc_count, 0.f);
+    m_word_scores.resize(m_doc_count, 0.f);
+    m_matched_words.resize(m_doc_count, 0);
+    m_shared_trigrams.resize(m_tokens.size(), 0);
+    std::vector<float>& doc_scores = m_doc_scores;
+    std::vector<float>& word_scores = m_word_scores;
+    std::vector<int>& matched_words = m_matched_words;
+    std::vector<uint8_t>& shared_trigrams = m_shared_trigrams;
+
+    // NOTE: the documents matching the first word are the only ones with
+    //       a state, so only those have to be reset after the search
+    std::vector<DocId> candidate_docs;
+    std::vector<DocId> touched_docs;
+    std::vector<TokenId> fuzzy_candidates;
+    const auto reset_state = [&](){
+        for (const DocId doc : candidate_docs) {
+            doc_scores[doc] = 0.f;
+            matched_words[doc] = 0;
+        }
+    };
+
+    for (int word_idx = 0; word_idx < query_tokens.size(); word_idx++) {
+        const QString& word = query_tokens[word_idx];
+        touched_docs.clear();
+
+        const auto add_matches = [&](TokenId token, float match_score){
+            for (const Posting& posting : m_postings[token]) {
+                if (matched_words[posting.doc] != word_idx)
+                    continue;
+
+                float& best = word_scores[posting.doc];
+                if (best == 0.f)
+                    touched_docs.push_back(posting.doc);
+                best = std::max(best, match_score * posting.weight);
+            }
+        };
+
+        // exact and prefix matches
+        auto it = std::lower_bound(sorted.cbegin(), sorted.cend(), word,
+            [this](TokenId token, const QString& val){ return m_tokens[token] < val; });
+        for (; it != sorted.cend() && m_tokens[*it].startsWith(word); ++it) {
+            const QString& token = m_tokens[*it];
+            const float score = token.size() == word.size()
+                ? EXACT_MATCH_SCORE
+                : PREFIX_MATCH_BASE + PREFIX_MATCH_RANGE * word.size() / token.size();
+            add_matches(*it, score);
+        }
+
+        // approximate matches
+        if (FUZZY_MIN_LENGTH <= word.size() && word.size() <= FUZZY_MAX_LENGTH) {
+            const std::vector<quint64> word_trigrams = trigrams_of(word);
+
+            fuzzy_candidates.clear();
+            for (const quint64 trigram : word_trigrams) {
+                const auto tri_it = m_trigram_tokens.find(trigram);
+                if (tri_it == m_trigram_tokens.cend())
+                    continue;
+
+                for (const TokenId token : tri_it->second) {
+                    if (shared_trigrams[token]++ == 0)
+                        fuzzy_candidates.push_back(token);
+                }
+            }
+
+            for (const TokenId token : fuzzy_candidates) {
+                const QString& token_str = m_tokens[token];
+                if (token_str.startsWith(word))
+                    continue;
+
+                // Dice coefficient, with the word lengths approximating their trigram counts
+                const float similarity = 2.f * shared_trigrams[token]
+                    / (word.size() + token_str.size());
+                if (similarity >= FUZZY_MIN_SIMILARITY)
+                    add_matches(token, FUZZY_MATCH_SCALE * similarity);
+            }
+            for (const TokenId token : fuzzy_candidates)
+                shared_trigrams[token] = 0;
+        }
+
+        if (touched_docs.empty()) {
+            reset_state();
+            return {};
+        }
+        if (word_idx == 0)
+            candidate_docs = touched_docs;
+
+        for (const DocId doc : touched_docs) {
+            doc_scores[doc] += word_scores[doc];
+            word_scores[doc] = 0.f;
+            matched_words[doc]++;
+        }
+    }
+
+    // the documents touched by the last word have matched all of them
+    std::vector<Match> matches;
+    matches.reserve(touched_docs.size());
+    for (const DocId doc : touched_docs) {
+        if (!m_removed[doc])
+            matches.push_back({doc, doc_scores[doc]});
+    }
+    reset_state();
+
+    const auto better = [](const Match& a, const Match& b){
+        return a.score > b.score || (a.score == b.score && a.doc < b.doc);
+    };
+    if (limit > 0 && limit < matches.size()) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), better);
+        matches.resize(limit);
+    }
+    else {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+    return matches;
+}
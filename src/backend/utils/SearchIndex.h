@@ -0,0 +1,93 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "HashMap.h"
+
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <vector>
+
+
+/// An inverted index for searching short texts by words
+///
+/// The texts are split to words, which are case folded and have their
+/// diacritics removed. A query matches a document if every word of the query
+/// matches a word of the document, either fully, as a prefix (for searching
+/// as you type) or approximately, by sharing most of their trigrams (for typos).
+/// The results are ranked by the quality of the matches and the weight of
+/// the texts they were found in. This class is not thread safe.
+class SearchIndex {
+public:
+    using DocId = uint32_t;
+
+    struct Match {
+        DocId doc;
+        float score;
+    };
+
+    explicit SearchIndex();
+
+    /// Adds the words of the text to the document. The texts of a document
+    /// have to be added before the ones of any later document.
+    void add(DocId, const QString& text, uint8_t weight = 1);
+    /// Excludes the document from the later search results
+    void remove(DocId);
+    void clear();
+
+    /// The number of documents removed since the last clear
+    size_t removed_count() const { return m_removed_count; }
+
+    /// Returns the matching documents, best matches first, at most `limit` of them
+    /// (0 means no limit)
+    std::vector<Match> search(const QString& query, size_t limit = 0) const;
+
+    /// Splits the text to normalized words
+    static QStringList tokenize(const QString& text);
+
+private:
+    using TokenId = uint32_t;
+
+    struct Posting {
+        DocId doc;
+        uint8_t weight;
+    };
+
+    HashMap<QString, TokenId> m_token_ids;
+    std::vector<QString> m_tokens;
+    std::vector<std::vector<Posting>> m_postings;
+    HashMap<quint64, std::vector<TokenId>> m_trigram_tokens;
+    std::vector<bool> m_removed;
+    size_t m_removed_count = 0;
+    DocId m_doc_count = 0;
+
+    // the tokens in alphabetical order, for prefix searches;
+    // updated on the next search after new tokens were added
+    mutable std::vector<TokenId> m_sorted_tokens;
+    mutable bool m_sorted_tokens_valid = true;
+
+    // buffers reused by the searches, all zero between them
+    mutable std::vector<float> m_doc_scores;
+    mutable std::vector<float> m_word_scores;
+    mutable std::vector<int> m_matched_words;
+    mutable std::vector<uint8_t> m_shared_trigrams;
+
+    TokenId token_id(const QString&);
+    const std::vector<TokenId>& sorted_tokens() const;
+};
@@ -0,0 +1,84 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SortKey.h"
+
+#include <QCollator>
+#include <QLocale>
+#include <QMutex>
+#include <atomic>
+
+
+namespace {
+// changed every time the locale is set
+std::atomic<unsigned> locale_generation { 0 };
+
+QMutex& locale_lock()
+{
+    static QMutex lock;
+    return lock;
+}
+
+QLocale& current_locale()
+{
+    static QLocale locale;
+    return locale;
+}
+
+const QCollator& thread_collator(unsigned generation)
+{
+    // NOTE: collators are not safe to use from multiple threads at once
+    static thread_local std::unique_ptr<QCollator> collator;
+    static thread_local unsigned collator_generation = 0;
+
+    if (!collator || collator_generation != generation) {
+        const QMutexLocker lock(&locale_lock());
+        collator.reset(new QCollator(current_locale()));
+        collator_generation = generation;
+    }
+    return *collator;
+}
+} // namespace
+
+
+SortKey::SortKey() = default;
+
+SortKey::SortKey(const QString& text)
+    : m_generation(locale_generation.load())
+{
+    m_key = std::make_shared<const QCollatorSortKey>(thread_collator(m_generation).sortKey(text));
+}
+
+bool SortKey::isCurrent() const
+{
+    return m_key && m_generation == locale_generation.load();
+}
+
+int SortKey::compare(const SortKey& other) const
+{
+    Q_ASSERT(isValid() && other.isValid());
+    return m_key->compare(*other.m_key);
+}
+
+void SortKey::setLocale(const QLocale& locale)
+{
+    {
+        const QMutexLocker lock(&locale_lock());
+        current_locale() = locale;
+    }
+    locale_generation++;
+}
@@ -0,0 +1,52 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <QString>
+#include <memory>
+
+class QCollatorSortKey;
+class QLocale;
+
+
+/// A precomputed, locale aware sorting key of a text
+///
+/// Comparing two keys is much cheaper than comparing the texts with
+/// QString::localeAwareCompare, as the collation work is done only once,
+/// when the key is created. Worth it for texts that are sorted many times.
+/// The keys are created with a per-thread collator of the current collation
+/// locale, and are cheap to copy. Keys created before a change of the locale
+/// are not current anymore, and should be created again.
+class SortKey {
+public:
+    explicit SortKey();
+    explicit SortKey(const QString&);
+
+    bool isValid() const { return !!m_key; }
+    /// True if the key is valid and was created with the current locale
+    bool isCurrent() const;
+    int compare(const SortKey&) const;
+    bool operator<(const SortKey& other) const { return compare(other) < 0; }
+
+    /// Sets the locale of the keys created from now on (by default, the system locale)
+    static void setLocale(const QLocale&);
+
+private:
+    std::shared_ptr<const QCollatorSortKey> m_key;
+    unsigned m_generation = 0;
+};
@@ -0,0 +1,61 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "StringPool.h"
+
+#include "StdHelpers.h"
+
+
+StringPool::StringPool() = default;
+
+StringPool::Id StringPool::intern(const QString& str)
+{
+    const auto it = m_ids.find(str);
+    if (it != m_ids.cend())
+        return it->second;
+
+    const Id id = static_cast<Id>(m_strings.size());
+    m_strings.emplace_back(str);
+    m_ids.emplace(str, id);
+    return id;
+}
+
+void StringPool::intern_list(QStringList& list)
+{
+    if (list.isEmpty())
+        return;
+
+    // NOTE: the lists are usually very short, a linear search is fine here
+    std::vector<Id> ids;
+    ids.reserve(static_cast<size_t>(list.size()));
+    for (const QString& str : qAsConst(list)) {
+        const Id id = intern(str);
+        if (!VEC_CONTAINS(ids, id))
+            ids.emplace_back(id);
+    }
+
+    if (ids.size() != static_cast<size_t>(list.size())) {
+        list.clear();
+        list.reserve(static_cast<int>(ids.size()));
+        for (const Id id : ids)
+            list.append(at(id));
+        return;
+    }
+
+    for (int i = 0; i < list.size(); i++)
+        list[i] = at(ids[static_cast<size_t>(i)]);
+}
@@ -0,0 +1,55 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "HashMap.h"
+#include "NoCopyNoMove.h"
+
+#include <QString>
+#include <QStringList>
+#include <cstdint>
+#include <vector>
+
+
+/// Stores a single copy of repeating strings
+///
+/// Texts like developer names or genres are often shared by thousands of
+/// games. Interning them makes every game refer to the same (implicitly
+/// shared) string data, and allows comparing them by a numeric id.
+/// This class is not thread safe.
+class StringPool {
+public:
+    using Id = uint32_t;
+
+    explicit StringPool();
+    NO_COPY_NO_MOVE(StringPool)
+
+    /// Returns the id of the string, adding it to the pool if necessary
+    Id intern(const QString&);
+    /// Returns the pooled string of the id
+    const QString& at(Id id) const { return m_strings[id]; }
+    size_t size() const { return m_strings.size(); }
+
+    /// Replaces the items of the list with their pooled copies,
+    /// and removes the duplicates while keeping the original order
+    void intern_list(QStringList&);
+
+private:
+    HashMap<QString, Id> m_ids;
+    std::vector<QString> m_strings;
+};
@@ -1,7 +1,11 @@
 HEADERS += \
     $$PWD/CommandTokenizer.h \
+    $$PWD/DirEnumerator.h \
+    $$PWD/DirIndex.h \
     $$PWD/DiskCachedNAM.h \
+    $$PWD/ExistenceCache.h \
     $$PWD/FakeQKeyEvent.h \
+    $$PWD/FlatHashMap.h \
     $$PWD/FolderListModel.h \
     $$PWD/HashMap.h \
     $$PWD/KeySequenceTools.h \
@@ -9,16 +13,25 @@ HEADERS += \
     $$PWD/NoCopyNoMove.h \
     $$PWD/PathTools.h \
     $$PWD/QmlHelpers.h \
+    $$PWD/SearchIndex.h \
+    $$PWD/SortKey.h \
     $$PWD/SqliteDb.h \
     $$PWD/StdHelpers.h \
+    $$PWD/StringPool.h \
     $$PWD/StringHelpers.h
 
 SOURCES += \
     $$PWD/CommandTokenizer.cpp \
+    $$PWD/DirEnumerator.cpp \
+    $$PWD/DirIndex.cpp \
     $$PWD/DiskCachedNAM.cpp \
+    $$PWD/ExistenceCache.cpp \
     $$PWD/FakeQKeyEvent.cpp \
     $$PWD/FolderListModel.cpp \
     $$PWD/KeySequenceTools.cpp \
     $$PWD/PathTools.cpp \
+    $$PWD/SearchIndex.cpp \
+    $$PWD/SortKey.cpp \
     $$PWD/SqliteDb.cpp \
+    $$PWD/StringPool.cpp \
     $$PWD/StringHelpers.cpp
@@ -17,15 +17,141 @@
 
 #include <QtTest/QtTest>
 
+#include "CliArgs.h"
 #include "model/Api.h"
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "providers/SearchContext.h"
+#include "utils/DirIndex.h"
+
+#include <QTemporaryDir>
+
+
+namespace {
+struct ScanResult {
+    std::vector<model::Collection*> collections;
+    std::vector<model::Game*> games;
+    model::GameSearchIndex search_index;
+};
+
+// a minimal game source: every file of the directory is a game
+ScanResult scan_dir(const QString& dir_path, const QString& summary = QString())
+{
+    providers::SearchContext sctx({ dir_path });
+    model::Collection& coll = *sctx.get_or_create_collection(QStringLiteral("games"));
+    for (const QString& name : sctx.dir_index().list(dir_path).files) {
+        model::Game& game = *sctx.create_game_for(coll);
+        game.setSummary(summary);
+        sctx.game_add_filepath(game, dir_path + QLatin1Char('/') + name);
+    }
+
+    ScanResult result;
+    std::tie(result.collections, result.games) = sctx.finalize();
+    result.search_index = std::move(sctx.search_index());
+    return result;
+}
+
+QStringList game_titles(const model::GameListModel& list)
+{
+    QStringList titles;
+    for (const model::Game* const game : list.entries())
+        titles.append(game->title());
+    return titles;
+}
+
+void touch(const QString& path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+}
+} // namespace
 
 
 class test_Api : public QObject {
     Q_OBJECT
 
 private slots:
+    void sync_changed_dir();
+    void sync_keeps_play_sessions();
 };
 
 
+void test_Api::sync_changed_dir()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString root = tmp_dir.path();
+    touch(root + QStringLiteral("/a.bin"));
+    touch(root + QStringLiteral("/b.bin"));
+
+    backend::CliArgs args;
+    model::ApiObject api(args);
+    {
+        ScanResult result = scan_dir(root);
+        api.setGameData(std::move(result.collections), std::move(result.games), std::move(result.search_index));
+    }
+    QCOMPARE(game_titles(*api.allGames()), QStringList({"a", "b"}));
+    const model::Game* const kept_game = api.allGames()->entries().back();
+    const model::Collection* const kept_coll = api.collections()->entries().front();
+
+    // the directory changes, and it is scanned again
+    QVERIFY(QFile::remove(root + QStringLiteral("/a.bin")));
+    touch(root + QStringLiteral("/c.bin"));
+
+    QSignalSpy spy(&api, &model::ApiObject::gamedataReady);
+    {
+        ScanResult result = scan_dir(root);
+        api.syncGameData(std::move(result.collections), std::move(result.games));
+    }
+    QCOMPARE(spy.count(), 1);
+
+    // the unchanged objects are kept
+    QCOMPARE(game_titles(*api.allGames()), QStringList({"b", "c"}));
+    QCOMPARE(api.allGames()->entries().front(), kept_game);
+    QCOMPARE(api.collections()->count(), 1);
+    QCOMPARE(api.collections()->entries().front(), kept_coll);
+    QCOMPARE(game_titles(*kept_coll->gameList()), QStringList({"b", "c"}));
+
+    model::ObjectListModel* const found = api.search(QStringLiteral("c"));
+    QCOMPARE(found->count(), 1);
+    delete found;
+}
+
+void test_Api::sync_keeps_play_sessions()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString root = tmp_dir.path();
+    touch(root + QStringLiteral("/a.bin"));
+
+    backend::CliArgs args;
+    model::ApiObject api(args);
+    {
+        ScanResult result = scan_dir(root);
+        api.setGameData(std::move(result.collections), std::move(result.games), std::move(result.search_index));
+    }
+    QCOMPARE(api.allGames()->count(), 1);
+    const model::Game* const old_game = api.allGames()->entries().front();
+
+    // a session ending during the scan, that the scan has not seen
+    const QDateTime last_played(QDate(2020, 1, 1), QTime(12, 0), Qt::UTC);
+    old_game->files().front()->update_playstats(1, 60, last_played);
+
+    // the game data has changed, so it is replaced by the new object
+    {
+        ScanResult result = scan_dir(root, QStringLiteral("new summary"));
+        api.syncGameData(std::move(result.collections), std::move(result.games));
+    }
+    QCOMPARE(api.allGames()->count(), 1);
+    const model::Game* const new_game = api.allGames()->entries().front();
+    QVERIFY(new_game != old_game);
+    QCOMPARE(new_game->summary(), QStringLiteral("new summary"));
+    QCOMPARE(new_game->files().front()->playCount(), 1);
+    QCOMPARE(new_game->files().front()->playTime(), static_cast<qint64>(60));
+    QCOMPARE(new_game->files().front()->lastPlayed(), last_played);
+}
+
+
 QTEST_MAIN(test_Api)
 #include "test_Api.moc"
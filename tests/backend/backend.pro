@@ -3,6 +3,7 @@ TEMPLATE = subdirs
 SUBDIRS += \
     api \
     configfile \
+    imggen \
     model \
     processlauncher \
     providers \
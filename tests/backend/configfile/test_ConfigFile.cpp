@@ -30,6 +30,8 @@ private slots:
     void empty();
     void datablob();
     void file();
+    void buffer();
+    void buffer_data();
 
     void merge_lines();
     void merge_lines_data();
@@ -114,6 +116,44 @@ void test_ConfigFile::file()
     QCOMPARE(m_entries.size(), expected.size());
 }
 
+void test_ConfigFile::buffer()
+{
+    QFETCH(QByteArray, contents);
+    m_entries.clear();
+
+    QTextStream stream(contents);
+    stream.setCodec("UTF-8");
+    readStream(stream);
+    const decltype(m_entries) expected = std::move(m_entries);
+    m_entries.clear();
+
+    metafile::read_buffer(contents.constData(), static_cast<size_t>(contents.size()),
+        [this](const metafile::Entry& entry){ this->onAttributeFound(entry); },
+        [this](const metafile::Error& error){ this->onError(error); });
+
+    const size_t count = std::min(m_entries.size(), expected.size());
+    for (size_t i = 0; i < count; i++) {
+        QCOMPARE(m_entries.at(i).line, expected.at(i).line);
+        QCOMPARE(m_entries.at(i).key, expected.at(i).key);
+        QCOMPARE(m_entries.at(i).values, expected.at(i).values);
+    }
+    QCOMPARE(m_entries.size(), expected.size());
+}
+
+void test_ConfigFile::buffer_data()
+{
+    QTest::addColumn<QByteArray>("contents");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("simple") << QByteArray("key: val\nkey with spaces  :  val with spaces\n");
+    QTest::newRow("no final newline") << QByteArray("key: val");
+    QTest::newRow("crlf") << QByteArray("key1: val\r\n\r\nkey2:\r\n  line1\r\n  .\r\n  line2\r\n");
+    QTest::newRow("bom") << QByteArray("\xEF\xBB\xBFkey: val\n");
+    QTest::newRow("comments") << QByteArray("# comment\nkey: val\n# comment\n  text\n");
+    QTest::newRow("case") << QByteArray("KEY: Val\nKey: Val\n");
+    QTest::newRow("unicode") << QByteArray("n\xC3\xA9v: \xC3\xA1rv\xC3\xADzt\xC5\xB1r\xC5\x91\n");
+}
+
 void test_ConfigFile::merge_lines()
 {
     QFETCH(QStringList, parts);
@@ -0,0 +1,171 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "imggen/ThumbnailProvider.h"
+
+#include <QTemporaryDir>
+
+
+namespace {
+void save_image(const QString& path, const QSize& size, const QColor& color)
+{
+    QImage image(size, QImage::Format_RGB32);
+    image.fill(color);
+    QVERIFY(image.save(path, "PNG"));
+}
+
+QStringList files_in(const QString& dir_path)
+{
+    QStringList out;
+    QDirIterator dir_it(dir_path, QDir::Files, QDirIterator::Subdirectories);
+    while (dir_it.hasNext())
+        out.append(QFileInfo(dir_it.next()).fileName());
+
+    out.sort();
+    return out;
+}
+} // namespace
+
+
+class test_ThumbnailProvider : public QObject {
+    Q_OBJECT
+
+private slots:
+    void size_bucket();
+    void size_bucket_data();
+    void cache_path();
+    void load_cached();
+    void load_small();
+    void prune_cache();
+};
+
+
+void test_ThumbnailProvider::size_bucket_data()
+{
+    QTest::addColumn<QSize>("requested");
+    QTest::addColumn<int>("bucket");
+
+    QTest::newRow("no size") << QSize() << 0;
+    QTest::newRow("smallest") << QSize(100, 50) << 128;
+    QTest::newRow("exact") << QSize(10, 128) << 128;
+    QTest::newRow("above") << QSize(129, 1) << 256;
+    QTest::newRow("one side only") << QSize(0, 300) << 512;
+    QTest::newRow("too large") << QSize(4000, 10) << 0;
+}
+
+void test_ThumbnailProvider::size_bucket()
+{
+    QFETCH(QSize, requested);
+    QFETCH(int, bucket);
+
+    QCOMPARE(ThumbnailProvider::size_bucket(requested), bucket);
+}
+
+void test_ThumbnailProvider::cache_path()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString cache_dir = tmp_dir.filePath(QStringLiteral("cache"));
+    const QString image_path = tmp_dir.filePath(QStringLiteral("image.png"));
+    const QString image_url = QUrl::fromLocalFile(image_path).toString();
+
+    QVERIFY(ThumbnailProvider::cache_path(cache_dir, image_url, 128).isEmpty());
+
+    save_image(image_path, QSize(300, 200), Qt::red);
+    const QString path = ThumbnailProvider::cache_path(cache_dir, image_url, 128);
+    QVERIFY(path.startsWith(cache_dir + QLatin1Char('/')));
+    QCOMPARE(ThumbnailProvider::cache_path(cache_dir, image_url, 128), path);
+    QVERIFY(ThumbnailProvider::cache_path(cache_dir, image_url, 256) != path);
+
+    // a changed original gets a new key
+    save_image(image_path, QSize(400, 200), Qt::red);
+    QVERIFY(ThumbnailProvider::cache_path(cache_dir, image_url, 128) != path);
+
+    // remote images are keyed by their URL only
+    const QString remote_url = QStringLiteral("https://example.com/image.png");
+    QVERIFY(!ThumbnailProvider::cache_path(cache_dir, remote_url, 128).isEmpty());
+    QCOMPARE(ThumbnailProvider::cache_path(cache_dir, remote_url, 128),
+             ThumbnailProvider::cache_path(cache_dir, remote_url, 128));
+}
+
+void test_ThumbnailProvider::load_cached()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString cache_dir = tmp_dir.filePath(QStringLiteral("cache"));
+    const QString image_path = tmp_dir.filePath(QStringLiteral("image.png"));
+    const QString image_url = QUrl::fromLocalFile(image_path).toString();
+    save_image(image_path, QSize(600, 400), Qt::red);
+
+    const QImage thumbnail = ThumbnailProvider::load(image_url, QSize(100, 100), cache_dir);
+    QCOMPARE(thumbnail.size(), QSize(128, 85));
+
+    const QString cache_path = ThumbnailProvider::cache_path(cache_dir, image_url, 128);
+    QVERIFY(QFileInfo::exists(cache_path));
+
+    // the cached file is used without decoding the original
+    save_image(cache_path, QSize(4, 4), Qt::blue);
+    QCOMPARE(ThumbnailProvider::load(image_url, QSize(100, 100), cache_dir).size(), QSize(4, 4));
+
+    // requests without a size return the original
+    QCOMPARE(ThumbnailProvider::load(image_url, QSize(), cache_dir).size(), QSize(600, 400));
+}
+
+void test_ThumbnailProvider::load_small()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString cache_dir = tmp_dir.filePath(QStringLiteral("cache"));
+    const QString image_path = tmp_dir.filePath(QStringLiteral("image.png"));
+    save_image(image_path, QSize(64, 32), Qt::red);
+
+    QCOMPARE(ThumbnailProvider::load(image_path, QSize(100, 100), cache_dir).size(), QSize(64, 32));
+    QVERIFY(files_in(cache_dir).isEmpty());
+
+    QVERIFY(ThumbnailProvider::load(tmp_dir.filePath(QStringLiteral("missing.png")), QSize(100, 100), cache_dir).isNull());
+}
+
+void test_ThumbnailProvider::prune_cache()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString cache_dir = tmp_dir.path();
+    QVERIFY(QDir(cache_dir).mkpath(QStringLiteral("ab")));
+    QVERIFY(QDir(cache_dir).mkpath(QStringLiteral("cd")));
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QStringList names { "ab/1", "cd/2", "ab/3", "cd/4" };
+    for (int i = 0; i < names.size(); i++) {
+        QFile file(cache_dir + QLatin1Char('/') + names[i]);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(QByteArray(1000, 'x')), static_cast<qint64>(1000));
+        QVERIFY(file.setFileTime(now.addDays(i - 10), QFileDevice::FileModificationTime));
+    }
+
+    ThumbnailProvider::prune_cache(cache_dir, 4000);
+    QCOMPARE(files_in(cache_dir), QStringList({"1", "2", "3", "4"}));
+
+    // the least recently used ones are removed first, below the limit
+    ThumbnailProvider::prune_cache(cache_dir, 3000);
+    QCOMPARE(files_in(cache_dir), QStringList({"3", "4"}));
+}
+
+
+QTEST_MAIN(test_ThumbnailProvider)
+#include "test_ThumbnailProvider.moc"
@@ -19,8 +19,12 @@
 
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
+#include "model/gaming/GameListModel.h"
+#include "model/gaming/GameSearchIndex.h"
+#include "utils/SortKey.h"
 
 #include <array>
+#include <memory>
 
 
 class test_Game : public QObject {
@@ -38,6 +42,14 @@ private slots:
     void launchMulti();
 
     void sorting();
+    void sortKeyUpdate();
+    void playStatsBatch();
+
+    void listIndexOf();
+    void listSyncRanges();
+    void listChangesCoalesced();
+
+    void searchIndexCompaction();
 };
 
 void testStrAndList(const std::function<void(model::Game&, const QString&)>& fn_add,
@@ -147,6 +159,161 @@ void test_Game::sorting()
     QCOMPARE(games.at(3)->title(), QStringLiteral("Game IX"));
 }
 
+void test_Game::sortKeyUpdate()
+{
+    model::Game game("Game");
+    const SortKey& key = game.sortKey();
+    QVERIFY(key.isCurrent());
+    QVERIFY(!game.updateSortKey());
+
+    // the key used for sorting is only changed when requested
+    SortKey::setLocale(QLocale(QLocale::German));
+    QVERIFY(!game.sortKey().isCurrent());
+    QVERIFY(&game.sortKey() == &key);
+
+    QVERIFY(game.updateSortKey());
+    QVERIFY(game.sortKey().isCurrent());
+    QVERIFY(!game.updateSortKey());
+
+    SortKey::setLocale(QLocale());
+}
+
+void test_Game::playStatsBatch()
+{
+    model::Game game("test");
+    auto* const file_a = new model::GameFile("test1", game);
+    auto* const file_b = new model::GameFile("test2", game);
+    game.setFiles({ file_a, file_b });
+
+    QSignalSpy spy_stats(&game, &model::Game::playStatsChanged);
+    QVERIFY(spy_stats.isValid());
+
+    const QDateTime last_played = QDateTime::fromSecsSinceEpoch(1600000000);
+    model::GameFile::update_playstats({
+        { file_a, 1, 10, last_played.addSecs(-100) },
+        { file_b, 2, 20, last_played },
+        { file_a, 1, 30, last_played.addSecs(-200) },
+    });
+
+    QCOMPARE(spy_stats.count(), 1);
+    QCOMPARE(game.playCount(), 4);
+    QCOMPARE(game.playTime(), 60);
+    QCOMPARE(game.lastPlayed(), last_played);
+    QCOMPARE(file_a->playCount(), 2);
+}
+
+void test_Game::listIndexOf()
+{
+    model::Game game_a("a");
+    model::Game game_b("b");
+    model::Game game_c("c");
+
+    model::GameListModel list;
+    list.update({ &game_a, &game_b, &game_c });
+    QCOMPARE(list.indexOf(&game_c), 2);
+
+    list.sync({ &game_a, &game_c });
+    QCOMPARE(list.indexOf(&game_a), 0);
+    QCOMPARE(list.indexOf(&game_b), -1);
+    QCOMPARE(list.indexOf(&game_c), 1);
+
+    list.sync({ &game_b, &game_a, &game_c });
+    QCOMPARE(list.indexOf(&game_b), 0);
+    QCOMPARE(list.indexOf(&game_c), 2);
+}
+
+void test_Game::listSyncRanges()
+{
+    std::vector<std::unique_ptr<model::Game>> owned;
+    std::vector<model::Game*> games;
+    for (int i = 0; i < 600; i++) {
+        owned.emplace_back(new model::Game(QString::number(i)));
+        games.emplace_back(owned.back().get());
+    }
+    model::Game game_new("new");
+
+    model::GameListModel list;
+    list.update(std::vector<model::Game*>(games.cbegin(), games.cbegin() + 10));
+
+    QSignalSpy spy_removed(&list, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy spy_inserted(&list, &QAbstractItemModel::rowsInserted);
+    QSignalSpy spy_reset(&list, &QAbstractItemModel::modelReset);
+
+    // a few scattered changes are signaled by rows
+    list.sync({ games[0], games[2], &game_new, games[4], games[5], games[7], games[8], games[9] });
+    QCOMPARE(spy_removed.count(), 3);
+    QCOMPARE(spy_inserted.count(), 1);
+    QCOMPARE(spy_reset.count(), 0);
+    QCOMPARE(list.indexOf(games[0]), 0);
+    QCOMPARE(list.indexOf(games[1]), -1);
+    QCOMPARE(list.indexOf(&game_new), 2);
+    QCOMPARE(list.indexOf(games[4]), 3);
+    QCOMPARE(list.indexOf(games[9]), 7);
+
+    // too many changed ranges reset the model
+    list.update(std::vector<model::Game*>(games));
+    spy_reset.clear();
+    std::vector<model::Game*> every_other;
+    for (size_t i = 0; i < games.size(); i += 2)
+        every_other.emplace_back(games[i]);
+    list.sync(std::move(every_other));
+    QCOMPARE(spy_reset.count(), 1);
+    QCOMPARE(list.count(), 300);
+    QCOMPARE(list.indexOf(games[598]), 299);
+}
+
+void test_Game::listChangesCoalesced()
+{
+    model::Game game_a("a");
+    model::Game game_b("b");
+    model::Game game_c("c");
+
+    model::GameListModel list;
+    list.update({ &game_a, &game_b, &game_c });
+
+    QSignalSpy spy_changed(&list, &QAbstractItemModel::dataChanged);
+    QVERIFY(spy_changed.isValid());
+
+    game_c.setFavorite(true);
+    game_a.setFavorite(true);
+    game_b.setFavorite(true);
+    QCOMPARE(spy_changed.count(), 0);
+
+    QTRY_COMPARE(spy_changed.count(), 1);
+    QCOMPARE(spy_changed.at(0).at(0).toModelIndex().row(), 0);
+    QCOMPARE(spy_changed.at(0).at(1).toModelIndex().row(), 2);
+}
+
+void test_Game::searchIndexCompaction()
+{
+    constexpr int GAME_COUNT = 1000;
+
+    QObject parent;
+    std::vector<model::Game*> games;
+    for (int i = 0; i < GAME_COUNT; i++)
+        games.push_back(new model::Game(QStringLiteral("Game %1").arg(i), &parent));
+
+    model::GameSearchIndex index;
+    for (model::Game* const game : games)
+        index.add(game);
+
+    // removing most of the games, then adding them back, as with repeated rescans
+    for (int round = 0; round < 3; round++) {
+        for (int i = 1; i < GAME_COUNT; i++)
+            index.remove(games[i]);
+        QCOMPARE(index.size(), static_cast<size_t>(1));
+
+        for (int i = 1; i < GAME_COUNT; i++)
+            index.add(games[i]);
+        QCOMPARE(index.size(), static_cast<size_t>(GAME_COUNT));
+    }
+
+    const std::vector<model::Game*> results = index.search(QStringLiteral("game 999"));
+    QVERIFY(!results.empty());
+    QCOMPARE(results.front(), games[999]);
+    QCOMPARE(index.search(QStringLiteral("game")).size(), static_cast<size_t>(GAME_COUNT));
+}
+
 
 QTEST_MAIN(test_Game)
 #include "test_Game.moc"
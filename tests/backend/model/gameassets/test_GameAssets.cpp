@@ -27,26 +27,101 @@ class test_GameAssets : public QObject
 private slots:
     void setSingle();
     void appendMulti();
+    void localFiles();
+    void poolRelease();
+    void manyDuplicates();
 };
 
 void test_GameAssets::setSingle()
 {
-    model::Assets assets(this);
-    assets.add_uri(AssetType::BOX_FRONT, QUrl::fromLocalFile("/dummy").toString());
+    model::AssetLists lists;
+    lists.add_uri(AssetType::BOX_FRONT, QUrl::fromLocalFile("/dummy").toString());
+
+    model::Assets assets(lists, this);
     QCOMPARE(assets.property("boxFront").toString(), QLatin1String("file:///dummy"));
 }
 
 void test_GameAssets::appendMulti()
 {
-    model::Assets assets(this);
-    assets.add_uri(AssetType::VIDEO, QUrl::fromLocalFile("/dummy1").toString());
-    assets.add_uri(AssetType::VIDEO, QUrl::fromLocalFile("/dummy2").toString());
+    model::AssetLists lists;
+    lists.add_uri(AssetType::VIDEO, QUrl::fromLocalFile("/dummy1").toString());
+    lists.add_uri(AssetType::VIDEO, QUrl::fromLocalFile("/dummy2").toString());
+
+    model::Assets assets(lists, this);
 
     QCOMPARE(assets.property("videoList").toStringList().count(), 2);
     QCOMPARE(assets.property("videoList").toStringList().constFirst(), QLatin1String("file:///dummy1"));
     QCOMPARE(assets.property("videoList").toStringList().constLast(), QLatin1String("file:///dummy2"));
 }
 
+void test_GameAssets::localFiles()
+{
+    model::AssetLists lists;
+    lists.add_file(AssetType::SCREENSHOT, QStringLiteral("/dummy dir/a.png"));
+    lists.add_file(AssetType::SCREENSHOT, QStringLiteral("/dummy dir/b.png"));
+    lists.add_file(AssetType::SCREENSHOT, QStringLiteral("/dummy dir/a.png"));
+    lists.add_file(AssetType::BOX_FRONT, QStringLiteral("/dummy dir/a.png"));
+    lists.add_file(AssetType::LOGO, QString());
+
+    QCOMPARE(lists.screenshotList(), QStringList({
+        QStringLiteral("file:///dummy dir/a.png"),
+        QStringLiteral("file:///dummy dir/b.png"),
+    }));
+    QCOMPARE(lists.boxFront(), QStringLiteral("file:///dummy dir/a.png"));
+    QVERIFY(!lists.has(AssetType::LOGO));
+
+    const std::vector<model::StoredAsset> stored = lists.stored(AssetType::SCREENSHOT);
+    QCOMPARE(stored.size(), static_cast<size_t>(2));
+    QCOMPARE(stored.front().value, QStringLiteral("/dummy dir/a.png"));
+    QVERIFY(stored.front().is_file);
+}
+
+void test_GameAssets::poolRelease()
+{
+    const size_t initial_size = model::AssetLists::pool_size();
+    {
+        model::AssetLists lists_a;
+        lists_a.add_file(AssetType::BOX_FRONT, QStringLiteral("/pool dir/a.png"));
+        lists_a.add_file(AssetType::BOX_FRONT, QStringLiteral("/pool dir/a.png"));
+        {
+            model::AssetLists lists_b;
+            lists_b.add_file(AssetType::LOGO, QStringLiteral("/pool dir/a.png"));
+            lists_b.add_uri(AssetType::LOGO, QStringLiteral("http://localhost/b.png"));
+            QCOMPARE(model::AssetLists::pool_size(), initial_size + 2);
+        }
+        QCOMPARE(model::AssetLists::pool_size(), initial_size + 1);
+        QCOMPARE(lists_a.boxFront(), QStringLiteral("file:///pool dir/a.png"));
+    }
+    QCOMPARE(model::AssetLists::pool_size(), initial_size);
+
+    model::AssetLists lists;
+    lists.add_uri(AssetType::LOGO, QStringLiteral("http://localhost/c.png"));
+    QCOMPARE(lists.logo(), QStringLiteral("http://localhost/c.png"));
+}
+
+void test_GameAssets::manyDuplicates()
+{
+    // large enough to be checked through the index
+    constexpr int COUNT = 100;
+
+    model::AssetLists lists;
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < COUNT; i++) {
+            const QString path = QStringLiteral("/many/%1.png").arg(i);
+            lists.add_file(AssetType::SCREENSHOT, path);
+            lists.add_file(AssetType::TITLESCREEN, path);
+        }
+    }
+    lists.add_file(AssetType::BOX_FRONT, QStringLiteral("/many/0.png"));
+
+    const QStringList screenshots = lists.screenshotList();
+    QCOMPARE(screenshots.size(), COUNT);
+    QCOMPARE(screenshots.constFirst(), QStringLiteral("file:///many/0.png"));
+    QCOMPARE(screenshots.constLast(), QStringLiteral("file:///many/%1.png").arg(COUNT - 1));
+    QCOMPARE(lists.titlescreenList(), screenshots);
+    QCOMPARE(lists.boxFrontList(), QStringList({ QStringLiteral("file:///many/0.png") }));
+}
+
 
 QTEST_MAIN(test_GameAssets)
 #include "test_GameAssets.moc"
@@ -0,0 +1,198 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2019  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Game.h"
+#include "model/gaming/GameListModel.h"
+#include "model/gaming/GameQueryModel.h"
+
+
+namespace {
+QStringList titles_of(const model::GameQueryModel& model)
+{
+    QStringList out;
+    for (const model::Game* const game : model.entries())
+        out.append(game->title());
+    return out;
+}
+} // namespace
+
+
+class test_GameQuery : public QObject {
+    Q_OBJECT
+
+private:
+    model::GameListModel m_source;
+
+private slots:
+    void init();
+    void cleanup();
+
+    void unfiltered();
+    void title();
+    void favorites();
+    void genre();
+    void players();
+    void years();
+    void sorting();
+    void combined();
+    void sourceChanged();
+};
+
+void test_GameQuery::init()
+{
+    auto* const aaa = new model::Game("Alpha Attack");
+    aaa->setFavorite(true);
+    aaa->setPlayerCount(2);
+    aaa->setReleaseDate(QDate(1995, 1, 1));
+    aaa->genreList().append(QStringLiteral("Action"));
+
+    auto* const bbb = new model::Game("Beta Blaster");
+    bbb->setPlayerCount(4);
+    bbb->setReleaseDate(QDate(2001, 1, 1));
+    bbb->genreList().append(QStringLiteral("Shooter"));
+
+    auto* const ccc = new model::Game("Gamma Attack");
+    ccc->setFavorite(true);
+    ccc->setReleaseDate(QDate(1989, 1, 1));
+    ccc->genreList() << QStringLiteral("Action") << QStringLiteral("Shooter");
+
+    m_source.update({ aaa, bbb, ccc });
+}
+
+void test_GameQuery::cleanup()
+{
+    std::vector<model::Game*> games = m_source.entries();
+    m_source.update({});
+    qDeleteAll(games);
+}
+
+void test_GameQuery::unfiltered()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Beta Blaster", "Gamma Attack"}));
+}
+
+void test_GameQuery::title()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+
+    query.setTitleFilter(QStringLiteral("attack"));
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Gamma Attack"}));
+
+    query.setTitleFilter(QStringLiteral("BLAST"));
+    QCOMPARE(titles_of(query), QStringList({"Beta Blaster"}));
+
+    query.setTitleFilter(QStringLiteral("nothing"));
+    QVERIFY(query.isEmpty());
+}
+
+void test_GameQuery::favorites()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+    query.setFavoritesOnly(true);
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Gamma Attack"}));
+
+    m_source.entries().at(1)->setFavorite(true);
+    QTRY_COMPARE(titles_of(query), QStringList({"Alpha Attack", "Beta Blaster", "Gamma Attack"}));
+}
+
+void test_GameQuery::genre()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+
+    query.setGenreFilter(QStringLiteral("shooter"));
+    QCOMPARE(titles_of(query), QStringList({"Beta Blaster", "Gamma Attack"}));
+
+    query.setGenreFilter(QStringLiteral("Action"));
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Gamma Attack"}));
+}
+
+void test_GameQuery::players()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+    query.setMinPlayers(2);
+
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Beta Blaster"}));
+}
+
+void test_GameQuery::years()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+
+    query.setMinYear(1990);
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Beta Blaster"}));
+
+    query.setMaxYear(2000);
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack"}));
+}
+
+void test_GameQuery::sorting()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+
+    query.setSortRole(model::GameQueryModel::ReleaseDate);
+    QCOMPARE(titles_of(query), QStringList({"Gamma Attack", "Alpha Attack", "Beta Blaster"}));
+
+    query.setSortOrder(Qt::DescendingOrder);
+    QCOMPARE(titles_of(query), QStringList({"Beta Blaster", "Alpha Attack", "Gamma Attack"}));
+
+    query.setSortRole(model::GameQueryModel::Players);
+    QCOMPARE(titles_of(query), QStringList({"Beta Blaster", "Alpha Attack", "Gamma Attack"}));
+}
+
+void test_GameQuery::combined()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+    query.setFavoritesOnly(true);
+    query.setGenreFilter(QStringLiteral("Action"));
+    query.setTitleFilter(QStringLiteral("gamma"));
+
+    QCOMPARE(titles_of(query), QStringList({"Gamma Attack"}));
+}
+
+void test_GameQuery::sourceChanged()
+{
+    model::GameQueryModel query;
+    query.setSourceModel(&m_source);
+    query.setTitleFilter(QStringLiteral("attack"));
+
+    QSignalSpy spy_count(&query, &model::ObjectListModel::countChanged);
+    QVERIFY(spy_count.isValid());
+
+    std::vector<model::Game*> games = m_source.entries();
+    auto* const ddd = new model::Game("Delta Attack");
+    games.push_back(ddd);
+    m_source.sync(std::move(games));
+
+    QTRY_COMPARE(spy_count.count(), 1);
+    QCOMPARE(titles_of(query), QStringList({"Alpha Attack", "Gamma Attack", "Delta Attack"}));
+}
+
+
+QTEST_MAIN(test_GameQuery)
+#include "test_GameQuery.moc"
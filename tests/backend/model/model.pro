@@ -4,6 +4,7 @@ SUBDIRS += \
     collection \
     game \
     gameassets \
+    gamequery \
     locales \
     memory \
     system \
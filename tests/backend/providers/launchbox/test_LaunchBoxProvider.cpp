@@ -18,6 +18,7 @@
 #include <QtTest/QtTest>
 
 #include "Log.h"
+#include "model/gaming/Assets.h"
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
 #include "model/gaming/GameFile.h"
@@ -142,6 +143,18 @@ void test_LaunchBoxProvider::basic()
     QCOMPARE(game.filesModel()->entries().back()->name(), QStringLiteral("Entry 2..."));
     QCOMPARE(game.filesModel()->entries().back()->path(), entry2_filepath);
     // QCOMPARE(game.filesConst().last()->playCount(), 10);
+
+
+    // the assets in the region subdirectories have a single separator in their path
+    QStringList box_fronts = game.assets().boxFrontList();
+    box_fronts.sort();
+    QCOMPARE(box_fronts, QStringList({
+        QStringLiteral("file::/basic/LaunchBox/Images/Nintendo Entertainment System/Box - Front/North America/Super Mario Bros.-02.png"),
+        QStringLiteral("file::/basic/LaunchBox/Images/Nintendo Entertainment System/Box - Front/Super Mario Bros.-01.png"),
+    }));
+    QCOMPARE(game.assets().videoList(), QStringList({
+        QStringLiteral("file::/basic/LaunchBox/Videos/Nintendo Entertainment System/North America/Super Mario Bros..mp4"),
+    }));
 }
 
 
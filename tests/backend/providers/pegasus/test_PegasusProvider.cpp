@@ -98,6 +98,13 @@ void verify_collected_files(
     }
 }
 
+QStringList s_recorded_messages;
+
+void record_message(QtMsgType, const QMessageLogContext&, const QString& msg)
+{
+    s_recorded_messages.append(msg);
+}
+
 const model::Game* get_game_ptr_by_title(const std::vector<model::Game*>& list, const QString& title)
 {
     const auto it = std::find_if(
@@ -133,6 +140,8 @@ private slots:
     void relative_files_with_dirs();
     void autoparenting();
     void entryless_games();
+    void shared_dir_filters();
+    void conflicting_metafiles();
 };
 
 void test_PegasusProvider::empty()
@@ -654,6 +663,113 @@ void test_PegasusProvider::entryless_games()
     QCOMPARE(games.size(), 0);
 }
 
+void test_PegasusProvider::shared_dir_filters()
+{
+    QTest::ignoreMessage(QtInfoMsg, PATHMSG("Pegasus Metafiles: Found `%1`", ":/shared_dir/metadata.txt"));
+
+    providers::SearchContext sctx({QStringLiteral(":/shared_dir")});
+    providers::pegasus::PegasusProvider().run(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+
+    QCOMPARE(collections.size(), 3);
+    QCOMPARE(games.size(), 6);
+
+    // the rules of a collection don't affect the others using the same directory:
+    // `b.x` is ignored only by the first, `c.y` is excluded only from the second,
+    // and `skip_me.x` is only rejected by the ignore regex of the first
+    const HashMap<QString, QStringList> coll_files_map {
+        { QStringLiteral("First"), {
+            { ":/shared_dir/a.x" },
+            { ":/shared_dir/c.y" },
+            { ":/shared_dir/sub/e.x" },
+        }},
+        { QStringLiteral("Second"), {
+            { ":/shared_dir/a.x" },
+            { ":/shared_dir/b.x" },
+            { ":/shared_dir/d.z" },
+            { ":/shared_dir/skip_me.x" },
+            { ":/shared_dir/sub/e.x" },
+        }},
+        { QStringLiteral("Listed"), {
+            { ":/shared_dir/d.z" },
+            { ":/shared_dir/skip_me.x" },
+        }},
+    };
+    verify_collected_files(collections, coll_files_map);
+    QCOMPARE(get_collection(collections, QStringLiteral("First")).gameList()->count(), 3);
+    QCOMPARE(get_collection(collections, QStringLiteral("Second")).gameList()->count(), 5);
+    QCOMPARE(get_collection(collections, QStringLiteral("Listed")).gameList()->count(), 2);
+
+    // explicitly listed files are only dropped by the ignored file list,
+    // not by the ignored extensions
+    QVERIFY(!has_game_file(games, QStringLiteral(":/shared_dir/listed.w")));
+
+    // the games are shared, and created by the first collection in the file that matches them
+    const std::vector<std::pair<QString, QString>> expected_owners {
+        { QStringLiteral(":/shared_dir/a.x"), QStringLiteral("first {file.path}") },
+        { QStringLiteral(":/shared_dir/b.x"), QStringLiteral("second {file.path}") },
+        { QStringLiteral(":/shared_dir/c.y"), QStringLiteral("first {file.path}") },
+        { QStringLiteral(":/shared_dir/d.z"), QStringLiteral("second {file.path}") },
+        { QStringLiteral(":/shared_dir/skip_me.x"), QStringLiteral("second {file.path}") },
+        { QStringLiteral(":/shared_dir/sub/e.x"), QStringLiteral("first {file.path}") },
+    };
+    for (const auto& [path, launch_cmd] : expected_owners)
+        QCOMPARE(get_game_by_file_path(games, path).launchCmd(), launch_cmd);
+
+    const model::Game& shared_game = get_game_by_file_path(games, QStringLiteral(":/shared_dir/a.x"));
+    QCOMPARE(shared_game.collections().size(), 2);
+}
+
+void test_PegasusProvider::conflicting_metafiles()
+{
+    const auto pretty = [](const char* path){ return QDir::toNativeSeparators(QString::fromLatin1(path)); };
+    const QStringList expected_messages {
+        QStringLiteral("Pegasus Metafiles: Found `%1`").arg(pretty(":/conflicts/m1/metadata.txt")),
+        QStringLiteral("Pegasus Metafiles: `%1`, line 6: Duplicate file entry detected: `:/conflicts/games/a.ext`")
+            .arg(pretty(":/conflicts/m1/metadata.txt")),
+        QStringLiteral("Pegasus Metafiles: Found `%1`").arg(pretty(":/conflicts/m2/metadata.txt")),
+        QStringLiteral("Pegasus Metafiles: `%1`, line 5: This file already belongs to a different game: `:/conflicts/games/a.ext`")
+            .arg(pretty(":/conflicts/m2/metadata.txt")),
+        QStringLiteral("Pegasus Metafiles: Found `%1`").arg(pretty(":/conflicts/m3/metadata.txt")),
+        QStringLiteral("Pegasus Metafiles: `%1`, line 5: This file already belongs to a different game: `:/conflicts/games/b.ext`")
+            .arg(pretty(":/conflicts/m3/metadata.txt")),
+    };
+
+    // the metafiles are read in parallel, but the results have to be
+    // the same as if they were processed one after the other
+    for (int run = 0; run < 10; run++) {
+        s_recorded_messages.clear();
+        const QtMessageHandler prev_handler = qInstallMessageHandler(record_message);
+
+        providers::SearchContext sctx({
+            QStringLiteral(":/conflicts/m1"),
+            QStringLiteral(":/conflicts/m2"),
+            QStringLiteral(":/conflicts/m3"),
+        });
+        providers::pegasus::PegasusProvider().run(sctx);
+        const auto [collections, games] = sctx.finalize(this);
+
+        qInstallMessageHandler(prev_handler);
+        QCOMPARE(s_recorded_messages, expected_messages);
+
+        QCOMPARE(collections.size(), 2);
+        QCOMPARE(games.size(), 3);
+
+        // the later metafile overrides the collection properties
+        const model::Collection& shared = get_collection(collections, QStringLiteral("Shared"));
+        QCOMPARE(shared.shortName(), QStringLiteral("second"));
+        QCOMPARE(shared.gameList()->count(), 2);
+        QCOMPARE(get_collection(collections, QStringLiteral("Other")).gameList()->count(), 1);
+
+        // a file belongs to the game that was defined first
+        QCOMPARE(get_game_by_file_path(games, QStringLiteral(":/conflicts/games/a.ext")).title(), QStringLiteral("Game A"));
+        QCOMPARE(get_game_by_file_path(games, QStringLiteral(":/conflicts/games/b.ext")).title(), QStringLiteral("Game B"));
+        QCOMPARE(get_game_by_file_path(games, QStringLiteral(":/conflicts/games/c.ext")).title(), QStringLiteral("Game C"));
+        for (const model::Game* const game : games)
+            QCOMPARE(game->filesModel()->count(), 1);
+    }
+}
+
 
 QTEST_MAIN(test_PegasusProvider)
 #include "test_PegasusProvider.moc"
@@ -78,6 +78,7 @@ private slots:
     void asset_search();
     void asset_search_by_title();
     void asset_search_multifile();
+    void asset_search_mixed();
     void separate_media_dirs();
 };
 
@@ -180,6 +181,28 @@ void test_PegasusMediaProvider::asset_search_multifile()
     QCOMPARE(actual, expected);
 }
 
+void test_PegasusMediaProvider::asset_search_mixed()
+{
+    const QString display_path = QDir::toNativeSeparators(QStringLiteral(":/asset_search_mixed/metadata.txt"));
+    QTest::ignoreMessage(QtInfoMsg, qUtf8Printable(QStringLiteral("Pegasus Metafiles: Found `%1`").arg(display_path)));
+
+    providers::SearchContext sctx({QStringLiteral(":/asset_search_mixed")});
+    providers::pegasus::PegasusProvider().run(sctx);
+    providers::media::MediaProvider().run(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+
+    QCOMPARE(collections.size(), 1);
+    QCOMPARE(games.size(), 1);
+
+    const auto path = QStringLiteral(":/asset_search_mixed/mygame.ext");
+    QVERIFY(has_game_file(games, path));
+    const model::Game& game = get_game_by_file_path(games, path);
+
+    // the same file is listed both in the metafile and in the media directory
+    const QStringList expected { QStringLiteral("file::/asset_search_mixed/media/mygame/screenshot.png") };
+    QCOMPARE(game.assets().screenshotList(), expected);
+}
+
 void test_PegasusMediaProvider::separate_media_dirs()
 {
     // NOTE: see issue 407
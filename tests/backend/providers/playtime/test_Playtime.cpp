@@ -19,6 +19,7 @@
 
 #include "model/gaming/Collection.h"
 #include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
 #include "providers/SearchContext.h"
 #include "providers/pegasus_playtime/PlaytimeStats.h"
 
@@ -50,6 +51,7 @@ private slots:
     void read();
     void write();
     void write_queue();
+    void write_after_scan();
 };
 
 void test_Playtime::read()
@@ -134,6 +136,38 @@ void test_Playtime::write_queue()
 #endif
 }
 
+void test_Playtime::write_after_scan()
+{
+    QTemporaryFile db_file;
+    QVERIFY(db_file.open());
+
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    providers::playtime::PlaytimeStats playtime(db_file.fileName());
+    const auto [collections, games] = sctx.finalize(this);
+
+    QSignalSpy spy_start(&playtime, &providers::playtime::PlaytimeStats::startedWriting);
+    QSignalSpy spy_end(&playtime, &providers::playtime::PlaytimeStats::finishedWriting);
+    QVERIFY(spy_start.isValid() && spy_end.isValid());
+
+    model::GameFile* const gamefile = games.at(0)->filesModel()->entries().front();
+    playtime.onScanStarted();
+    playtime.onGameLaunched(gamefile);
+    playtime.onGameFinished(gamefile);
+
+    // the session is measured when it ends, but only saved after the scan
+    QCOMPARE(spy_start.count(), 0);
+    QCOMPARE(games.at(0)->property("playCount").toInt(), 0);
+    QTest::qWait(1100);
+
+    playtime.onScanFinished();
+    QVERIFY(spy_start.count() || spy_start.wait());
+    QVERIFY(spy_end.count() || spy_end.wait());
+
+    QCOMPARE(games.at(0)->property("playCount").toInt(), 1);
+    QCOMPARE(gamefile->playTime(), static_cast<qint64>(0));
+}
+
 
 QTEST_MAIN(test_Playtime)
 #include "test_Playtime.moc"
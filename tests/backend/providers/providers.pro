@@ -7,6 +7,9 @@ SUBDIRS += \
     favorites \
     logiqx \
     playtime \
+    searchcontext \
+    snapshot \
+    watcher \
 
 win32: SUBDIRS += \
     launchbox \
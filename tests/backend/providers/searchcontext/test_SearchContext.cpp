@@ -0,0 +1,111 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "providers/SearchContext.h"
+
+
+class test_SearchContext : public QObject {
+    Q_OBJECT
+
+private slots:
+    void merge_staged();
+    void merge_staged_new();
+};
+
+
+void test_SearchContext::merge_staged()
+{
+    providers::SearchContext sctx;
+    {
+        model::Collection& coll = *sctx.get_or_create_collection(QStringLiteral("coll"));
+        model::Game& game = *sctx.create_game_for(coll);
+        game.setTitle(QStringLiteral("first title"));
+        game.setSummary(QStringLiteral("first summary"));
+        game.developerList().append(QStringLiteral("first dev"));
+        sctx.game_add_filepath(game, QStringLiteral("/roms/game.zip"));
+    }
+
+    // a later provider finding the same file, and adding its own data
+    providers::SearchContext staged;
+    {
+        model::Collection& coll = *staged.get_or_create_collection(QStringLiteral("coll"));
+        coll.setSummary(QStringLiteral("staged coll summary"));
+        model::Game& game = *staged.create_game_for(coll);
+        game.setTitle(QStringLiteral("staged title"));
+        game.setRating(0.5);
+        game.developerList().append(QStringLiteral("staged dev"));
+        game.assetsMut().add_file(AssetType::BOX_FRONT, QStringLiteral("/media/boxfront.png"));
+        model::GameFile& gamefile = *staged.game_add_filepath(game, QStringLiteral("/roms/game.zip"));
+        gamefile.update_playstats(3, 60, QDateTime(QDate(2020, 1, 1), QTime(12, 0)));
+        staged.game_add_filepath(game, QStringLiteral("/roms/game_disc2.zip"));
+    }
+
+    sctx.merge_staged(staged);
+    const auto [collections, games] = sctx.finalize(this);
+
+    QCOMPARE(static_cast<int>(collections.size()), 1);
+    QCOMPARE(collections.front()->summary(), QStringLiteral("staged coll summary"));
+
+    QCOMPARE(static_cast<int>(games.size()), 1);
+    const model::Game& game = *games.front();
+    QCOMPARE(game.title(), QStringLiteral("staged title"));
+    QCOMPARE(game.summary(), QStringLiteral("first summary"));
+    QCOMPARE(game.rating(), 0.5f);
+    QCOMPARE(game.developerListConst(), QStringList({ QStringLiteral("first dev"), QStringLiteral("staged dev") }));
+    QCOMPARE(game.assets().boxFront(), QUrl::fromLocalFile(QStringLiteral("/media/boxfront.png")).toString());
+
+    QCOMPARE(static_cast<int>(game.files().size()), 2);
+    const model::GameFile* const gamefile = sctx.gamefile_by_filepath(QStringLiteral("/roms/game.zip"));
+    QVERIFY(gamefile);
+    QVERIFY(gamefile->parentGame() == &game);
+    QCOMPARE(gamefile->playCount(), 3);
+    QCOMPARE(gamefile->playTime(), static_cast<qint64>(60));
+}
+
+void test_SearchContext::merge_staged_new()
+{
+    providers::SearchContext sctx;
+    {
+        model::Collection& coll = *sctx.get_or_create_collection(QStringLiteral("coll A"));
+        model::Game& game = *sctx.create_game_for(coll);
+        sctx.game_add_filepath(game, QStringLiteral("/roms/a.zip"));
+    }
+
+    providers::SearchContext staged;
+    {
+        model::Collection& coll = *staged.get_or_create_collection(QStringLiteral("coll B"));
+        model::Game& game = *staged.create_game_for(coll);
+        staged.game_add_uri(game, QStringLiteral("steam:1337"));
+    }
+
+    sctx.merge_staged(staged);
+    const auto [collections, games] = sctx.finalize(this);
+
+    QCOMPARE(static_cast<int>(collections.size()), 2);
+    QCOMPARE(static_cast<int>(games.size()), 2);
+    QVERIFY(sctx.game_by_filepath(QStringLiteral("/roms/a.zip")));
+    QVERIFY(sctx.game_by_uri(QStringLiteral("steam:1337")));
+}
+
+
+QTEST_MAIN(test_SearchContext)
+#include "test_SearchContext.moc"
@@ -0,0 +1,254 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "model/gaming/Collection.h"
+#include "model/gaming/Game.h"
+#include "model/gaming/GameFile.h"
+#include "providers/LibrarySnapshot.h"
+#include "providers/SearchContext.h"
+
+#include <QTemporaryDir>
+
+
+namespace {
+void create_dummy_data(providers::SearchContext& sctx)
+{
+    model::Collection& coll_a = *sctx.get_or_create_collection(QStringLiteral("coll A"));
+    coll_a.setSummary(QStringLiteral("summary A"));
+    coll_a.assetsMut().add_file(AssetType::LOGO, QStringLiteral("/media/logo.png"));
+    model::Collection& coll_b = *sctx.get_or_create_collection(QStringLiteral("coll B"));
+
+    model::Game& game_a = *sctx.create_game_for(coll_a);
+    game_a.setTitle(QStringLiteral("game A"));
+    game_a.developerList().append(QStringLiteral("dev"));
+    game_a.assetsMut().add_file(AssetType::BOX_FRONT, QStringLiteral("/media/a.png"));
+    game_a.assetsMut().add_uri(AssetType::VIDEO, QStringLiteral("https://example.com/a.mp4"));
+    sctx.game_add_to(game_a, coll_b);
+    model::GameFile& file_a = *sctx.game_add_filepath(game_a, QStringLiteral("/roms/a.zip"));
+    file_a.update_playstats(2, 120, QDateTime(QDate(2020, 1, 1), QTime(12, 0), Qt::UTC));
+
+    model::Game& game_b = *sctx.create_game_for(coll_b);
+    game_b.setTitle(QStringLiteral("game B"));
+    game_b.setFavorite(true);
+    sctx.game_add_uri(game_b, QStringLiteral("steam:1337"));
+}
+
+void delete_all(providers::snapshot::Snapshot& snapshot)
+{
+    qDeleteAll(snapshot.games);
+    qDeleteAll(snapshot.collections);
+}
+
+void write_raw(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+}
+
+QByteArray read_raw(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+} // namespace
+
+
+class test_LibrarySnapshot : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void round_trip();
+    void checksum_ignores_order();
+    void copy_records_updates();
+    void bad_header();
+    void bad_header_data();
+    void truncated();
+    void corrupted();
+
+private:
+    QTemporaryDir m_tmp_dir;
+    QString m_valid_path;
+};
+
+
+void test_LibrarySnapshot::initTestCase()
+{
+    QVERIFY(m_tmp_dir.isValid());
+
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+
+    m_valid_path = m_tmp_dir.filePath(QStringLiteral("valid.snapshot"));
+    QVERIFY(!providers::snapshot::write(m_valid_path, collections, games).isEmpty());
+}
+
+void test_LibrarySnapshot::round_trip()
+{
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+
+    const QString path = m_tmp_dir.filePath(QStringLiteral("round_trip.snapshot"));
+    const QByteArray checksum = providers::snapshot::write(path, collections, games);
+
+    providers::snapshot::Snapshot snapshot;
+    QVERIFY(providers::snapshot::read(path, snapshot));
+    QCOMPARE(snapshot.checksum, checksum);
+    QCOMPARE(snapshot.collections.size(), collections.size());
+    QCOMPARE(snapshot.games.size(), games.size());
+
+    for (size_t i = 0; i < collections.size(); i++) {
+        const model::Collection& expected = *collections[i];
+        const model::Collection& actual = *snapshot.collections[i];
+        QCOMPARE(actual.name(), expected.name());
+        QCOMPARE(actual.summary(), expected.summary());
+        QCOMPARE(actual.assets().logoList(), expected.assets().logoList());
+        QCOMPARE(actual.gameList()->entries().size(), expected.gameList()->entries().size());
+    }
+
+    for (size_t i = 0; i < games.size(); i++) {
+        const model::Game& expected = *games[i];
+        const model::Game& actual = *snapshot.games[i];
+        QCOMPARE(actual.title(), expected.title());
+        QCOMPARE(actual.developerListConst(), expected.developerListConst());
+        QCOMPARE(actual.isFavorite(), expected.isFavorite());
+        QCOMPARE(actual.assets().boxFrontList(), expected.assets().boxFrontList());
+        QCOMPARE(actual.assets().videoList(), expected.assets().videoList());
+        QCOMPARE(actual.collections().size(), expected.collections().size());
+
+        QCOMPARE(actual.files().size(), expected.files().size());
+        for (size_t k = 0; k < expected.files().size(); k++) {
+            QCOMPARE(actual.files()[k]->path(), expected.files()[k]->path());
+            QCOMPARE(actual.files()[k]->playCount(), expected.files()[k]->playCount());
+            QCOMPARE(actual.files()[k]->playTime(), expected.files()[k]->playTime());
+            QCOMPARE(actual.files()[k]->lastPlayed(), expected.files()[k]->lastPlayed());
+        }
+    }
+
+    delete_all(snapshot);
+}
+
+void test_LibrarySnapshot::checksum_ignores_order()
+{
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    auto [collections, games] = sctx.finalize(this);
+
+    const QString path = m_tmp_dir.filePath(QStringLiteral("order.snapshot"));
+    const QByteArray checksum = providers::snapshot::write(path, collections, games);
+
+    std::reverse(collections.begin(), collections.end());
+    std::reverse(games.begin(), games.end());
+    QCOMPARE(providers::snapshot::write(path, collections, games), checksum);
+}
+
+void test_LibrarySnapshot::copy_records_updates()
+{
+    providers::SearchContext sctx;
+    create_dummy_data(sctx);
+    const auto [collections, games] = sctx.finalize(this);
+
+    const providers::snapshot::LibraryCopy original_copy(collections, games);
+    providers::snapshot::LibraryCopy library_copy(collections, games);
+    QCOMPARE(library_copy.serialize().data, original_copy.serialize().data);
+
+    // NOTE: the receiver is on the same thread, so the games are changed right away too
+    sctx.publish_updates_to(this, &library_copy);
+    for (model::Game* const game : games) {
+        sctx.game_add_asset_file(*game, AssetType::BOX_FRONT, QStringLiteral("/media/new.png"))
+            .game_add_asset_file(*game, AssetType::BOX_FRONT, QStringLiteral("/media/new.png"))
+            .game_set_favorite(*game, !game->isFavorite())
+            .add_play_sessions({{ game->files().front(), 1, 60, QDateTime(QDate(2021, 1, 1), QTime(12, 0), Qt::UTC) }});
+    }
+    sctx.flush_updates();
+
+    const providers::snapshot::Payload copied = library_copy.serialize();
+    const providers::snapshot::Payload current = providers::snapshot::serialize(collections, games);
+    QCOMPARE(copied.checksum, current.checksum);
+    QCOMPARE(copied.data, current.data);
+    QVERIFY(copied.checksum != original_copy.serialize().checksum);
+}
+
+void test_LibrarySnapshot::bad_header_data()
+{
+    QTest::addColumn<int>("offset");
+
+    QTest::newRow("magic") << 0;
+    QTest::newRow("version") << 4;
+}
+
+void test_LibrarySnapshot::bad_header()
+{
+    QFETCH(int, offset);
+
+    QByteArray data = read_raw(m_valid_path);
+    QVERIFY(data.size() > offset);
+    data[offset] = static_cast<char>(data[offset] ^ 0x7F);
+
+    const QString path = m_tmp_dir.filePath(QStringLiteral("bad_header.snapshot"));
+    write_raw(path, data);
+
+    providers::snapshot::Snapshot snapshot;
+    QVERIFY(!providers::snapshot::read(path, snapshot));
+    QVERIFY(snapshot.collections.empty());
+    QVERIFY(snapshot.games.empty());
+}
+
+void test_LibrarySnapshot::truncated()
+{
+    const QByteArray data = read_raw(m_valid_path);
+    const QString path = m_tmp_dir.filePath(QStringLiteral("truncated.snapshot"));
+
+    QVERIFY(!data.isEmpty());
+    for (int len : { 0, 6, data.size() / 2, data.size() - 1 }) {
+        write_raw(path, data.left(len));
+
+        providers::snapshot::Snapshot snapshot;
+        QVERIFY(!providers::snapshot::read(path, snapshot));
+        QVERIFY(snapshot.collections.empty());
+        QVERIFY(snapshot.games.empty());
+    }
+}
+
+void test_LibrarySnapshot::corrupted()
+{
+    QByteArray data = read_raw(m_valid_path);
+    QVERIFY(!data.isEmpty());
+
+    // a change in the payload that keeps the structure valid
+    const int title_pos = data.indexOf(QByteArray("\0g\0a\0m\0e\0 \0B", 12));
+    QVERIFY(title_pos > 0);
+    data[title_pos + 11] = 'C';
+
+    const QString path = m_tmp_dir.filePath(QStringLiteral("corrupted.snapshot"));
+    write_raw(path, data);
+
+    providers::snapshot::Snapshot snapshot;
+    QVERIFY(!providers::snapshot::read(path, snapshot));
+    QVERIFY(snapshot.collections.empty());
+    QVERIFY(snapshot.games.empty());
+}
+
+
+QTEST_MAIN(test_LibrarySnapshot)
+#include "test_LibrarySnapshot.moc"
@@ -0,0 +1,100 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "providers/LibraryWatcher.h"
+
+#include <QTemporaryDir>
+
+
+class test_LibraryWatcher : public QObject {
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void changed_dir();
+    void changes_kept_when_rewatched();
+    void stop();
+
+private:
+    QTemporaryDir m_tmp_dir;
+    QString m_dir_a;
+    QString m_dir_b;
+};
+
+
+void test_LibraryWatcher::init()
+{
+    QVERIFY(m_tmp_dir.isValid());
+    m_dir_a = m_tmp_dir.path() + QStringLiteral("/a");
+    m_dir_b = m_tmp_dir.path() + QStringLiteral("/b");
+    QVERIFY(QDir().mkpath(m_dir_a));
+    QVERIFY(QDir().mkpath(m_dir_b));
+}
+
+void test_LibraryWatcher::changed_dir()
+{
+    LibraryWatcher watcher;
+    QSignalSpy spy(&watcher, &LibraryWatcher::libraryChanged);
+    watcher.watch({ m_dir_a, m_dir_b }, {});
+    QCOMPARE(watcher.take_unchanged_dirs(), QStringList({ m_dir_a, m_dir_b }));
+
+    // multiple changes in a short time are reported once
+    QFile(m_dir_a + QStringLiteral("/game1.bin")).open(QIODevice::WriteOnly);
+    QFile(m_dir_a + QStringLiteral("/game2.bin")).open(QIODevice::WriteOnly);
+    QTRY_COMPARE(spy.count(), 1);
+    QTest::qWait(1500);
+    QCOMPARE(spy.count(), 1);
+
+    QCOMPARE(watcher.take_unchanged_dirs(), QStringList({ m_dir_b }));
+    QCOMPARE(watcher.take_unchanged_dirs(), QStringList({ m_dir_a, m_dir_b }));
+}
+
+void test_LibraryWatcher::changes_kept_when_rewatched()
+{
+    LibraryWatcher watcher;
+    QSignalSpy spy(&watcher, &LibraryWatcher::libraryChanged);
+    watcher.watch({ m_dir_a, m_dir_b }, {});
+
+    // eg. the change happened while a rescan was running
+    QFile(m_dir_b + QStringLiteral("/game.bin")).open(QIODevice::WriteOnly);
+    QTRY_COMPARE(spy.count(), 1);
+    watcher.watch({ m_dir_a, m_dir_b }, {});
+
+    QCOMPARE(watcher.take_unchanged_dirs(), QStringList({ m_dir_a }));
+}
+
+void test_LibraryWatcher::stop()
+{
+    LibraryWatcher watcher;
+    QSignalSpy spy(&watcher, &LibraryWatcher::libraryChanged);
+    watcher.watch({ m_dir_a }, {});
+
+    QFile(m_dir_a + QStringLiteral("/game.bin")).open(QIODevice::WriteOnly);
+    QTest::qWait(100);
+    watcher.stop();
+
+    QTest::qWait(1500);
+    QCOMPARE(spy.count(), 0);
+    QVERIFY(watcher.take_unchanged_dirs().isEmpty());
+}
+
+
+QTEST_MAIN(test_LibraryWatcher)
+#include "test_LibraryWatcher.moc"
@@ -18,8 +18,20 @@
 #include <QtTest/QtTest>
 
 #include "utils/CommandTokenizer.h"
+#include "utils/DirEnumerator.h"
+#include "utils/DirIndex.h"
+#include "utils/ExistenceCache.h"
+#include "utils/FlatHashMap.h"
 #include "utils/PathTools.h"
+#include "utils/SearchIndex.h"
+#include "utils/SortKey.h"
 #include "utils/StringHelpers.h"
+#include "utils/StringPool.h"
+
+#ifdef Q_OS_UNIX
+#include <ctime>
+#include <utime.h>
+#endif
 
 
 class test_Utils : public QObject
@@ -38,6 +50,20 @@ private slots:
 
     void abspath();
     void abspath_data();
+
+    void file_name_parts();
+    void file_name_parts_data();
+
+    void dir_enumerator();
+    void dir_index();
+    void dir_index_append();
+    void dir_index_walk();
+    void dir_index_unchanged();
+    void existence_cache();
+    void string_pool();
+    void search_index();
+    void sort_key();
+    void flat_hash_map();
 };
 
 void test_Utils::tokenize_command()
@@ -138,6 +164,395 @@ void test_Utils::abspath()
     QCOMPARE(::clean_abs_path(QFileInfo(path)), expected_path);
 }
 
+void test_Utils::file_name_parts()
+{
+    QFETCH(QString, name);
+    QFETCH(QString, basename);
+    QFETCH(QString, suffix);
+
+    QCOMPARE(::complete_basename(name).toString(), basename);
+    QCOMPARE(::file_suffix(name).toString(), suffix);
+}
+
+void test_Utils::file_name_parts_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QString>("basename");
+    QTest::addColumn<QString>("suffix");
+
+    QTest::newRow("simple") << QString("game.zip") << QString("game") << QString("zip");
+    QTest::newRow("multiple dots") << QString("game.tar.gz") << QString("game.tar") << QString("gz");
+    QTest::newRow("no suffix") << QString("game") << QString("game") << QString();
+    QTest::newRow("hidden") << QString(".hidden") << QString() << QString("hidden");
+    QTest::newRow("trailing dot") << QString("game.") << QString("game") << QString();
+}
+
+void test_Utils::dir_enumerator()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString root = tmp_dir.path();
+
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sub")));
+    {
+        QFile file(root + QStringLiteral("/a.txt"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("12345");
+    }
+    QFile(root + QStringLiteral("/.hidden")).open(QIODevice::WriteOnly);
+
+    QVERIFY(!DirEnumerator(root + QStringLiteral("/missing")).is_open());
+
+    DirEnumerator dir_it(root);
+    QVERIFY(dir_it.is_open());
+
+    QStringList names;
+    while (dir_it.next()) {
+        names.append(dir_it.name());
+        QCOMPARE(dir_it.is_hidden(), dir_it.name() == QLatin1String(".hidden"));
+        QCOMPARE(QFile::decodeName(dir_it.raw_name()), dir_it.name());
+        if (dir_it.name() == QLatin1String("a.txt")) {
+            QCOMPARE(dir_it.type(), DirEnumerator::EntryType::FILE);
+            QCOMPARE(dir_it.target_type(), DirEnumerator::EntryType::FILE);
+            QCOMPARE(dir_it.size(), static_cast<qint64>(5));
+            QVERIFY(dir_it.mtime_ms() > 0);
+        }
+        if (dir_it.name() == QLatin1String("sub"))
+            QCOMPARE(dir_it.type(), DirEnumerator::EntryType::DIRECTORY);
+    }
+    QVERIFY(!dir_it.next());
+
+    names.sort();
+    QCOMPARE(names, QStringList({".hidden", "a.txt", "sub"}));
+}
+
+void test_Utils::dir_index()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString root = tmp_dir.path();
+
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sub/deeper")));
+    QFile(root + QStringLiteral("/a.txt")).open(QIODevice::WriteOnly);
+    QFile(root + QStringLiteral("/sub/b.txt")).open(QIODevice::WriteOnly);
+
+    DirIndex index;
+    DirIndex::Listing listing = index.list(root);
+    QCOMPARE(listing.files, QStringList({"a.txt"}));
+    QCOMPARE(listing.dirs, QStringList({"sub"}));
+
+    // recently changed directories are always read again
+    QFile(root + QStringLiteral("/c.txt")).open(QIODevice::WriteOnly);
+    listing = index.list(root);
+    listing.files.sort();
+    QCOMPARE(listing.files, QStringList({"a.txt", "c.txt"}));
+
+    QStringList walked_dirs;
+    index.walk(root, [&walked_dirs](const QString& dir_path, const DirIndex::Listing&){
+        walked_dirs.append(dir_path);
+    });
+    walked_dirs.sort();
+    QCOMPARE(walked_dirs, QStringList({root, root + "/sub", root + "/sub/deeper"}));
+
+    const QString index_path = root + QStringLiteral("/index.dat");
+    QVERIFY(index.save(index_path));
+
+    DirIndex loaded_index;
+    QVERIFY(loaded_index.load(index_path));
+    listing = loaded_index.list(root + QStringLiteral("/sub"));
+    QCOMPARE(listing.files, QStringList({"b.txt"}));
+    QCOMPARE(listing.dirs, QStringList({"deeper"}));
+
+    QVERIFY(!loaded_index.load(root + QStringLiteral("/a.txt")));
+}
+
+void test_Utils::dir_index_walk()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString root = tmp_dir.path();
+
+    QVERIFY(QDir(root).mkpath(QStringLiteral("real/deeper")));
+#ifdef Q_OS_UNIX
+    QVERIFY(QFile::link(root + QStringLiteral("/real"), root + QStringLiteral("/link")));
+#endif
+
+    DirIndex index;
+    QStringList walked_dirs;
+    const auto collect = [&walked_dirs](const QString& dir_path, const DirIndex::Listing&){
+        walked_dirs.append(dir_path);
+    };
+
+    // a trailing separator of the root is not doubled in the subdirectories
+    index.walk(root + QLatin1Char('/'), collect, nullptr, DirIndex::Links::SKIP);
+    walked_dirs.sort();
+    QCOMPARE(walked_dirs, QStringList({root + "/", root + "/real", root + "/real/deeper"}));
+
+#ifdef Q_OS_UNIX
+    // links to directories are followed by default
+    walked_dirs.clear();
+    index.walk(root, collect);
+    walked_dirs.sort();
+    QCOMPARE(walked_dirs, QStringList({
+        root,
+        root + "/link",
+        root + "/link/deeper",
+        root + "/real",
+        root + "/real/deeper",
+    }));
+#endif
+}
+
+void test_Utils::dir_index_unchanged()
+{
+#ifdef Q_OS_UNIX
+    QTemporaryDir tmp_dir;
+    QTemporaryDir index_dir;
+    QVERIFY(tmp_dir.isValid());
+    QVERIFY(index_dir.isValid());
+    const QString old_dir = tmp_dir.path() + QStringLiteral("/old");
+    const QString new_dir = tmp_dir.path() + QStringLiteral("/new");
+    const QString index_path = index_dir.path() + QStringLiteral("/index.dat");
+
+    // NOTE: only the listings of directories not changed recently are trusted
+    utimbuf times;
+    times.actime = std::time(nullptr) - 3600;
+    times.modtime = times.actime;
+    for (const QString& dir_path : { old_dir, new_dir }) {
+        QVERIFY(QDir().mkpath(dir_path));
+        QCOMPARE(utime(QFile::encodeName(dir_path).constData(), &times), 0);
+    }
+    {
+        DirIndex index;
+        QVERIFY(index.list(old_dir).files.isEmpty());
+        QVERIFY(index.list(new_dir).files.isEmpty());
+        QVERIFY(index.save(index_path));
+    }
+
+    QFile(old_dir + QStringLiteral("/a.txt")).open(QIODevice::WriteOnly);
+    QFile(new_dir + QStringLiteral("/b.txt")).open(QIODevice::WriteOnly);
+
+    DirIndex index;
+    QVERIFY(index.load(index_path));
+    index.assume_unchanged({ old_dir });
+    QVERIFY(index.list(old_dir).files.isEmpty());
+    QCOMPARE(index.list(new_dir).files, QStringList({"b.txt"}));
+#else
+    QSKIP("Setting the modification time of directories is only implemented on Unix");
+#endif
+}
+
+void test_Utils::dir_index_append()
+{
+    QTemporaryDir tmp_dir;
+    QTemporaryDir index_dir;
+    QVERIFY(tmp_dir.isValid());
+    QVERIFY(index_dir.isValid());
+    const QString root = tmp_dir.path();
+    const QString index_path = index_dir.path() + QStringLiteral("/index.dat");
+
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sub/deeper")));
+    QFile(root + QStringLiteral("/a.txt")).open(QIODevice::WriteOnly);
+
+    const auto noop = [](const QString&, const DirIndex::Listing&){};
+    {
+        DirIndex index;
+        index.walk(root, noop);
+        QVERIFY(index.save(index_path));
+    }
+    QFile index_file(index_path);
+    QVERIFY(index_file.open(QIODevice::ReadOnly));
+    const QByteArray first_content = index_file.readAll();
+    index_file.close();
+
+    QFile(root + QStringLiteral("/sub/b.txt")).open(QIODevice::WriteOnly);
+    {
+        DirIndex index;
+        QVERIFY(index.load(index_path));
+        index.walk(root, noop);
+        QVERIFY(index.save(index_path));
+    }
+
+    // the changed listings are appended to the end of the file
+    QVERIFY(index_file.open(QIODevice::ReadOnly));
+    const QByteArray second_content = index_file.readAll();
+    index_file.close();
+    QVERIFY(second_content.size() > first_content.size());
+    QVERIFY(second_content.startsWith(first_content));
+
+    DirIndex index;
+    QVERIFY(index.load(index_path));
+    QCOMPARE(index.list(root + QStringLiteral("/sub")).files, QStringList({"b.txt"}));
+}
+
+void test_Utils::existence_cache()
+{
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+    const QString root = tmp_dir.path();
+
+    QVERIFY(QDir(root).mkpath(QStringLiteral("sub")));
+    QFile(root + QStringLiteral("/a.txt")).open(QIODevice::WriteOnly);
+    QFile(root + QStringLiteral("/.hidden")).open(QIODevice::WriteOnly);
+#ifdef Q_OS_UNIX
+    QVERIFY(QFile::link(root + QStringLiteral("/a.txt"), root + QStringLiteral("/link.txt")));
+    QVERIFY(QFile::link(root + QStringLiteral("/gone.txt"), root + QStringLiteral("/broken.txt")));
+#endif
+
+    ExistenceCache cache;
+    cache.add(root + QStringLiteral("/a.txt"));
+    cache.add(root + QStringLiteral("/missing.txt"));
+    cache.add(root + QStringLiteral("/nodir/b.txt"));
+    cache.resolve();
+
+    // new files are not seen after the directory got read
+    QFile(root + QStringLiteral("/c.txt")).open(QIODevice::WriteOnly);
+
+    QVERIFY(cache.exists(root + QStringLiteral("/a.txt")));
+    QVERIFY(cache.exists(root + QStringLiteral("/.hidden")));
+    QVERIFY(cache.exists(root + QStringLiteral("/sub")));
+    QVERIFY(!cache.exists(root + QStringLiteral("/missing.txt")));
+    QVERIFY(!cache.exists(root + QStringLiteral("/c.txt")));
+    QVERIFY(!cache.exists(root + QStringLiteral("/nodir/b.txt")));
+#ifdef Q_OS_UNIX
+    // symlinks exist only if their target does
+    QVERIFY(cache.exists(root + QStringLiteral("/link.txt")));
+    QVERIFY(!cache.exists(root + QStringLiteral("/broken.txt")));
+#endif
+
+    // unregistered directories are checked directly
+    QFile(root + QStringLiteral("/sub/d.txt")).open(QIODevice::WriteOnly);
+    QVERIFY(cache.exists(root + QStringLiteral("/sub/d.txt")));
+}
+
+void test_Utils::string_pool()
+{
+    StringPool pool;
+    const StringPool::Id id_a = pool.intern(QStringLiteral("Action"));
+    const StringPool::Id id_b = pool.intern(QStringLiteral("Puzzle"));
+    QVERIFY(id_a != id_b);
+    QCOMPARE(pool.intern(QStringLiteral("Action")), id_a);
+    QCOMPARE(pool.at(id_b), QStringLiteral("Puzzle"));
+
+    QStringList list { "Puzzle", "Racing", "Puzzle", "Action" };
+    pool.intern_list(list);
+    QCOMPARE(list, QStringList({"Puzzle", "Racing", "Action"}));
+    QCOMPARE(pool.size(), 3);
+
+    // the pooled strings share their data
+    QCOMPARE(list.at(0).constData(), pool.at(id_b).constData());
+}
+
+void test_Utils::search_index()
+{
+    QCOMPARE(SearchIndex::tokenize(QStringLiteral("Pokémon: Red Version!")),
+             QStringList({"pokemon", "red", "version"}));
+
+    SearchIndex index;
+    index.add(0, QStringLiteral("Super Mario Bros."), 4);
+    index.add(1, QStringLiteral("Mario Kart"), 4);
+    index.add(2, QStringLiteral("Pokémon Red"), 4);
+    index.add(3, QStringLiteral("Sonic the Hedgehog"), 4);
+    index.add(3, QStringLiteral("Sega"), 2);
+    index.add(4, QStringLiteral("Marios Adventure"), 4);
+
+    const auto doc_ids = [&index](const QString& query, size_t limit = 0){
+        std::vector<SearchIndex::DocId> ids;
+        for (const SearchIndex::Match& match : index.search(query, limit))
+            ids.push_back(match.doc);
+        return ids;
+    };
+
+    // exact matches come before prefix matches
+    QCOMPARE(doc_ids(QStringLiteral("mario")), std::vector<SearchIndex::DocId>({0, 1, 4}));
+    QCOMPARE(doc_ids(QStringLiteral("mario"), 1), std::vector<SearchIndex::DocId>({0}));
+    QCOMPARE(doc_ids(QStringLiteral("kart mar")), std::vector<SearchIndex::DocId>({1}));
+    QCOMPARE(doc_ids(QStringLiteral("POKEMON")), std::vector<SearchIndex::DocId>({2}));
+    QCOMPARE(doc_ids(QStringLiteral("son")), std::vector<SearchIndex::DocId>({3}));
+    QCOMPARE(doc_ids(QStringLiteral("sega")), std::vector<SearchIndex::DocId>({3}));
+    QCOMPARE(doc_ids(QStringLiteral("sonik")), std::vector<SearchIndex::DocId>({3}));
+    QVERIFY(doc_ids(QStringLiteral("zelda")).empty());
+    QVERIFY(doc_ids(QStringLiteral("mario zelda")).empty());
+
+    // the reused search buffers don't carry over between the queries
+    QCOMPARE(doc_ids(QStringLiteral("mario")), std::vector<SearchIndex::DocId>({0, 1, 4}));
+
+    index.remove(3);
+    index.remove(3);
+    QVERIFY(doc_ids(QStringLiteral("sonic")).empty());
+    QCOMPARE(index.removed_count(), static_cast<size_t>(1));
+}
+
+void test_Utils::sort_key()
+{
+    QStringList texts { "Zelda", "adventure", "Mario", "mario", "Bomberman" };
+
+    std::vector<std::pair<SortKey, QString>> keyed;
+    for (const QString& text : texts)
+        keyed.emplace_back(SortKey(text), text);
+    std::stable_sort(keyed.begin(), keyed.end(),
+        [](const std::pair<SortKey, QString>& a, const std::pair<SortKey, QString>& b){ return a.first < b.first; });
+
+    std::stable_sort(texts.begin(), texts.end(),
+        [](const QString& a, const QString& b){ return QString::localeAwareCompare(a, b) < 0; });
+
+    QCOMPARE(static_cast<int>(keyed.size()), texts.size());
+    for (int i = 0; i < texts.size(); i++)
+        QCOMPARE(keyed[static_cast<size_t>(i)].second.toLower(), texts.at(i).toLower());
+
+    QVERIFY(!SortKey().isValid());
+    QCOMPARE(SortKey(QStringLiteral("abc")).compare(SortKey(QStringLiteral("abc"))), 0);
+
+    // changing the locale makes the existing keys outdated
+    const SortKey old_key(QStringLiteral("Mario"));
+    QVERIFY(old_key.isCurrent());
+    SortKey::setLocale(QLocale(QLocale::German));
+    QVERIFY(!old_key.isCurrent());
+    QVERIFY(SortKey(QStringLiteral("Mario")).isCurrent());
+    SortKey::setLocale(QLocale());
+}
+
+void test_Utils::flat_hash_map()
+{
+    FlatHashMap<QString, int> map;
+    QVERIFY(map.empty());
+    QVERIFY(map.find(QStringLiteral("missing")) == map.cend());
+
+    for (int i = 0; i < 1000; i++)
+        QVERIFY(map.emplace(QStringLiteral("/roms/game%1.bin").arg(i), i).second);
+    QCOMPARE(map.size(), static_cast<size_t>(1000));
+
+    // existing keys are not overwritten
+    QVERIFY(!map.emplace(QStringLiteral("/roms/game5.bin"), -1).second);
+    QCOMPARE(map.find(QStringLiteral("/roms/game5.bin"))->second, 5);
+
+    // erasing shifts back the following entries, which must stay reachable
+    for (int i = 0; i < 1000; i += 2)
+        QCOMPARE(map.erase(QStringLiteral("/roms/game%1.bin").arg(i)), static_cast<size_t>(1));
+    QCOMPARE(map.erase(QStringLiteral("/roms/game0.bin")), static_cast<size_t>(0));
+    QCOMPARE(map.size(), static_cast<size_t>(500));
+    for (int i = 0; i < 1000; i++)
+        QCOMPARE(map.count(QStringLiteral("/roms/game%1.bin").arg(i)), static_cast<size_t>(i % 2));
+
+    int sum = 0;
+    for (const auto& pair : map)
+        sum += pair.second;
+    QCOMPARE(sum, 250000);
+
+    map[QStringLiteral("/roms/new.bin")] += 42;
+    QCOMPARE(map.find(QStringLiteral("/roms/new.bin"))->second, 42);
+
+    const size_t old_capacity = map.capacity();
+    map.reserve(old_capacity * 2);
+    QVERIFY(map.capacity() > old_capacity);
+    QCOMPARE(map.size(), static_cast<size_t>(501));
+    QCOMPARE(map.find(QStringLiteral("/roms/game1.bin"))->second, 1);
+
+    map.clear();
+    QVERIFY(map.empty());
+    QVERIFY(map.cbegin() == map.cend());
+}
+
 
 QTEST_MAIN(test_Utils)
 #include "test_Utils.moc"
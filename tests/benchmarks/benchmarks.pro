@@ -1,5 +1,8 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
+    blurhash \
     configfile \
+    direnum \
+    hashmap \
     pegasus_provider \
@@ -0,0 +1,85 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "imggen/BlurhashProvider.h"
+
+#include <memory>
+
+
+namespace {
+// the hashes of the integration test
+const std::vector<QString> HASHES {
+    QStringLiteral("LEHV6nWB2yk8pyoJadR*.7kCMdnj"),
+    QStringLiteral("LGF5]+Yk^6#M@-5c,1J5@[or[Q6."),
+    QStringLiteral("L6Pj0^i_.AyE_3t7t7R**0o#DgR4"),
+    QStringLiteral("LKO2?U%2Tw=w]~RBVZRi};RPxuwH"),
+};
+} // namespace
+
+
+class bench_Blurhash : public QObject {
+    Q_OBJECT
+
+private slots:
+    void decode();
+    void decode_data();
+    void request_cached();
+};
+
+
+void bench_Blurhash::decode_data()
+{
+    QTest::addColumn<QSize>("size");
+
+    QTest::newRow("placeholder") << QSize(24, 24);
+    QTest::newRow("grid cell") << QSize(200, 280);
+    QTest::newRow("background") << QSize(1920, 1080);
+}
+
+void bench_Blurhash::decode()
+{
+    QFETCH(QSize, size);
+
+    QBENCHMARK {
+        for (const QString& hash : HASHES) {
+            const QImage image = BlurhashProvider::decode(hash, size);
+            QCOMPARE(image.size(), size);
+        }
+    }
+}
+
+void bench_Blurhash::request_cached()
+{
+    BlurhashProvider provider;
+
+    QBENCHMARK {
+        for (const QString& hash : HASHES) {
+            const QString id = QString::fromLatin1(QUrl::toPercentEncoding(hash));
+            const std::unique_ptr<QQuickImageResponse> response(provider.requestImageResponse(id, QSize(200, 280)));
+
+            QSignalSpy spy(response.get(), &QQuickImageResponse::finished);
+            QVERIFY(spy.wait());
+            QVERIFY(response->errorString().isEmpty());
+        }
+    }
+}
+
+
+QTEST_MAIN(bench_Blurhash)
+#include "bench_Blurhash.moc"
@@ -0,0 +1,159 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "PegasusAssets.h"
+#include "types/AssetType.h"
+#include "utils/DirEnumerator.h"
+#include "utils/PathTools.h"
+
+#include <QDirIterator>
+#include <QStringBuilder>
+#include <QTemporaryDir>
+
+
+namespace {
+// 300 directories with 1000 files each
+constexpr int DIR_COUNT = 300;
+constexpr int FILES_PER_DIR = 1000;
+
+void enumerate_recursive(const QString& dir_path, int& file_count, int& suffix_len)
+{
+    DirEnumerator dir_it(dir_path);
+    while (dir_it.next()) {
+        switch (dir_it.type()) {
+            case DirEnumerator::EntryType::DIRECTORY:
+                enumerate_recursive(dir_path % QLatin1Char('/') % dir_it.name(), file_count, suffix_len);
+                break;
+            case DirEnumerator::EntryType::FILE: {
+                const QString name = dir_it.name();
+                const QString path = dir_path % QLatin1Char('/') % name;
+                suffix_len += ::complete_basename(name).isEmpty() ? 0 : ::file_suffix(name).length();
+                file_count += path.isEmpty() ? 0 : 1;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+// The asset type detection of the media provider, only through string views
+void detect_asset_types(const QString& dir_path, int& file_count, int& unknown_count)
+{
+    DirEnumerator dir_it(dir_path);
+    while (dir_it.next()) {
+        switch (dir_it.type()) {
+            case DirEnumerator::EntryType::DIRECTORY:
+                detect_asset_types(dir_path % QLatin1Char('/') % dir_it.name(), file_count, unknown_count);
+                break;
+            case DirEnumerator::EntryType::FILE: {
+                const QString name = dir_it.name();
+                const AssetType type = pegasus_assets::str_to_type(::complete_basename(name));
+                unknown_count += type == AssetType::UNKNOWN ? 1 : 0;
+                file_count++;
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+} // namespace
+
+
+class bench_DirEnumerator : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void qdiriterator();
+    void dir_enumerator();
+    void asset_types();
+
+private:
+    QTemporaryDir m_tmp_dir;
+};
+
+
+void bench_DirEnumerator::initTestCase()
+{
+    QVERIFY(m_tmp_dir.isValid());
+
+    const QDir root(m_tmp_dir.path());
+    for (int d = 0; d < DIR_COUNT; d++) {
+        const QString dir_name = QStringLiteral("system%1").arg(d);
+        QVERIFY(root.mkdir(dir_name));
+
+        const QString dir_path = root.filePath(dir_name);
+        for (int f = 0; f < FILES_PER_DIR; f++) {
+            QFile file(dir_path % QStringLiteral("/Game Title ") % QString::number(f) % QStringLiteral(".zip"));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+        }
+    }
+}
+
+// The way the providers used to scan the directories
+void bench_DirEnumerator::qdiriterator()
+{
+    QBENCHMARK {
+        int file_count = 0;
+        int suffix_len = 0;
+
+        QDirIterator dir_it(m_tmp_dir.path(), QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+        while (dir_it.hasNext()) {
+            dir_it.next();
+            const QFileInfo finfo = dir_it.fileInfo();
+            const QString path = ::clean_abs_path(finfo);
+            suffix_len += finfo.completeBaseName().isEmpty() ? 0 : finfo.suffix().length();
+            file_count += path.isEmpty() ? 0 : 1;
+        }
+
+        QCOMPARE(file_count, DIR_COUNT * FILES_PER_DIR);
+        QCOMPARE(suffix_len, DIR_COUNT * FILES_PER_DIR * 3);
+    }
+}
+
+void bench_DirEnumerator::dir_enumerator()
+{
+    QBENCHMARK {
+        int file_count = 0;
+        int suffix_len = 0;
+        enumerate_recursive(m_tmp_dir.path(), file_count, suffix_len);
+
+        QCOMPARE(file_count, DIR_COUNT * FILES_PER_DIR);
+        QCOMPARE(suffix_len, DIR_COUNT * FILES_PER_DIR * 3);
+    }
+}
+
+void bench_DirEnumerator::asset_types()
+{
+    QBENCHMARK {
+        int file_count = 0;
+        int unknown_count = 0;
+        detect_asset_types(m_tmp_dir.path(), file_count, unknown_count);
+
+        QCOMPARE(file_count, DIR_COUNT * FILES_PER_DIR);
+        QCOMPARE(unknown_count, DIR_COUNT * FILES_PER_DIR);
+    }
+}
+
+
+QTEST_MAIN(bench_DirEnumerator)
+#include "bench_DirEnumerator.moc"
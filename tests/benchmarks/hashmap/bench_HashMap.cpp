@@ -0,0 +1,116 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <QtTest/QtTest>
+
+#include "utils/FlatHashMap.h"
+#include "utils/HashMap.h"
+
+#include <QStringBuilder>
+
+
+namespace {
+// the shape of the path lookups of the providers: ~200k game files,
+// half of the lookups are misses (eg. media files without a game)
+constexpr int PATH_COUNT = 200000;
+
+template<typename Map>
+Map build_map(const std::vector<QString>& paths)
+{
+    Map map;
+    map.reserve(paths.size());
+    for (size_t i = 0; i < paths.size(); i++)
+        map.emplace(paths[i], static_cast<int>(i));
+    return map;
+}
+
+template<typename Map>
+int lookup_all(const Map& map, const std::vector<QString>& queries)
+{
+    int found = 0;
+    for (const QString& query : queries)
+        found += map.find(query) != map.cend() ? 1 : 0;
+    return found;
+}
+} // namespace
+
+
+class bench_HashMap : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void build_std();
+    void build_flat();
+    void lookup_std();
+    void lookup_flat();
+
+private:
+    std::vector<QString> m_paths;
+    std::vector<QString> m_queries;
+};
+
+
+void bench_HashMap::initTestCase()
+{
+    m_paths.reserve(PATH_COUNT);
+    m_queries.reserve(PATH_COUNT);
+    for (int i = 0; i < PATH_COUNT; i++) {
+        const QString dir = QStringLiteral("/home/user/roms/system%1/%2")
+            .arg(i % 50)
+            .arg(QChar('a' + i % 26));
+        m_paths.emplace_back(dir % QStringLiteral("/Game Title ") % QString::number(i) % QStringLiteral(".zip"));
+        m_queries.emplace_back(dir % QStringLiteral("/Game Title ") % QString::number(i * 2) % QStringLiteral(".zip"));
+    }
+}
+
+void bench_HashMap::build_std()
+{
+    QBENCHMARK {
+        const auto map = build_map<HashMap<QString, int>>(m_paths);
+        QCOMPARE(map.size(), m_paths.size());
+    }
+}
+
+void bench_HashMap::build_flat()
+{
+    QBENCHMARK {
+        const auto map = build_map<FlatHashMap<QString, int>>(m_paths);
+        QCOMPARE(map.size(), m_paths.size());
+    }
+}
+
+void bench_HashMap::lookup_std()
+{
+    const auto map = build_map<HashMap<QString, int>>(m_paths);
+    QBENCHMARK {
+        QCOMPARE(lookup_all(map, m_queries), PATH_COUNT / 2);
+    }
+}
+
+void bench_HashMap::lookup_flat()
+{
+    const auto map = build_map<FlatHashMap<QString, int>>(m_paths);
+    QBENCHMARK {
+        QCOMPARE(lookup_all(map, m_queries), PATH_COUNT / 2);
+    }
+}
+
+
+QTEST_MAIN(bench_HashMap)
+#include "bench_HashMap.moc"
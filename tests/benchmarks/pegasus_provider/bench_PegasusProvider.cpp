@@ -22,6 +22,8 @@
 #include "providers/pegasus_metadata/PegasusProvider.h"
 
 #include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
 
 
 class bench_PegasusProvider : public QObject {
@@ -34,6 +36,7 @@ private slots:
 
     void find_in_empty_dir();
     void find_in_filled_dir();
+    void large_metafile();
 };
 
 void bench_PegasusProvider::find_in_empty_dir()
@@ -61,6 +64,42 @@ void bench_PegasusProvider::find_in_filled_dir()
     }
 }
 
+void bench_PegasusProvider::large_metafile()
+{
+    constexpr int GAME_COUNT = 100000;
+    constexpr int COLLECTION_COUNT = 20;
+
+    QTemporaryDir tmp_dir;
+    QVERIFY(tmp_dir.isValid());
+
+    {
+        QFile file(tmp_dir.filePath(QStringLiteral("metadata.pegasus.txt")));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Text));
+
+        QTextStream stream(&file);
+        for (int i = 0; i < COLLECTION_COUNT; i++)
+            stream << "collection: Collection " << i << "\nlaunch: emulator {file.uri}\n\n";
+        for (int i = 0; i < GAME_COUNT; i++) {
+            stream << "game: Game " << i << "\n"
+                << "file: bench:" << i << "\n"
+                << "developer: Developer " << (i % 100) << "\n"
+                << "genre: Genre " << (i % 10) << "\n\n";
+        }
+    }
+
+    QBENCHMARK {
+        QTest::ignoreMessage(QtInfoMsg, QRegularExpression(QStringLiteral("Pegasus Metafiles: Found .*")));
+
+        providers::SearchContext sctx({tmp_dir.path()});
+        providers::pegasus::PegasusProvider provider;
+        provider.run(sctx);
+
+        QObject parent;
+        const auto result = sctx.finalize(&parent);
+        QCOMPARE(result.second.size(), static_cast<size_t>(GAME_COUNT));
+    }
+}
+
 
 QTEST_MAIN(bench_PegasusProvider)
 #include "bench_PegasusProvider.moc"
@@ -33,6 +33,7 @@ Rectangle {
         columns: 2
 
         Repeater {
+            id: hashImages
             model: [
                 "LEHV6nWB2yk8pyoJadR*.7kCMdnj",
                 "LGF5]+Yk^6#M@-5c,1J5@[or[Q6.",
@@ -59,6 +60,9 @@ Rectangle {
         when: windowShown
 
         function test_render() {
+            for (let i = 0; i < hashImages.count; i++)
+                tryCompare(hashImages.itemAt(i), "status", Image.Ready);
+
             const actual_img = grabImage(actual);
             const expected_img = grabImage(expected);
 
@@ -3,6 +3,7 @@ TEMPLATE = subdirs
 SUBDIRS += \
     sortfilter \
     blurhash \
+    thumbnail \
 
 !isEmpty(USE_SDL_GAMEPAD): SUBDIRS += sdl_gamepad
 !isEmpty(ENABLE_APNG): SUBDIRS += apng
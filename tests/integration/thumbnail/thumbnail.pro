@@ -0,0 +1,8 @@
+TARGET = test_Thumbnail
+SOURCES = $${TARGET}.cpp
+RESOURCES += data.qrc
+
+OTHER_FILES += \
+    tst_load.qml
+
+include($${TOP_SRCDIR}/tests/qmltest_common.pri)
@@ -0,0 +1,59 @@
+// Pegasus Frontend
+// Copyright (C) 2017-2020  Mátyás Mustoha
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+import QtQuick 2.0
+import QtTest 1.11
+
+
+Item {
+    width: 300
+    height: 200
+
+    Image {
+        id: thumbnail
+        source: "image://thumbnail/qrc:///original.png"
+        sourceSize { width: 100; height: 100 }
+    }
+
+    Image {
+        id: original
+        source: "image://thumbnail/qrc:///original.png"
+    }
+
+    Image {
+        id: missing
+        source: "image://thumbnail/qrc:///missing.png"
+        sourceSize { width: 100; height: 100 }
+    }
+
+
+    TestCase {
+        when: windowShown
+
+        function test_load() {
+            tryCompare(thumbnail, "status", Image.Ready);
+            compare(thumbnail.implicitWidth, 128);
+            compare(thumbnail.implicitHeight, 85);
+
+            tryCompare(original, "status", Image.Ready);
+            compare(original.implicitWidth, 300);
+            compare(original.implicitHeight, 200);
+
+            tryCompare(missing, "status", Image.Error);
+        }
+    }
+}